@@ -14,9 +14,13 @@
     limitations under the License.
 */
 
+#include <list>
+
 #include "ch.hpp"
+#include "chmemory.hpp"
 #include "hal.h"
 #include "ch_test.h"
+#include "chprintf.h"
 
 using namespace chibios_rt;
 
@@ -119,10 +123,57 @@ public:
   }
 };
 
+/*
+ * Allocators benchmark, lists are built and destroyed using the various
+ * allocators, the time is measured in realtime counter cycles.
+ */
+#define BENCH_ROUNDS    100
+#define BENCH_ITEMS     32
+#define BENCH_NODE_SIZE (2U * sizeof (void *) + sizeof (uint32_t))
+
+static MemoryPool bench_pool(BENCH_NODE_SIZE, chCoreAllocAlignedI);
+static stkalign_t bench_arena_buf[(2U * BENCH_ITEMS * BENCH_NODE_SIZE) /
+                                  sizeof (stkalign_t)];
+static MemoryArena bench_arena(bench_arena_buf, sizeof bench_arena_buf);
+
+template<class A>
+static rtcnt_t bench_list(const A &alloc, MemoryArena *arenap) {
+  rtcnt_t start = chSysGetRealtimeCounterX();
+
+  for (unsigned r = 0; r < BENCH_ROUNDS; r++) {
+    {
+      std::list<uint32_t, A> l(alloc);
+
+      for (uint32_t i = 0; i < BENCH_ITEMS; i++) {
+        l.push_back(i);
+      }
+    }
+    if (arenap != NULL) {
+      arenap->reset();
+    }
+  }
+
+  return chSysGetRealtimeCounterX() - start;
+}
+
+static void allocators_benchmark(BaseSequentialStream *chp) {
+
+  chprintf(chp, "\r\n*** Allocators benchmark, %u rounds of %u nodes\r\n",
+           BENCH_ROUNDS, BENCH_ITEMS);
+  chprintf(chp, "--- std::allocator: %u cycles\r\n",
+           bench_list(std::allocator<uint32_t>(), NULL));
+  chprintf(chp, "--- HeapAllocator:  %u cycles\r\n",
+           bench_list(HeapAllocator<uint32_t>(), NULL));
+  chprintf(chp, "--- PoolAllocator:  %u cycles\r\n",
+           bench_list(PoolAllocator<uint32_t>(bench_pool), NULL));
+  chprintf(chp, "--- ArenaAllocator: %u cycles\r\n",
+           bench_list(ArenaAllocator<uint32_t>(bench_arena), &bench_arena));
+}
+
 /*
  * Tester thread class. This thread executes the test suite.
  */
-class TesterThread : public BaseStaticThread<256> {
+class TesterThread : public BaseStaticThread<512> {
 
 protected:
   virtual void main(void) {
@@ -130,11 +181,12 @@ protected:
     setName("tester");
 
     test_execute((BaseSequentialStream *)&SD2);
+    allocators_benchmark((BaseSequentialStream *)&SD2);
     exit(test_global_fail);
   }
 
 public:
-  TesterThread(void) : BaseStaticThread<256>() {
+  TesterThread(void) : BaseStaticThread<512>() {
   }
 };
 
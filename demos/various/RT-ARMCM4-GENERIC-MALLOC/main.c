@@ -0,0 +1,182 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#include "ch.h"
+
+#if !defined(SYSTEM_CLOCK)
+#define SYSTEM_CLOCK 8000000U
+#endif
+
+/*
+ * Blocks at or above this size are served by the heap, it must match the
+ * syscalls.c size classes, default settings assumed.
+ */
+#define HEAP_BLOCK_MIN  65U
+
+/*
+ * @brief   System Timer handler.
+ */
+CH_IRQ_HANDLER(SysTick_Handler) {
+
+  CH_IRQ_PROLOGUE();
+
+  chSysLockFromISR();
+  chSysTimerHandlerI();
+  chSysUnlockFromISR();
+
+  CH_IRQ_EPILOGUE();
+}
+
+/*
+ * Block sizes used by the check, all the size classes and the heap are
+ * covered, class boundaries included.
+ */
+static const size_t check_sizes[] = {
+  1U, 8U, 9U, 16U, 17U, 32U, 33U, 64U, HEAP_BLOCK_MIN, 200U, 1000U
+};
+
+#define CHECK_BLOCKS    (sizeof check_sizes / sizeof check_sizes[0])
+
+static void *check_blocks[CHECK_BLOCKS];
+
+static uint32_t check_counter;
+
+/*
+ * Memory held by the allocated blocks, headers included.
+ */
+static size_t malloc_held(const struct mallinfo *mip) {
+
+  return (size_t)mip->arena - (size_t)mip->fordblks;
+}
+
+/*
+ * Allocates the check blocks, the number of pool objects is returned.
+ */
+static unsigned malloc_blocks(size_t *totalp) {
+  unsigned i, n;
+
+  n = 0U;
+  *totalp = 0U;
+  for (i = 0U; i < CHECK_BLOCKS; i++) {
+    check_blocks[i] = malloc(check_sizes[i]);
+    if (check_blocks[i] == NULL) {
+      chSysHalt("malloc failed");
+    }
+    memset(check_blocks[i], 0x55, check_sizes[i]);
+    *totalp += check_sizes[i];
+    if (check_sizes[i] < HEAP_BLOCK_MIN) {
+      n++;
+    }
+  }
+  return n;
+}
+
+static void free_blocks(void) {
+  unsigned i;
+
+  for (i = 0U; i < CHECK_BLOCKS; i++) {
+    free(check_blocks[i]);
+  }
+}
+
+/*
+ * Allocates and frees blocks of all the size classes verifying the
+ * allocator counters, the system is halted on mismatch.
+ */
+static void malloc_check(void) {
+  struct mallinfo mi0, mi1, mi2, mi3;
+  size_t total;
+  unsigned n;
+
+  mi0 = mallinfo();
+
+  /* Allocated bytes, peak and memory held by the blocks.*/
+  n = malloc_blocks(&total);
+  mi1 = mallinfo();
+  if ((size_t)mi1.uordblks != (size_t)mi0.uordblks + total) {
+    chSysHalt("wrong allocated bytes");
+  }
+  if ((size_t)mi1.usmblks < (size_t)mi1.uordblks) {
+    chSysHalt("wrong peak");
+  }
+  if (malloc_held(&mi1) < malloc_held(&mi0) + total) {
+    chSysHalt("wrong held memory");
+  }
+
+  /* All the counters return to the initial values except the free pool
+     objects, the pool objects are not returned to the core allocator.*/
+  free_blocks();
+  mi2 = mallinfo();
+  if (mi2.uordblks != mi0.uordblks) {
+    chSysHalt("allocated bytes not released");
+  }
+  if (mi2.usmblks != mi1.usmblks) {
+    chSysHalt("peak not kept");
+  }
+  if (malloc_held(&mi2) != malloc_held(&mi0)) {
+    chSysHalt("held memory not released");
+  }
+  if ((size_t)mi2.smblks < (size_t)n) {
+    chSysHalt("pool objects not kept");
+  }
+
+  /* Allocating again, the pool objects are reused and no more memory is
+     taken from the core allocator.*/
+  (void) malloc_blocks(&total);
+  mi3 = mallinfo();
+  if ((size_t)mi3.smblks != (size_t)mi2.smblks - n) {
+    chSysHalt("pool objects not reused");
+  }
+  if (malloc_held(&mi3) != malloc_held(&mi1)) {
+    chSysHalt("wrong held memory");
+  }
+  free_blocks();
+}
+
+/*
+ * Application entry point.
+ */
+int main(void) {
+
+  /*
+   * Hardware initialization, in this simple demo just the systick timer is
+   * initialized.
+   */
+  SysTick->LOAD = SYSTEM_CLOCK / CH_CFG_ST_FREQUENCY - (systime_t)1;
+  SysTick->VAL = (uint32_t)0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk |
+                  SysTick_CTRL_TICKINT_Msk;
+
+  /*
+   * System initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  chSysInit();
+
+  /*
+   * Normal main() thread activity, the allocator is checked once a second.
+   */
+  while (true) {
+    malloc_check();
+    check_counter++;
+    chThdSleepMilliseconds(1000);
+  }
+}
@@ -0,0 +1,323 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "lwipthread.h"
+
+#include "lwip/ip_addr.h"
+#include "lwip/stats.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+
+/*
+ * Capture file of the peer interface, NULL disables the capture.
+ */
+#if !defined(PEER_PCAP_FILE)
+#define PEER_PCAP_FILE      NULL
+#endif
+
+/*
+ * Number of ARP request/reply exchanges of the latency test.
+ */
+#define ARP_ROUNDS          10000
+
+/*
+ * Number of UDP datagrams of the throughput test.
+ */
+#define UDP_PACKETS         100000
+
+/*
+ * UDP ports of the throughput test.
+ */
+#define UDP_PEER_PORT       7001
+#define UDP_LWIP_PORT       7000
+
+/*
+ * Minimum Ethernet frame size, FCS excluded.
+ */
+#define FRAME_MIN_SIZE      60
+
+/*
+ * The peer station lives on ETHD2, the other end of the simulated wire,
+ * lwIP is bound to ETHD1 using the lwipthread.h default addresses.
+ */
+static uint8_t peer_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+static const uint8_t peer_ip[4] = {192, 168, 1, 20};
+static uint8_t lwip_ip[4];
+
+static const MACConfig peer_config = {
+  peer_mac,
+  PEER_PCAP_FILE
+};
+
+static uint8_t frame[SIM_MAC_BUFFERS_SIZE];
+
+static volatile uint32_t udp_received;
+
+/*
+ * Sends a frame from the peer station.
+ */
+static void peer_send(const uint8_t *buf, size_t size) {
+  MACTransmitDescriptor td;
+
+  if (macWaitTransmitDescriptor(&ETHD2, &td, TIME_INFINITE) == MSG_OK) {
+    (void) macWriteTransmitDescriptor(&td, (uint8_t *)buf, size);
+    macReleaseTransmitDescriptor(&td);
+  }
+}
+
+/*
+ * Receives a frame on the peer station, zero is returned on timeout.
+ */
+static size_t peer_receive(uint8_t *buf, systime_t timeout) {
+  MACReceiveDescriptor rd;
+  size_t n;
+
+  if (macWaitReceiveDescriptor(&ETHD2, &rd, timeout) != MSG_OK) {
+    return 0U;
+  }
+  n = macReadReceiveDescriptor(&rd, buf, SIM_MAC_BUFFERS_SIZE);
+  macReleaseReceiveDescriptor(&rd);
+  return n;
+}
+
+/*
+ * Builds an ARP request for the lwIP address.
+ */
+static size_t arp_request(uint8_t *f) {
+
+  memset(f, 0, FRAME_MIN_SIZE);
+  memset(&f[0], 0xFF, 6);                   /* Broadcast.                   */
+  memcpy(&f[6], peer_mac, 6);
+  f[12] = 0x08; f[13] = 0x06;               /* ARP.                         */
+  f[14] = 0x00; f[15] = 0x01;               /* Ethernet.                    */
+  f[16] = 0x08; f[17] = 0x00;               /* IPv4.                        */
+  f[18] = 6;    f[19] = 4;
+  f[20] = 0x00; f[21] = 0x01;               /* Request.                     */
+  memcpy(&f[22], peer_mac, 6);
+  memcpy(&f[28], peer_ip, 4);
+  memcpy(&f[38], lwip_ip, 4);
+  return FRAME_MIN_SIZE;
+}
+
+/*
+ * Checks for an ARP reply from the lwIP address.
+ */
+static bool is_arp_reply(const uint8_t *f, size_t n) {
+
+  return (bool)((n >= 42U) &&
+                (f[12] == 0x08) && (f[13] == 0x06) &&
+                (f[20] == 0x00) && (f[21] == 0x02) &&
+                (memcmp(&f[28], lwip_ip, 4) == 0));
+}
+
+/*
+ * Measures the ARP request/reply round trip through the lwIP stack.
+ */
+static unsigned arp_test(void) {
+  unsigned i, errors = 0U;
+  systime_t start, elapsed;
+  size_t n;
+
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < ARP_ROUNDS; i++) {
+    peer_send(frame, arp_request(frame));
+    do {
+      n = peer_receive(frame, MS2ST(100));
+    } while ((n > 0U) && !is_arp_reply(frame, n));
+    if (n == 0U) {
+      errors++;
+    }
+
+    /* The simulated timer only advances when checked by running threads.*/
+    _sim_check_for_interrupts();
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+
+  printf("ARP round trip: %u exchanges in %u ms, %u ns average, "
+         "%u errors\n",
+         ARP_ROUNDS, (unsigned)ST2MS(elapsed),
+         (unsigned)((uint64_t)ST2MS(elapsed) * 1000000U / ARP_ROUNDS),
+         errors);
+  return errors;
+}
+
+/*
+ * Builds a minimum size UDP datagram for the lwIP address, the UDP checksum
+ * is not used.
+ */
+static size_t udp_datagram(uint8_t *f, uint16_t id) {
+  uint32_t sum;
+  unsigned i;
+
+  memset(f, 0, FRAME_MIN_SIZE);
+  memcpy(&f[0], &ETHD1.config->mac_address[0], 6);
+  memcpy(&f[6], peer_mac, 6);
+  f[12] = 0x08; f[13] = 0x00;               /* IPv4.                        */
+  f[14] = 0x45;                             /* Version and header size.     */
+  f[16] = 0;    f[17] = 46;               /* IP total length.             */
+  f[18] = (uint8_t)(id >> 8);
+  f[19] = (uint8_t)id;
+  f[22] = 64;                               /* TTL.                         */
+  f[23] = 17;                               /* UDP.                         */
+  memcpy(&f[26], peer_ip, 4);
+  memcpy(&f[30], lwip_ip, 4);
+  f[34] = (uint8_t)(UDP_PEER_PORT >> 8);
+  f[35] = (uint8_t)UDP_PEER_PORT;
+  f[36] = (uint8_t)(UDP_LWIP_PORT >> 8);
+  f[37] = (uint8_t)UDP_LWIP_PORT;
+  f[38] = 0;    f[39] = 26;               /* UDP length.                  */
+
+  /* IP header checksum.*/
+  sum = 0U;
+  for (i = 14U; i < 34U; i += 2U) {
+    sum += ((uint32_t)f[i] << 8) | (uint32_t)f[i + 1U];
+  }
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  f[24] = (uint8_t)(~sum >> 8);
+  f[25] = (uint8_t)~sum;
+  return FRAME_MIN_SIZE;
+}
+
+/*
+ * Datagrams sink, invoked by the stack for each received datagram.
+ */
+static void udp_sink(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                     ip_addr_t *addr, u16_t port) {
+
+  (void)arg;
+  (void)pcb;
+  (void)addr;
+  (void)port;
+  udp_received++;
+  pbuf_free(p);
+}
+
+/*
+ * Measures the throughput of minimum size UDP datagrams from the peer to
+ * the lwIP stack, the datagrams are sent back to back and counted by the
+ * receive callback.
+ */
+static unsigned udp_test(void) {
+  struct udp_pcb *pcb;
+  unsigned i, lost;
+  systime_t start, elapsed;
+  uint32_t ms;
+
+  LOCK_TCPIP_CORE();
+  pcb = udp_new();
+  if (pcb != NULL) {
+    (void) udp_bind(pcb, IP_ADDR_ANY, UDP_LWIP_PORT);
+    udp_recv(pcb, udp_sink, NULL);
+  }
+  UNLOCK_TCPIP_CORE();
+  if (pcb == NULL) {
+    printf("UDP throughput: no PCB\n");
+    return 1U;
+  }
+
+  udp_received = 0U;
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < UDP_PACKETS; i++) {
+    peer_send(frame, udp_datagram(frame, (uint16_t)i));
+
+    /* The simulated timer only advances when checked by running threads.*/
+    _sim_check_for_interrupts();
+  }
+
+  /* Waiting for the datagrams still queued in the stack, if any.*/
+  for (i = 0U; (i < 100U) && (udp_received < UDP_PACKETS); i++) {
+    chThdSleepMilliseconds(1);
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+
+  LOCK_TCPIP_CORE();
+  udp_remove(pcb);
+  UNLOCK_TCPIP_CORE();
+
+  ms = (uint32_t)ST2MS(elapsed);
+  lost = UDP_PACKETS - (unsigned)udp_received;
+  printf("UDP throughput (%s input): %u datagrams in %u ms, %u per second, "
+         "%u lost\n",
+         LWIP_THREAD_DIRECT_INPUT == TRUE ? "direct" : "tcpip",
+         UDP_PACKETS, (unsigned)ms,
+         ms > 0U ? (unsigned)((uint64_t)UDP_PACKETS * 1000U / ms) : 0U,
+         lost);
+  return lost;
+}
+
+/*
+ * Prints the lwIP memory pools usage.
+ */
+static void memory_report(void) {
+#if MEMP_STATS
+  static const char *const names[] = {
+#define LWIP_MEMPOOL(name, num, size, desc) desc,
+#include "lwip/memp_std.h"
+  };
+  unsigned i;
+
+  printf("lwIP pools (used/max/available):\n");
+  for (i = 0U; i < MEMP_MAX; i++) {
+    printf("  %-16s %4u %4u %4u\n", names[i],
+           (unsigned)lwip_stats.memp[i].used,
+           (unsigned)lwip_stats.memp[i].max,
+           (unsigned)lwip_stats.memp[i].avail);
+  }
+#endif
+}
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+  ip_addr_t addr;
+  unsigned errors;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * lwIP on ETHD1, the peer station on ETHD2.
+   */
+  LWIP_IPADDR(&addr);
+  memcpy(lwip_ip, &addr.addr, 4);
+  lwipInit(NULL);
+  macStart(&ETHD2, &peer_config);
+
+  /*
+   * Tests execution, the exit status is the number of errors.
+   */
+  errors = arp_test();
+  errors += udp_test();
+  memory_report();
+  fflush(stdout);
+
+  return (int)errors;
+}
@@ -151,6 +151,7 @@ extern "C" {
 #if CH_CFG_USE_SEMAPHORES == TRUE
   void chGuardedPoolObjectInit(guarded_memory_pool_t *gmp, size_t size);
   void chGuardedPoolLoadArray(guarded_memory_pool_t *gmp, void *p, size_t n);
+  void *chGuardedPoolAllocI(guarded_memory_pool_t *gmp);
   void *chGuardedPoolAllocTimeoutS(guarded_memory_pool_t *gmp,
                                    systime_t timeout);
   void *chGuardedPoolAllocTimeout(guarded_memory_pool_t *gmp,
@@ -248,6 +249,23 @@ static inline void chGuardedPoolAddI(guarded_memory_pool_t *gmp, void *objp) {
 
   chGuardedPoolFreeI(gmp, objp);
 }
+
+/**
+ * @brief   Returns the number of free objects in a guarded memory pool.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] gmp       pointer to a @p guarded_memory_pool_t structure
+ * @return              The number of objects that can be allocated.
+ *
+ * @iclass
+ */
+static inline cnt_t chGuardedPoolGetCounterI(guarded_memory_pool_t *gmp) {
+
+  chDbgCheckClassI();
+
+  return chSemGetCounterI(&gmp->sem);
+}
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
 
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
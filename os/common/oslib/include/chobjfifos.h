@@ -0,0 +1,155 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chobjfifos.h
+ * @brief   Objects FIFO structures and macros.
+ *
+ * @addtogroup objects_fifo
+ * @{
+ */
+
+#ifndef CHOBJFIFOS_H
+#define CHOBJFIFOS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Objects FIFOs APIs.
+ * @details If enabled then the objects FIFOs APIs are included in the
+ *          kernel.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_SEMAPHORES.
+ */
+#if !defined(CH_CFG_USE_OBJ_FIFOS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_OBJ_FIFOS                FALSE
+#endif
+
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "CH_CFG_USE_OBJ_FIFOS requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if CH_CFG_USE_SEMAPHORES == FALSE
+#error "CH_CFG_USE_OBJ_FIFOS requires CH_CFG_USE_SEMAPHORES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an objects FIFO.
+ */
+typedef struct ch_objects_fifo {
+  guarded_memory_pool_t free;           /**< @brief Pool of the free
+                                                    objects.                */
+  msg_t                 *buffer;        /**< @brief Pointer to the queue
+                                                    buffer.                 */
+  msg_t                 *top;           /**< @brief Pointer to the location
+                                                    after the buffer.       */
+  msg_t                 *wrptr;         /**< @brief Write pointer.          */
+  msg_t                 *rdptr;         /**< @brief Read pointer.           */
+  semaphore_t           fullsem;        /**< @brief Sent objects counter
+                                                    @p semaphore_t.         */
+} objects_fifo_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chFifoObjectInit(objects_fifo_t *ofp, size_t objsize, size_t objn,
+                        void *objbuf, msg_t *msgbuf);
+  void *chFifoTakeObjectI(objects_fifo_t *ofp);
+  void *chFifoTakeObjectTimeoutS(objects_fifo_t *ofp, systime_t timeout);
+  void *chFifoTakeObjectTimeout(objects_fifo_t *ofp, systime_t timeout);
+  void chFifoReturnObjectI(objects_fifo_t *ofp, void *objp);
+  void chFifoReturnObject(objects_fifo_t *ofp, void *objp);
+  void chFifoSendObjectI(objects_fifo_t *ofp, void *objp);
+  void chFifoSendObjectS(objects_fifo_t *ofp, void *objp);
+  void chFifoSendObject(objects_fifo_t *ofp, void *objp);
+  msg_t chFifoReceiveObjectI(objects_fifo_t *ofp, void **objpp);
+  msg_t chFifoReceiveObjectTimeoutS(objects_fifo_t *ofp, void **objpp,
+                                    systime_t timeout);
+  msg_t chFifoReceiveObjectTimeout(objects_fifo_t *ofp, void **objpp,
+                                   systime_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of free objects.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The number of objects that can be taken.
+ *
+ * @iclass
+ */
+static inline cnt_t chFifoGetFreeCountI(objects_fifo_t *ofp) {
+
+  chDbgCheckClassI();
+
+  return chSemGetCounterI(&ofp->free.sem);
+}
+
+/**
+ * @brief   Returns the number of sent objects.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The number of objects waiting to be received.
+ *
+ * @iclass
+ */
+static inline cnt_t chFifoGetUsedCountI(objects_fifo_t *ofp) {
+
+  chDbgCheckClassI();
+
+  return chSemGetCounterI(&ofp->fullsem);
+}
+
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
+
+#endif /* CHOBJFIFOS_H */
+
+/** @} */
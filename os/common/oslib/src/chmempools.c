@@ -241,6 +241,31 @@ void chGuardedPoolLoadArray(guarded_memory_pool_t *gmp, void *p, size_t n) {
   }
 }
 
+/**
+ * @brief   Allocates an object from a guarded memory pool.
+ * @details This variant is non-blocking, the function returns immediately
+ *          if the pool is empty.
+ * @pre     The guarded memory pool must be already been initialized.
+ *
+ * @param[in] gmp       pointer to a @p guarded_memory_pool_t structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if the pool is empty.
+ *
+ * @iclass
+ */
+void *chGuardedPoolAllocI(guarded_memory_pool_t *gmp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(gmp != NULL);
+
+  if (chSemGetCounterI(&gmp->sem) <= (cnt_t)0) {
+    return NULL;
+  }
+  chSemFastWaitI(&gmp->sem);
+
+  return chPoolAllocI(&gmp->pool);
+}
+
 /**
  * @brief   Allocates an object from a guarded memory pool.
  * @pre     The guarded memory pool must be already been initialized.
@@ -0,0 +1,366 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chobjfifos.c
+ * @brief   Objects FIFO code.
+ *
+ * @addtogroup objects_fifo
+ * @details Zero-copy exchange of fixed size objects between threads.
+ *          <h2>Operation mode</h2>
+ *          An objects FIFO is a pool of free objects coupled with a queue
+ *          of sent objects.<br>
+ *          Operations defined for objects FIFOs:
+ *          - <b>Take</b>: A free object is taken from the pool, the caller
+ *            waits if there are no free objects.
+ *          - <b>Send</b>: The object, filled in place, is queued in FIFO
+ *            order.
+ *          - <b>Receive</b>: An object is fetched from the queue, the
+ *            caller waits if the queue is empty.
+ *          - <b>Return</b>: The object is returned to the pool.
+ *          .
+ *          The queue can hold all the objects of the pool so sending never
+ *          waits, there is a single wait queue for each direction: the
+ *          producers wait for free objects, the consumers wait for sent
+ *          objects. Each operation is performed in a single critical zone.
+ * @pre     In order to use the objects FIFOs APIs the
+ *          @p CH_CFG_USE_OBJ_FIFOS option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p objects_fifo_t object.
+ *
+ * @param[out] ofp      pointer to a @p objects_fifo_t structure
+ * @param[in] objsize   size of the objects, it must be a multiple of the
+ *                      required objects alignment
+ * @param[in] objn      number of objects in the objects buffer
+ * @param[in] objbuf    pointer to the objects buffer, it must be aligned
+ *                      as the objects
+ * @param[in] msgbuf    pointer to the queue buffer as an array of @p msg_t
+ *                      with @p objn elements
+ *
+ * @init
+ */
+void chFifoObjectInit(objects_fifo_t *ofp, size_t objsize, size_t objn,
+                      void *objbuf, msg_t *msgbuf) {
+
+  chDbgCheck((ofp != NULL) && (objn > 0U) &&
+             (objbuf != NULL) && (msgbuf != NULL));
+
+  chGuardedPoolObjectInit(&ofp->free, objsize);
+  chGuardedPoolLoadArray(&ofp->free, objbuf, objn);
+  ofp->buffer = msgbuf;
+  ofp->rdptr  = msgbuf;
+  ofp->wrptr  = msgbuf;
+  ofp->top    = &msgbuf[objn];
+  chSemObjectInit(&ofp->fullsem, (cnt_t)0);
+}
+
+/**
+ * @brief   Takes a free object.
+ * @details This variant is non-blocking.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The pointer to the taken object.
+ * @retval NULL         if there are no free objects.
+ *
+ * @iclass
+ */
+void *chFifoTakeObjectI(objects_fifo_t *ofp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(ofp != NULL);
+
+  return chGuardedPoolAllocI(&ofp->free);
+}
+
+/**
+ * @brief   Takes a free object.
+ * @details The invoking thread waits until a free object becomes available
+ *          or the specified time runs out.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the taken object.
+ * @retval NULL         if the operation timed out.
+ *
+ * @sclass
+ */
+void *chFifoTakeObjectTimeoutS(objects_fifo_t *ofp, systime_t timeout) {
+
+  chDbgCheckClassS();
+  chDbgCheck(ofp != NULL);
+
+  return chGuardedPoolAllocTimeoutS(&ofp->free, timeout);
+}
+
+/**
+ * @brief   Takes a free object.
+ * @details The invoking thread waits until a free object becomes available
+ *          or the specified time runs out.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the taken object.
+ * @retval NULL         if the operation timed out.
+ *
+ * @api
+ */
+void *chFifoTakeObjectTimeout(objects_fifo_t *ofp, systime_t timeout) {
+  void *objp;
+
+  chSysLock();
+  objp = chFifoTakeObjectTimeoutS(ofp, timeout);
+  chSysUnlock();
+
+  return objp;
+}
+
+/**
+ * @brief   Returns a free object.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be returned
+ *
+ * @iclass
+ */
+void chFifoReturnObjectI(objects_fifo_t *ofp, void *objp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((ofp != NULL) && (objp != NULL));
+
+  chGuardedPoolFreeI(&ofp->free, objp);
+}
+
+/**
+ * @brief   Returns a free object.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be returned
+ *
+ * @api
+ */
+void chFifoReturnObject(objects_fifo_t *ofp, void *objp) {
+
+  chDbgCheck((ofp != NULL) && (objp != NULL));
+
+  chGuardedPoolFree(&ofp->free, objp);
+}
+
+/**
+ * @brief   Sends an object.
+ * @details The object is queued in FIFO order, this function never waits
+ *          because the queue can hold all the objects.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be sent
+ *
+ * @iclass
+ */
+void chFifoSendObjectI(objects_fifo_t *ofp, void *objp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((ofp != NULL) && (objp != NULL));
+  chDbgAssert(chSemGetCounterI(&ofp->fullsem) <
+              (cnt_t)(ofp->top - ofp->buffer), "queue overflow");
+
+  *ofp->wrptr++ = (msg_t)objp;
+  if (ofp->wrptr >= ofp->top) {
+    ofp->wrptr = ofp->buffer;
+  }
+  chSemSignalI(&ofp->fullsem);
+}
+
+/**
+ * @brief   Sends an object.
+ * @details The object is queued in FIFO order, this function never waits
+ *          because the queue can hold all the objects.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be sent
+ *
+ * @sclass
+ */
+void chFifoSendObjectS(objects_fifo_t *ofp, void *objp) {
+
+  chDbgCheckClassS();
+
+  chFifoSendObjectI(ofp, objp);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Sends an object.
+ * @details The object is queued in FIFO order, this function never waits
+ *          because the queue can hold all the objects.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be sent
+ *
+ * @api
+ */
+void chFifoSendObject(objects_fifo_t *ofp, void *objp) {
+
+  chSysLock();
+  chFifoSendObjectS(ofp, objp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Receives an object.
+ * @details This variant is non-blocking.
+ * @post    The object must be returned using @p chFifoReturnObject() or
+ *          @p chFifoReturnObjectI() after use.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to the variable receiving the object pointer
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly received.
+ * @retval MSG_TIMEOUT  if the queue is empty.
+ *
+ * @iclass
+ */
+msg_t chFifoReceiveObjectI(objects_fifo_t *ofp, void **objpp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((ofp != NULL) && (objpp != NULL));
+
+  if (chSemGetCounterI(&ofp->fullsem) <= (cnt_t)0) {
+    return MSG_TIMEOUT;
+  }
+  chSemFastWaitI(&ofp->fullsem);
+  *objpp = (void *)*ofp->rdptr++;
+  if (ofp->rdptr >= ofp->top) {
+    ofp->rdptr = ofp->buffer;
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Receives an object.
+ * @details The invoking thread waits until an object is sent or the
+ *          specified time runs out.
+ * @post    The object must be returned using @p chFifoReturnObject() or
+ *          @p chFifoReturnObjectI() after use.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to the variable receiving the object pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly received.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chFifoReceiveObjectTimeoutS(objects_fifo_t *ofp, void **objpp,
+                                  systime_t timeout) {
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck((ofp != NULL) && (objpp != NULL));
+
+  msg = chSemWaitTimeoutS(&ofp->fullsem, timeout);
+  if (msg == MSG_OK) {
+    *objpp = (void *)*ofp->rdptr++;
+    if (ofp->rdptr >= ofp->top) {
+      ofp->rdptr = ofp->buffer;
+    }
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Receives an object.
+ * @details The invoking thread waits until an object is sent or the
+ *          specified time runs out.
+ * @post    The object must be returned using @p chFifoReturnObject() or
+ *          @p chFifoReturnObjectI() after use.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to the variable receiving the object pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly received.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chFifoReceiveObjectTimeout(objects_fifo_t *ofp, void **objpp,
+                                 systime_t timeout) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chFifoReceiveObjectTimeoutS(ofp, objpp, timeout);
+  chSysUnlock();
+
+  return msg;
+}
+
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
+
+/** @} */
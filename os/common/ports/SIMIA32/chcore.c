@@ -40,6 +40,13 @@
 bool port_isr_context_flag;
 syssts_t port_irq_sts;
 
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Modelled cycles counter in virtual time mode.
+ */
+uint64_t port_sim_cycles;
+#endif
+
 /*===========================================================================*/
 /* Module local types.                                                       */
 /*===========================================================================*/
@@ -110,11 +117,20 @@ void _port_thread_start(msg_t (*pf)(void *), void *p) {
  * @return              The realtime counter value.
  */
 rtcnt_t port_rt_get_counter_value(void) {
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+
+  /* The read itself consumes modelled time, this is required in order to
+     make polled delays terminate.*/
+  port_sim_cycles += (uint64_t)PORT_SIM_READ_CYCLES;
+
+  return (rtcnt_t)port_sim_cycles;
+#else
   LARGE_INTEGER n;
 
   QueryPerformanceCounter(&n);
 
   return (rtcnt_t)(n.QuadPart / 1000LL);
+#endif
 }
 
 /** @} */
@@ -123,6 +123,44 @@
 #define PORT_USE_ALT_TIMER              FALSE
 #endif
 
+/**
+ * @brief   Enables the virtual time mode.
+ * @details If enabled then the system tick and the realtime counter are
+ *          not related to the host clock. Time advances by a fixed number
+ *          of modelled cycles for each interrupt check and realtime counter
+ *          read, when all threads are idle the time jumps directly to the
+ *          next virtual timer deadline.
+ * @note    Test runs become much faster and benchmark results become
+ *          deterministic.
+ */
+#if !defined(PORT_SIM_VIRTUAL_TIME) || defined(__DOXYGEN__)
+#define PORT_SIM_VIRTUAL_TIME           FALSE
+#endif
+
+/**
+ * @brief   Modelled CPU clock in virtual time mode.
+ * @details This is also the frequency of the realtime counter.
+ */
+#if !defined(PORT_SIM_CLOCK) || defined(__DOXYGEN__)
+#define PORT_SIM_CLOCK                  100000000
+#endif
+
+/**
+ * @brief   Cycles accounted for each interrupt check.
+ * @details Models the code executed between two consecutive calls to
+ *          @p _sim_check_for_interrupts() by running threads.
+ */
+#if !defined(PORT_SIM_CHECK_CYCLES) || defined(__DOXYGEN__)
+#define PORT_SIM_CHECK_CYCLES           100
+#endif
+
+/**
+ * @brief   Cycles accounted for each realtime counter read.
+ */
+#if !defined(PORT_SIM_READ_CYCLES) || defined(__DOXYGEN__)
+#define PORT_SIM_READ_CYCLES            4
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -131,6 +169,15 @@
 #error "option CH_DBG_ENABLE_STACK_CHECK not supported by this port"
 #endif
 
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) && (CH_CFG_ST_TIMEDELTA > 0)
+#error "PORT_SIM_VIRTUAL_TIME requires a periodic system tick"
+#endif
+
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) &&                                      \
+    ((PORT_SIM_CLOCK / CH_CFG_ST_FREQUENCY) < PORT_SIM_CHECK_CYCLES)
+#error "PORT_SIM_CLOCK too low for CH_CFG_ST_FREQUENCY"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -285,6 +332,9 @@ struct port_context {
 
 extern bool port_isr_context_flag;
 extern syssts_t port_irq_sts;
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+extern uint64_t port_sim_cycles;
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -296,6 +346,7 @@ extern "C" {
   /*lint -restore*/
   rtcnt_t port_rt_get_counter_value(void);
   void _sim_check_for_interrupts(void);
+  void _sim_wait_for_interrupts(void);
 #ifdef __cplusplus
 }
 #endif
@@ -427,7 +478,7 @@ static inline void port_enable(void) {
  */
 static inline void port_wait_for_interrupt(void) {
 
-  _sim_check_for_interrupts();
+  _sim_wait_for_interrupts();
 }
 
 #endif /* !defined(_FROM_ASM_) */
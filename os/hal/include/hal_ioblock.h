@@ -57,6 +57,75 @@ typedef struct {
   uint32_t      blk_num;            /**< @brief Total number of blocks.     */
 } BlockDeviceInfo;
 
+/**
+ * @brief   Type of an asynchronous block request.
+ */
+typedef struct blk_request blk_request_t;
+
+/**
+ * @brief   Type of a block requests queue.
+ */
+typedef struct blk_queue blk_queue_t;
+
+/**
+ * @brief   Block request completion callback type.
+ * @note    The callback is invoked from the thread serving the queue within
+ *          a critical zone, only I-class functions can be used.
+ * @note    The request is already completed when the callback is invoked,
+ *          the callback can post it again using @p blkqStartRequestI(),
+ *          in that case a thread waiting for the request is resumed on the
+ *          completion of the new transfer.
+ *
+ * @param[in] brp       pointer to the completed request
+ */
+typedef void (*blkcallback_t)(blk_request_t *brp);
+
+/**
+ * @brief   Structure representing an asynchronous block request.
+ */
+struct blk_request {
+  /**
+   * @brief   Next request in the queue.
+   */
+  blk_request_t         *next;
+  /**
+   * @brief   First block.
+   */
+  uint32_t              startblk;
+  /**
+   * @brief   Number of blocks.
+   */
+  uint32_t              n;
+  /**
+   * @brief   Data buffer, not modified by write requests.
+   */
+  uint8_t               *buffer;
+  /**
+   * @brief   Write request.
+   */
+  bool                  write;
+  /**
+   * @brief   Request completed.
+   */
+  volatile bool         done;
+  /**
+   * @brief   Request result, valid after completion.
+   */
+  bool                  result;
+  /**
+   * @brief   Thread waiting for completion.
+   */
+  thread_reference_t    thread;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  blkcallback_t         callback;
+  /**
+   * @brief   Callback parameter.
+   */
+  void                  *param;
+};
+
 /**
  * @brief   @p BaseBlockDevice specific methods.
  */
@@ -78,14 +147,20 @@ typedef struct {
   /* Write operations synchronization.*/                                    \
   bool (*sync)(void *instance);                                             \
   /* Obtains info about the media.*/                                        \
-  bool (*get_info)(void *instance, BlockDeviceInfo *bdip);
+  bool (*get_info)(void *instance, BlockDeviceInfo *bdip);                  \
+  /* Starts an asynchronous read.*/                                         \
+  bool (*start_read)(void *instance, blk_request_t *brp);                   \
+  /* Starts an asynchronous write.*/                                        \
+  bool (*start_write)(void *instance, blk_request_t *brp);
 
 /**
  * @brief   @p BaseBlockDevice specific data.
  */
 #define _base_block_device_data                                             \
   /* Driver state.*/                                                        \
-  blkstate_t            state;
+  blkstate_t            state;                                              \
+  /* Asynchronous requests queue or NULL.*/                                 \
+  blk_queue_t           *queue;
 
 /**
  * @brief   @p BaseBlockDevice virtual methods table.
@@ -104,6 +179,40 @@ typedef struct {
   _base_block_device_data
 } BaseBlockDevice;
 
+/**
+ * @brief   Structure representing a block requests queue.
+ * @details Requests are kept sorted by block address and served in a
+ *          circular scan order starting from the position of the last
+ *          transfer. Adjacent requests with contiguous buffers are merged
+ *          in a single transfer.
+ */
+struct blk_queue {
+  /**
+   * @brief   Served block device.
+   */
+  BaseBlockDevice       *bdp;
+  /**
+   * @brief   Pending requests sorted by block address.
+   */
+  blk_request_t         *pending;
+  /**
+   * @brief   Requests overlapping a pending request, in arrival order.
+   */
+  blk_request_t         *deferred;
+  /**
+   * @brief   Block following the last transfer.
+   */
+  uint32_t              position;
+  /**
+   * @brief   Queue stopped.
+   */
+  bool                  stop;
+  /**
+   * @brief   Thread serving the queue while waiting for requests.
+   */
+  thread_reference_t    worker;
+};
+
 /**
  * @name    Macro Functions (BaseBlockDevice)
  * @{
@@ -258,8 +367,84 @@ typedef struct {
  */
 #define blkGetInfo(ip, bdip) ((ip)->vmt->get_info(ip, bdip))
 
+/**
+ * @brief   Starts an asynchronous read.
+ * @pre     A requests queue must be associated to the device.
+ *
+ * @param[in] ip        pointer to a @p BaseBlockDevice or derived class
+ * @param[in] brp       pointer to a request initialized using
+ *                      @p blkRequestObjectInit()
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue or queue stopped.
+ *
+ * @api
+ */
+#define blkStartRead(ip, brp) ((ip)->vmt->start_read(ip, brp))
+
+/**
+ * @brief   Starts an asynchronous write.
+ * @pre     A requests queue must be associated to the device.
+ *
+ * @param[in] ip        pointer to a @p BaseBlockDevice or derived class
+ * @param[in] brp       pointer to a request initialized using
+ *                      @p blkRequestObjectInit()
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue or queue stopped.
+ *
+ * @api
+ */
+#define blkStartWrite(ip, brp) ((ip)->vmt->start_write(ip, brp))
+
+/**
+ * @brief   Initializes a block request.
+ *
+ * @param[out] brp      pointer to the @p blk_request_t object
+ * @param[in] blk       first block
+ * @param[in] buf       pointer to the data buffer
+ * @param[in] nblks     number of blocks
+ * @param[in] cb        completion callback or @p NULL
+ * @param[in] par       callback parameter
+ *
+ * @init
+ */
+#define blkRequestObjectInit(brp, blk, buf, nblks, cb, par) do {            \
+  (brp)->next     = NULL;                                                   \
+  (brp)->startblk = (blk);                                                  \
+  (brp)->n        = (nblks);                                                \
+  (brp)->buffer   = (uint8_t *)(buf);                                       \
+  (brp)->write    = false;                                                  \
+  (brp)->done     = false;                                                  \
+  (brp)->result   = HAL_FAILED;                                             \
+  (brp)->thread   = NULL;                                                   \
+  (brp)->callback = (cb);                                                   \
+  (brp)->param    = (par);                                                  \
+} while (false)
+
 /** @} */
 
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void blkqObjectInit(blk_queue_t *bqp, BaseBlockDevice *bdp);
+  bool blkqStartRequestI(BaseBlockDevice *bdp, blk_request_t *brp,
+                         bool write);
+  bool blkqStartRequest(BaseBlockDevice *bdp, blk_request_t *brp,
+                        bool write);
+  bool blkqWaitRequest(blk_request_t *brp);
+  void blkqServe(blk_queue_t *bqp);
+  void blkqStop(blk_queue_t *bqp);
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* HAL_IOBLOCK_H */
 
 /** @} */
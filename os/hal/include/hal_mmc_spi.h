@@ -55,6 +55,27 @@
 #if !defined(MMC_NICE_WAITING) || defined(__DOXYGEN__)
 #define MMC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Number of bytes exchanged on each card poll.
+ * @details The card is polled, while busy or while waiting for a data
+ *          token, in chunks of this size so that each SPI exchange
+ *          carries enough data to make a DMA transfer worthwhile.
+ * @note    The default is 16.
+ */
+#if !defined(MMC_POLL_SIZE) || defined(__DOXYGEN__)
+#define MMC_POLL_SIZE               16
+#endif
+
+/**
+ * @brief   Data blocks CRC check.
+ * @details If enabled the card CRC checks are activated and the CRC16 of
+ *          the transferred data blocks is computed and verified.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(MMC_USE_DATA_CRC) || defined(__DOXYGEN__)
+#define MMC_USE_DATA_CRC            FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -65,6 +86,10 @@
 #error "MMC_SPI driver requires HAL_USE_SPI and SPI_USE_WAIT"
 #endif
 
+#if (MMC_POLL_SIZE < 1) || (MMC_POLL_SIZE > 64)
+#error "invalid MMC_POLL_SIZE value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -182,6 +207,8 @@ extern "C" {
   bool mmcSync(MMCDriver *mmcp);
   bool mmcGetInfo(MMCDriver *mmcp, BlockDeviceInfo *bdip);
   bool mmcErase(MMCDriver *mmcp, uint32_t startblk, uint32_t endblk);
+  bool mmcStartRead(MMCDriver *mmcp, blk_request_t *brp);
+  bool mmcStartWrite(MMCDriver *mmcp, blk_request_t *brp);
   bool mmc_lld_is_card_inserted(MMCDriver *mmcp);
   bool mmc_lld_is_write_protected(MMCDriver *mmcp);
 #ifdef __cplusplus
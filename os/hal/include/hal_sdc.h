@@ -183,6 +183,8 @@ extern "C" {
   bool sdcSync(SDCDriver *sdcp);
   bool sdcGetInfo(SDCDriver *sdcp, BlockDeviceInfo *bdip);
   bool sdcErase(SDCDriver *sdcp, uint32_t startblk, uint32_t endblk);
+  bool sdcStartRead(SDCDriver *sdcp, blk_request_t *brp);
+  bool sdcStartWrite(SDCDriver *sdcp, blk_request_t *brp);
   bool _sdc_wait_for_transfer_state(SDCDriver *sdcp);
 #ifdef __cplusplus
 }
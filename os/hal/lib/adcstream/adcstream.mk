@@ -0,0 +1,4 @@
+# ADC streaming front end files.
+ADCSTREAMSRC = $(CHIBIOS)/os/hal/lib/adcstream/hal_adc_stream.c
+
+ADCSTREAMINC = $(CHIBIOS)/os/hal/lib/adcstream
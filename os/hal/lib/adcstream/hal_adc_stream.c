@@ -0,0 +1,343 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_adc_stream.c
+ * @brief   ADC streaming front end code.
+ * @details This module turns a circular ADC conversion into a stream of
+ *          timestamped samples blocks. Each half buffer event copies the
+ *          samples into a free block of an input buffers queue, a consumer
+ *          thread fetches the filled blocks, optionally processed by a
+ *          chain of decimation/averaging stages, and returns them to the
+ *          queue when done.<br>
+ *          The queue lock is only taken for a few instructions on each
+ *          side, the samples copy is performed outside the critical zone.
+ *
+ * @addtogroup ADC_STREAM
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#include "hal_adc_stream.h"
+
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an @p ADCStream object.
+ *
+ * @param[out] adcsp    pointer to the @p ADCStream object
+ * @param[in] adcp      pointer to the @p ADCDriver to be used
+ *
+ * @init
+ */
+void adcsObjectInit(ADCStream *adcsp, ADCDriver *adcp) {
+
+  osalDbgCheck((adcsp != NULL) && (adcp != NULL));
+
+  adcsp->adcp     = adcp;
+  adcsp->config   = NULL;
+  adcsp->sequence = 0U;
+  adcsp->overruns = 0U;
+}
+
+/**
+ * @brief   Starts streaming.
+ * @details The blocks queue is initialized and the circular conversion is
+ *          started on the associated ADC driver.
+ * @pre     The ADC driver must have been started using @p adcStart().
+ *
+ * @param[in] adcsp     pointer to the @p ADCStream object
+ * @param[in] config    pointer to the @p ADCStreamConfig object
+ *
+ * @api
+ */
+void adcsStart(ADCStream *adcsp, const ADCStreamConfig *config) {
+
+  osalDbgCheck((adcsp != NULL) && (config != NULL) &&
+               (config->grpp != NULL) && (config->samples != NULL) &&
+               (config->buffers != NULL) && (config->nblocks > 0U) &&
+               (config->depth >= 2U) && ((config->depth & 1U) == 0U));
+  osalDbgCheck((config->nstages == 0U) || (config->stages != NULL));
+  osalDbgAssert(config->grpp->circular, "not a circular group");
+  osalDbgAssert(adcsp->config == NULL, "already started");
+
+  ibqObjectInit(&adcsp->ibq, config->buffers,
+                ADCS_BLOCK_SIZE(config->depth, config->grpp->num_channels),
+                config->nblocks, NULL, adcsp);
+  adcsp->sequence = 0U;
+  adcsp->overruns = 0U;
+  adcsp->config   = config;
+
+  adcStartConversion(adcsp->adcp, config->grpp,
+                     config->samples, config->depth);
+}
+
+/**
+ * @brief   Stops streaming.
+ * @details The conversion is stopped and the blocks queue is reset, a
+ *          thread waiting for a block is resumed and receives @p NULL.
+ *          A block held by the consumer is invalidated by the reset, its
+ *          samples stay untouched until the stream is restarted and the
+ *          following @p adcsReleaseBlock() returns @p MSG_RESET.
+ *
+ * @param[in] adcsp     pointer to the @p ADCStream object
+ *
+ * @api
+ */
+void adcsStop(ADCStream *adcsp) {
+
+  osalDbgCheck(adcsp != NULL);
+
+  adcStopConversion(adcsp->adcp);
+
+  osalSysLock();
+  if (adcsp->config != NULL) {
+    ibqResetI(&adcsp->ibq);
+    adcsp->config = NULL;
+    osalOsRescheduleS();
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Posts half of the circular buffer into the stream.
+ * @details This function must be invoked from the conversion group
+ *          @p end_cb callback passing its @p buffer and @p n parameters.
+ *          If the queue has no free blocks then the samples are dropped
+ *          and the overruns counter is increased, the consumer can also
+ *          detect the loss from the gap in the blocks sequence numbers.
+ * @note    The samples are copied outside the critical zone, this is safe
+ *          because the ISR is the only producer and the free block cannot
+ *          be touched by the consumer until it is posted.
+ *
+ * @param[in] adcsp     pointer to the @p ADCStream object
+ * @param[in] buffer    pointer to the samples to be posted
+ * @param[in] n         number of buffer rows to be posted
+ *
+ * @isr
+ */
+void adcsPostFromISR(ADCStream *adcsp, const adcsample_t *buffer,
+                     size_t n) {
+  const ADCStreamConfig *config = adcsp->config;
+  adcsblock_t *bp;
+  uint32_t sequence;
+  size_t size;
+
+  /* Samples received after a stop are ignored.*/
+  if (config == NULL) {
+    return;
+  }
+
+  osalDbgCheck(n <= (config->depth / 2U));
+
+  osalSysLockFromISR();
+  sequence = adcsp->sequence++;
+  bp = (adcsblock_t *)(void *)ibqGetEmptyBufferI(&adcsp->ibq);
+  if (bp == NULL) {
+    adcsp->overruns++;
+    osalSysUnlockFromISR();
+    return;
+  }
+  osalSysUnlockFromISR();
+
+  /* Filling the block outside the critical zone.*/
+  size = n * (size_t)config->grpp->num_channels * sizeof (adcsample_t);
+  bp->sequence = sequence;
+  bp->time     = osalOsGetSystemTimeX();
+  bp->frames   = n;
+  memcpy((void *)adcsGetSamplesX(bp), (const void *)buffer, size);
+
+  osalSysLockFromISR();
+  ibqPostFullBufferI(&adcsp->ibq, sizeof (adcsblock_t) + size);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Gets the next block from the stream.
+ * @details The processing stages specified in the configuration are
+ *          applied to the block, in order, before returning it.
+ * @post    The block must be returned to the stream using
+ *          @p adcsReleaseBlock() before fetching the next one.
+ *
+ * @param[in] adcsp     pointer to the @p ADCStream object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              A pointer to the block header.
+ * @retval NULL         if the specified time expired or the stream has been
+ *                      stopped.
+ *
+ * @api
+ */
+adcsblock_t *adcsGetBlockTimeout(ADCStream *adcsp, systime_t timeout) {
+  const ADCStreamConfig *config;
+  adcsblock_t *bp;
+  size_t i, nch;
+  msg_t msg;
+
+  osalDbgCheck(adcsp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(adcsp->ibq.ptr == NULL, "previous block not released");
+  config = adcsp->config;
+  if (config == NULL) {
+    osalSysUnlock();
+    return NULL;
+  }
+  msg = ibqGetFullBufferTimeoutS(&adcsp->ibq, timeout);
+  osalSysUnlock();
+
+  if (msg != MSG_OK) {
+    return NULL;
+  }
+
+  /* Running the processing chain on the block, in place.*/
+  bp  = (adcsblock_t *)(void *)adcsp->ibq.ptr;
+  nch = (size_t)config->grpp->num_channels;
+  for (i = 0U; i < config->nstages; i++) {
+    const ADCStreamStage *stgp = &config->stages[i];
+    bp->frames = stgp->fn(stgp, adcsGetSamplesX(bp), bp->frames, nch);
+  }
+
+  return bp;
+}
+
+/**
+ * @brief   Returns the current block to the stream.
+ * @pre     The block must be released before restarting the stream.
+ *
+ * @param[in] adcsp     pointer to the @p ADCStream object
+ * @return              The operation status.
+ * @retval MSG_OK       if the block has been returned to the queue.
+ * @retval MSG_RESET    if the stream has been stopped while the block was
+ *                      held, the block has already been reclaimed by the
+ *                      queue reset and nothing is done.
+ *
+ * @api
+ */
+msg_t adcsReleaseBlock(ADCStream *adcsp) {
+  msg_t msg;
+
+  osalDbgCheck(adcsp != NULL);
+
+  osalSysLock();
+  if (adcsp->config == NULL) {
+    msg = MSG_RESET;
+  }
+  else {
+    osalDbgAssert(adcsp->ibq.ptr != NULL, "no block acquired");
+    ibqReleaseEmptyBufferS(&adcsp->ibq);
+    msg = MSG_OK;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Decimation stage.
+ * @details Keeps one row every @p factor rows.
+ *
+ * @param[in] stgp      pointer to the stage descriptor
+ * @param[in,out] samples pointer to the samples matrix
+ * @param[in] frames    number of rows in the matrix
+ * @param[in] nch       number of channels (matrix columns)
+ * @return              The number of rows after processing.
+ *
+ * @special
+ */
+size_t adcsStageDecimate(const ADCStreamStage *stgp,
+                         adcsample_t *samples,
+                         size_t frames,
+                         size_t nch) {
+  size_t i, n;
+
+  osalDbgCheck(stgp->factor > 0U);
+
+  n = frames / stgp->factor;
+  for (i = 1U; i < n; i++) {
+    memmove((void *)&samples[i * nch],
+            (const void *)&samples[i * stgp->factor * nch],
+            nch * sizeof (adcsample_t));
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Averaging stage.
+ * @details Replaces each group of @p factor rows with their average.
+ *
+ * @param[in] stgp      pointer to the stage descriptor
+ * @param[in,out] samples pointer to the samples matrix
+ * @param[in] frames    number of rows in the matrix
+ * @param[in] nch       number of channels (matrix columns)
+ * @return              The number of rows after processing.
+ *
+ * @special
+ */
+size_t adcsStageAverage(const ADCStreamStage *stgp,
+                        adcsample_t *samples,
+                        size_t frames,
+                        size_t nch) {
+  size_t i, j, k, n;
+
+  osalDbgCheck(stgp->factor > 0U);
+
+  n = frames / stgp->factor;
+  for (i = 0U; i < n; i++) {
+    const adcsample_t *src = &samples[i * stgp->factor * nch];
+    for (j = 0U; j < nch; j++) {
+      uint32_t acc = 0U;
+      for (k = 0U; k < stgp->factor; k++) {
+        acc += (uint32_t)src[(k * nch) + j];
+      }
+      /* The destination row never overlaps rows not yet consumed.*/
+      samples[(i * nch) + j] = (adcsample_t)(acc / (uint32_t)stgp->factor);
+    }
+  }
+
+  return n;
+}
+
+#endif /* HAL_USE_ADC == TRUE */
+
+/** @} */
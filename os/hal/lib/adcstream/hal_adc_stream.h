@@ -0,0 +1,253 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_adc_stream.h
+ * @brief   ADC streaming front end macros and structures.
+ *
+ * @addtogroup ADC_STREAM
+ * @{
+ */
+
+#ifndef HAL_ADC_STREAM_H
+#define HAL_ADC_STREAM_H
+
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an ADC stream object.
+ */
+typedef struct ADCStream ADCStream;
+
+/**
+ * @brief   Type of a processing stage descriptor.
+ */
+typedef struct ADCStreamStage ADCStreamStage;
+
+/**
+ * @brief   Processing stage function type.
+ * @details The function transforms in place a matrix of @p frames rows of
+ *          @p nch samples each and returns the number of resulting rows,
+ *          the number of rows cannot grow.
+ *
+ * @param[in] stgp      pointer to the stage descriptor
+ * @param[in,out] samples pointer to the samples matrix
+ * @param[in] frames    number of rows in the matrix
+ * @param[in] nch       number of channels (matrix columns)
+ * @return              The number of rows after processing.
+ */
+typedef size_t (*adcsstagefn_t)(const ADCStreamStage *stgp,
+                                adcsample_t *samples,
+                                size_t frames,
+                                size_t nch);
+
+/**
+ * @brief   Processing stage descriptor.
+ */
+struct ADCStreamStage {
+  /**
+   * @brief   Stage function.
+   */
+  adcsstagefn_t             fn;
+  /**
+   * @brief   Stage decimation factor, must be a divisor of the block depth.
+   */
+  size_t                    factor;
+};
+
+/**
+ * @brief   Header of a samples block.
+ * @details The block samples immediately follow the header in memory,
+ *          use @p adcsGetSamplesX() in order to access them.
+ */
+typedef struct {
+  /**
+   * @brief   Block sequence number.
+   * @note    A gap in the sequence means that blocks have been dropped
+   *          because an overrun.
+   */
+  uint32_t                  sequence;
+  /**
+   * @brief   System time at the moment the block was captured.
+   */
+  systime_t                 time;
+  /**
+   * @brief   Number of rows in the block.
+   */
+  size_t                    frames;
+} adcsblock_t;
+
+/**
+ * @brief   ADC stream configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Circular conversion group, its @p end_cb callback must
+   *          invoke @p adcsPostFromISR().
+   */
+  const ADCConversionGroup  *grpp;
+  /**
+   * @brief   Circular samples buffer used by the ADC driver.
+   */
+  adcsample_t               *samples;
+  /**
+   * @brief   Depth of the circular samples buffer, it must be an even number.
+   */
+  size_t                    depth;
+  /**
+   * @brief   Memory area for the blocks queue.
+   * @note    Use @p ADCS_BUFFER_SIZE() in order to size it.
+   */
+  uint8_t                   *buffers;
+  /**
+   * @brief   Number of blocks in the queue.
+   */
+  size_t                    nblocks;
+  /**
+   * @brief   Processing stages array or @p NULL.
+   */
+  const ADCStreamStage      *stages;
+  /**
+   * @brief   Number of processing stages.
+   */
+  size_t                    nstages;
+} ADCStreamConfig;
+
+/**
+ * @brief   Structure representing an ADC stream.
+ */
+struct ADCStream {
+  /**
+   * @brief   Associated ADC driver.
+   */
+  ADCDriver                 *adcp;
+  /**
+   * @brief   Current configuration or @p NULL if stopped.
+   */
+  const ADCStreamConfig     *config;
+  /**
+   * @brief   Queue of filled blocks.
+   */
+  input_buffers_queue_t     ibq;
+  /**
+   * @brief   Sequence number of the next captured block.
+   */
+  uint32_t                  sequence;
+  /**
+   * @brief   Number of blocks dropped because the queue was full.
+   */
+  volatile uint32_t         overruns;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of a single block for the specified geometry.
+ * @note    The size is rounded up to a multiple of @p size_t in order to
+ *          keep all the blocks in the queue aligned.
+ *
+ * @param[in] depth     circular samples buffer depth
+ * @param[in] nch       number of channels in the conversion group
+ */
+#define ADCS_BLOCK_SIZE(depth, nch)                                         \
+  ((sizeof (adcsblock_t) +                                                  \
+    (((size_t)(depth) / 2U) * (size_t)(nch) * sizeof (adcsample_t)) +      \
+    (sizeof (size_t) - 1U)) & ~(sizeof (size_t) - 1U))
+
+/**
+ * @brief   Size of the memory area required by the blocks queue.
+ *
+ * @param[in] n         number of blocks in the queue
+ * @param[in] depth     circular samples buffer depth
+ * @param[in] nch       number of channels in the conversion group
+ */
+#define ADCS_BUFFER_SIZE(n, depth, nch)                                     \
+  BQ_BUFFER_SIZE(n, ADCS_BLOCK_SIZE(depth, nch))
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Returns a pointer to the samples of a block.
+ *
+ * @param[in] bp        pointer to an @p adcsblock_t header
+ * @return              The pointer to the first sample in the block.
+ *
+ * @xclass
+ */
+#define adcsGetSamplesX(bp) ((adcsample_t *)(void *)((bp) + 1))
+
+/**
+ * @brief   Returns the number of dropped blocks.
+ *
+ * @param[in] adcsp     pointer to the @p ADCStream object
+ * @return              The overruns counter.
+ *
+ * @xclass
+ */
+#define adcsGetOverrunsX(adcsp) ((adcsp)->overruns)
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void adcsObjectInit(ADCStream *adcsp, ADCDriver *adcp);
+  void adcsStart(ADCStream *adcsp, const ADCStreamConfig *config);
+  void adcsStop(ADCStream *adcsp);
+  void adcsPostFromISR(ADCStream *adcsp, const adcsample_t *buffer,
+                       size_t n);
+  adcsblock_t *adcsGetBlockTimeout(ADCStream *adcsp, systime_t timeout);
+  msg_t adcsReleaseBlock(ADCStream *adcsp);
+  size_t adcsStageDecimate(const ADCStreamStage *stgp,
+                           adcsample_t *samples,
+                           size_t frames,
+                           size_t nch);
+  size_t adcsStageAverage(const ADCStreamStage *stgp,
+                          adcsample_t *samples,
+                          size_t frames,
+                          size_t nch);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_ADC == TRUE */
+
+#endif /* HAL_ADC_STREAM_H */
+
+/** @} */
@@ -27,22 +27,95 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 #include "chprintf.h"
-#include "memstreams.h"
 
-#define MAX_FILLER 11
-#define FLOAT_PRECISION 9
+#define MAX_FILLER ((sizeof (long) * 8U + 2U) / 3U)
+#define MAX_FILLER_LL ((sizeof (long long) * 8U + 2U) / 3U)
+/* Decimal digits exactly representable by the float mantissa, the scaled
+   fractional part must stay below 2^24.*/
+#define FLOAT_PRECISION 7
+
+#if CHPRINTF_USE_FLOAT
+#define TMPBUF_SIZE (2 * MAX_FILLER + 2)
+#elif CHPRINTF_USE_LONG_LONG
+#define TMPBUF_SIZE (MAX_FILLER_LL + 2)
+#else
+#define TMPBUF_SIZE (MAX_FILLER + 2)
+#endif
+
+/**
+ * @brief   Formatter output state.
+ * @details Output is staged in a buffer and written in blocks, when
+ *          @p chp is @p NULL then the buffer is the final destination and
+ *          the output exceeding it is discarded.
+ */
+typedef struct {
+  BaseSequentialStream  *chp;
+  uint8_t               *buf;
+  uint8_t               *ptr;
+  uint8_t               *top;
+  int                   n;
+} fmtout_t;
+
+static void out_flush(fmtout_t *op) {
+
+  if ((op->chp != NULL) && (op->ptr > op->buf)) {
+    (void) streamWrite(op->chp, op->buf, (size_t)(op->ptr - op->buf));
+    op->ptr = op->buf;
+  }
+}
+
+static void out_put(fmtout_t *op, char c) {
+
+  op->n++;
+  if (op->ptr >= op->top) {
+    if (op->chp == NULL)
+      return;
+    out_flush(op);
+  }
+  *op->ptr++ = (uint8_t)c;
+}
+
+static void out_fill(fmtout_t *op, char c, int n) {
+
+  while (n-- > 0)
+    out_put(op, c);
+}
+
+static void out_write(fmtout_t *op, const char *s, size_t n) {
+
+  op->n += (int)n;
+  if (n > (size_t)(op->top - op->ptr)) {
+    if (op->chp == NULL) {
+      /* Memory output, truncating.*/
+      n = (size_t)(op->top - op->ptr);
+    }
+    else {
+      out_flush(op);
+      if (n > (size_t)(op->top - op->buf)) {
+        /* Too large for the buffer, written directly.*/
+        (void) streamWrite(op->chp, (const uint8_t *)s, n);
+        return;
+      }
+    }
+  }
+  if (n > 0) {
+    memcpy(op->ptr, s, n);
+    op->ptr += n;
+  }
+}
 
-static char *long_to_string_with_divisor(char *p,
-                                         long num,
-                                         unsigned radix,
-                                         long divisor) {
+static char *ulong_to_string_with_divisor(char *p,
+                                          unsigned long num,
+                                          unsigned radix,
+                                          unsigned long divisor) {
   int i;
   char *q;
-  long l, ll;
+  unsigned long ll;
 
-  l = num;
   if (divisor == 0) {
     ll = num;
   } else {
@@ -51,12 +124,12 @@ static char *long_to_string_with_divisor(char *p,
 
   q = p + MAX_FILLER;
   do {
-    i = (int)(l % radix);
+    i = (int)(num % radix);
     i += '0';
     if (i > '9')
       i += 'A' - '0' - 10;
     *--q = i;
-    l /= radix;
+    num /= radix;
   } while ((ll /= radix) != 0);
 
   i = (int)(p + MAX_FILLER - q);
@@ -67,79 +140,86 @@ static char *long_to_string_with_divisor(char *p,
   return p;
 }
 
-static char *ch_ltoa(char *p, long num, unsigned radix) {
+static char *ch_ultoa(char *p, unsigned long num, unsigned radix) {
+
+  return ulong_to_string_with_divisor(p, num, radix, 0);
+}
+
+#if CHPRINTF_USE_LONG_LONG
+static char *ch_ulltoa(char *p, unsigned long long num, unsigned radix) {
+  int i;
+  char *q;
+
+  /* Values fitting a long use the faster conversion.*/
+  if (num <= (unsigned long long)(unsigned long)-1)
+    return ch_ultoa(p, (unsigned long)num, radix);
+
+  q = p + MAX_FILLER_LL;
+  do {
+    i = (int)(num % radix);
+    i += '0';
+    if (i > '9')
+      i += 'A' - '0' - 10;
+    *--q = i;
+    num /= radix;
+  } while (num != 0);
+
+  i = (int)(p + MAX_FILLER_LL - q);
+  do
+    *p++ = *q++;
+  while (--i);
 
-  return long_to_string_with_divisor(p, num, radix, 0);
+  return p;
 }
+#endif
 
 #if CHPRINTF_USE_FLOAT
-static const long pow10[FLOAT_PRECISION] = {
-    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+static const unsigned long pow10[FLOAT_PRECISION] = {
+    10, 100, 1000, 10000, 100000, 1000000, 10000000
 };
 
-static char *ftoa(char *p, double num, unsigned long precision) {
-  long l;
+static char *ftoa(char *p, float num, unsigned long precision) {
+  unsigned long l;
 
   if ((precision == 0) || (precision > FLOAT_PRECISION))
     precision = FLOAT_PRECISION;
   precision = pow10[precision - 1];
 
-  l = (long)num;
-  p = long_to_string_with_divisor(p, l, 10, 0);
+  /* Single precision arithmetic only, no double emulation.*/
+  l = (unsigned long)num;
+  p = ulong_to_string_with_divisor(p, l, 10, 0);
   *p++ = '.';
-  l = (long)((num - l) * precision);
-  return long_to_string_with_divisor(p, l, 10, precision / 10);
+  l = (unsigned long)((num - (float)l) * (float)precision);
+  return ulong_to_string_with_divisor(p, l, 10, precision / 10);
 }
 #endif
 
-/**
- * @brief   System formatted output function.
- * @details This function implements a minimal @p vprintf()-like functionality
- *          with output on a @p BaseSequentialStream.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
- *          The following parameter types (p) are supported:
- *          - <b>x</b> hexadecimal integer.
- *          - <b>X</b> hexadecimal long.
- *          - <b>o</b> octal integer.
- *          - <b>O</b> octal long.
- *          - <b>d</b> decimal signed integer.
- *          - <b>D</b> decimal signed long.
- *          - <b>u</b> decimal unsigned integer.
- *          - <b>U</b> decimal unsigned long.
- *          - <b>c</b> character.
- *          - <b>s</b> string.
- *          .
- *
- * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
- * @param[in] fmt       formatting string
- * @param[in] ap        list of parameters
- * @return              The number of bytes that would have been
- *                      written to @p chp if no stream error occurs
- *
- * @api
- */
-int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
+static void format(fmtout_t *op, const char *fmt, va_list ap) {
+  const char *lit;
   char *p, *s, c, filler;
   int i, precision, width;
-  int n = 0;
   bool is_long, left_align;
   long l;
+#if CHPRINTF_USE_LONG_LONG
+  bool is_long_long;
+  long long ll;
+#endif
 #if CHPRINTF_USE_FLOAT
   float f;
-  char tmpbuf[2*MAX_FILLER + 1];
-#else
-  char tmpbuf[MAX_FILLER + 1];
 #endif
+  char tmpbuf[TMPBUF_SIZE];
 
   while (true) {
-    c = *fmt++;
-    if (c == 0)
-      return n;
-    if (c != '%') {
-      streamPut(chp, (uint8_t)c);
-      n++;
-      continue;
-    }
+    /* Literal characters are written as a single run.*/
+    lit = fmt;
+    while ((*fmt != 0) && (*fmt != '%'))
+      fmt++;
+    if (fmt > lit)
+      out_write(op, lit, (size_t)(fmt - lit));
+    if (*fmt == 0)
+      return;
+    fmt++;
+
     p = tmpbuf;
     s = tmpbuf;
     left_align = FALSE;
@@ -178,10 +258,19 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
       }
     }
     /* Long modifier.*/
+#if CHPRINTF_USE_LONG_LONG
+    is_long_long = FALSE;
+#endif
     if (c == 'l' || c == 'L') {
       is_long = TRUE;
       if (*fmt)
         c = *fmt++;
+#if CHPRINTF_USE_LONG_LONG
+      if ((c == 'l') && *fmt) {
+        is_long_long = TRUE;
+        c = *fmt++;
+      }
+#endif
     }
     else
       is_long = (c >= 'A') && (c <= 'Z');
@@ -205,15 +294,28 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
     case 'd':
     case 'I':
     case 'i':
+#if CHPRINTF_USE_LONG_LONG
+      if (is_long_long) {
+        ll = va_arg(ap, long long);
+        if (ll < 0) {
+          *p++ = '-';
+          p = ch_ulltoa(p, 0ULL - (unsigned long long)ll, 10);
+        }
+        else
+          p = ch_ulltoa(p, (unsigned long long)ll, 10);
+        break;
+      }
+#endif
       if (is_long)
         l = va_arg(ap, long);
       else
         l = va_arg(ap, int);
       if (l < 0) {
         *p++ = '-';
-        l = -l;
+        p = ch_ultoa(p, 0UL - (unsigned long)l, 10);
       }
-      p = ch_ltoa(p, l, 10);
+      else
+        p = ch_ultoa(p, (unsigned long)l, 10);
       break;
 #if CHPRINTF_USE_FLOAT
     case 'f':
@@ -237,11 +339,16 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
     case 'o':
       c = 8;
 unsigned_common:
+#if CHPRINTF_USE_LONG_LONG
+      if (is_long_long) {
+        p = ch_ulltoa(p, va_arg(ap, unsigned long long), c);
+        break;
+      }
+#endif
       if (is_long)
-        l = va_arg(ap, unsigned long);
+        p = ch_ultoa(p, va_arg(ap, unsigned long), c);
       else
-        l = va_arg(ap, unsigned int);
-      p = ch_ltoa(p, l, c);
+        p = ch_ultoa(p, va_arg(ap, unsigned int), c);
       break;
     default:
       *p++ = c;
@@ -254,33 +361,69 @@ unsigned_common:
       width = -width;
     if (width < 0) {
       if (*s == '-' && filler == '0') {
-        streamPut(chp, (uint8_t)*s++);
-        n++;
+        out_put(op, *s++);
         i--;
       }
-      do {
-        streamPut(chp, (uint8_t)filler);
-        n++;
-      } while (++width != 0);
-    }
-    while (--i >= 0) {
-      streamPut(chp, (uint8_t)*s++);
-      n++;
-    }
-
-    while (width) {
-      streamPut(chp, (uint8_t)filler);
-      n++;
-      width--;
+      out_fill(op, filler, -width);
+      width = 0;
     }
+    out_write(op, s, (size_t)i);
+    out_fill(op, filler, width);
   }
 }
 
+/**
+ * @brief   System formatted output function.
+ * @details This function implements a minimal @p vprintf()-like functionality
+ *          with output on a @p BaseSequentialStream.
+ *          The general parameters format is: %[-][width|*][.precision|*][l|L|ll]p.
+ *          The following parameter types (p) are supported:
+ *          - <b>x</b> hexadecimal integer.
+ *          - <b>X</b> hexadecimal long.
+ *          - <b>o</b> octal integer.
+ *          - <b>O</b> octal long.
+ *          - <b>d</b> decimal signed integer.
+ *          - <b>D</b> decimal signed long.
+ *          - <b>u</b> decimal unsigned integer.
+ *          - <b>U</b> decimal unsigned long.
+ *          - <b>c</b> character.
+ *          - <b>s</b> string.
+ *          - <b>f</b> floating point, at most 7 decimal digits.
+ *          .
+ *          The output is staged in a buffer of @p CHPRINTF_BUFFER_SIZE
+ *          bytes on the stack and written to the stream in blocks.
+ * @note    The @p ll modifier requires @p CHPRINTF_USE_LONG_LONG.
+ * @note    The @p f conversion requires @p CHPRINTF_USE_FLOAT, it is
+ *          performed in single precision.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
+ * @param[in] fmt       formatting string
+ * @param[in] ap        list of parameters
+ * @return              The number of bytes that would have been
+ *                      written to @p chp if no stream error occurs
+ *
+ * @api
+ */
+int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
+  fmtout_t out;
+  uint8_t buf[CHPRINTF_BUFFER_SIZE];
+
+  out.chp = chp;
+  out.buf = buf;
+  out.ptr = buf;
+  out.top = buf + CHPRINTF_BUFFER_SIZE;
+  out.n   = 0;
+  format(&out, fmt, ap);
+  out_flush(&out);
+
+  return out.n;
+}
+
 /**
  * @brief   System formatted output function.
  * @details This function implements a minimal @p printf() like functionality
  *          with output on a @p BaseSequentialStream.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
+ *          The general parameters format is: %[-][width|*][.precision|*][l|L|ll]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
  *          - <b>X</b> hexadecimal long.
@@ -312,9 +455,9 @@ int chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
 
 /**
  * @brief   System formatted output function.
- * @details This function implements a minimal @p vprintf()-like functionality
- *          with output on a @p BaseSequentialStream.
- *          The general parameters format is: %[-][width|*][.precision|*][l|L]p.
+ * @details This function implements a minimal @p vsnprintf()-like
+ *          functionality, the output is written directly in the buffer.
+ *          The general parameters format is: %[-][width|*][.precision|*][l|L|ll]p.
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
  *          - <b>X</b> hexadecimal long.
@@ -332,39 +475,69 @@ int chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
  * @param[in] str       pointer to a buffer
  * @param[in] size      maximum size of the buffer
  * @param[in] fmt       formatting string
+ * @param[in] ap        list of parameters
  * @return              The number of characters (excluding the
  *                      terminating NUL byte) that would have been
  *                      stored in @p str if there was room.
  *
  * @api
  */
-int chsnprintf(char *str, size_t size, const char *fmt, ...) {
-  va_list ap;
-  MemoryStream ms;
-  BaseSequentialStream *chp;
-  size_t size_wo_nul;
-  int retval;
+int chvsnprintf(char *str, size_t size, const char *fmt, va_list ap) {
+  fmtout_t out;
+
+  /* The buffer is the final destination, reserving one byte for the
+     final zero.*/
+  out.chp = NULL;
+  out.buf = (uint8_t *)str;
+  out.ptr = (uint8_t *)str;
+  out.top = (uint8_t *)str + (size > 0 ? size - 1 : 0);
+  out.n   = 0;
+  format(&out, fmt, ap);
 
+  /* Terminate with a zero, unless size==0.*/
   if (size > 0)
-    size_wo_nul = size - 1;
-  else
-    size_wo_nul = 0;
+    *out.ptr = 0;
 
-  /* Memory stream object to be used as a string writer, reserving one
-     byte for the final zero.*/
-  msObjectInit(&ms, (uint8_t *)str, size_wo_nul, 0);
+  /* Return number of bytes that would have been written.*/
+  return out.n;
+}
+
+/**
+ * @brief   System formatted output function.
+ * @details This function implements a minimal @p snprintf()-like
+ *          functionality, the output is written directly in the buffer.
+ *          The general parameters format is: %[-][width|*][.precision|*][l|L|ll]p.
+ *          The following parameter types (p) are supported:
+ *          - <b>x</b> hexadecimal integer.
+ *          - <b>X</b> hexadecimal long.
+ *          - <b>o</b> octal integer.
+ *          - <b>O</b> octal long.
+ *          - <b>d</b> decimal signed integer.
+ *          - <b>D</b> decimal signed long.
+ *          - <b>u</b> decimal unsigned integer.
+ *          - <b>U</b> decimal unsigned long.
+ *          - <b>c</b> character.
+ *          - <b>s</b> string.
+ *          .
+ * @post    @p str is NUL-terminated, unless @p size is 0.
+ *
+ * @param[in] str       pointer to a buffer
+ * @param[in] size      maximum size of the buffer
+ * @param[in] fmt       formatting string
+ * @return              The number of characters (excluding the
+ *                      terminating NUL byte) that would have been
+ *                      stored in @p str if there was room.
+ *
+ * @api
+ */
+int chsnprintf(char *str, size_t size, const char *fmt, ...) {
+  va_list ap;
+  int retval;
 
-  /* Performing the print operation using the common code.*/
-  chp = (BaseSequentialStream *)(void *)&ms;
   va_start(ap, fmt);
-  retval = chvprintf(chp, fmt, ap);
+  retval = chvsnprintf(str, size, fmt, ap);
   va_end(ap);
 
-  /* Terminate with a zero, unless size==0.*/
-  if (ms.eos < size)
-      str[ms.eos] = 0;
-
-  /* Return number of bytes that would have been written.*/
   return retval;
 }
 
@@ -34,11 +34,35 @@
 #define CHPRINTF_USE_FLOAT          FALSE
 #endif
 
+/**
+ * @brief   64 bits integers support.
+ * @details If enabled then the @p ll modifier is accepted by the
+ *          integer conversions.
+ */
+#if !defined(CHPRINTF_USE_LONG_LONG) || defined(__DOXYGEN__)
+#define CHPRINTF_USE_LONG_LONG      FALSE
+#endif
+
+/**
+ * @brief   Size of the output staging buffer.
+ * @details The buffer is allocated on the stack of the calling thread,
+ *          the formatted output is written to the stream in blocks of
+ *          this size.
+ */
+#if !defined(CHPRINTF_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CHPRINTF_BUFFER_SIZE        32
+#endif
+
+#if CHPRINTF_BUFFER_SIZE < 1
+#error "invalid CHPRINTF_BUFFER_SIZE value"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
   int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap);
   int chprintf(BaseSequentialStream *chp, const char *fmt, ...);
+  int chvsnprintf(char *str, size_t size, const char *fmt, va_list ap);
   int chsnprintf(char *str, size_t size, const char *fmt, ...);
 #ifdef __cplusplus
 }
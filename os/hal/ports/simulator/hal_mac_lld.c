@@ -0,0 +1,474 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_mac_lld.c
+ * @brief   Simulator low level MAC driver code.
+ * @details The driver implements two virtual Ethernet interfaces connected
+ *          back to back, a frame transmitted on one interface is copied
+ *          in the next free receive slot of the other interface. Frames
+ *          are dropped when the receiving interface is not active or has
+ *          no free slots.
+ *
+ * @addtogroup SIM_MAC
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the slot following the specified one in a ring.
+ */
+#define next_slot(ring, sp)                                                 \
+  ((sp) + 1 < &(ring)[SIM_MAC_BUFFERS] ? (sp) + 1 : &(ring)[0])
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   ETHD1 driver identifier.
+ */
+#if USE_SIM_MAC1 || defined(__DOXYGEN__)
+MACDriver ETHD1;
+#endif
+
+/**
+ * @brief   ETHD2 driver identifier.
+ */
+#if USE_SIM_MAC2 || defined(__DOXYGEN__)
+MACDriver ETHD2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Header of a pcap capture file.
+ */
+static const uint32_t pcap_header[6] = {
+  0xA1B2C3D4U,                      /* Magic, native byte order.            */
+  0x00040002U,                      /* Version 2.4.                         */
+  0U,                               /* GMT offset.                          */
+  0U,                               /* Timestamps accuracy.                 */
+  SIM_MAC_BUFFERS_SIZE,             /* Snapshot length.                     */
+  1U                                /* Link type Ethernet.                  */
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Appends a frame to the capture file of an interface, if any.
+ * @details The record header and the frame data are written under the
+ *          capture mutex so that records are never interleaved.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] sp        the slot containing the frame
+ */
+static void pcap_write(MACDriver *macp, const sim_mac_slot_t *sp) {
+  systime_t now = osalOsGetSystemTimeX();
+  uint32_t hdr[4];
+
+  if (macp->pcap == NULL) {
+    return;
+  }
+
+  hdr[0] = (uint32_t)(now / OSAL_ST_FREQUENCY);
+  hdr[1] = (uint32_t)(((uint64_t)(now % OSAL_ST_FREQUENCY) * 1000000U) /
+                      OSAL_ST_FREQUENCY);
+  hdr[2] = (uint32_t)sp->size;
+  hdr[3] = (uint32_t)sp->size;
+  osalMutexLock(&macp->pcap_mtx);
+  (void) fwrite(hdr, sizeof hdr, 1, macp->pcap);
+  (void) fwrite(sp->data, 1, sp->size, macp->pcap);
+  osalMutexUnlock(&macp->pcap_mtx);
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+
+#if USE_SIM_MAC1
+  macObjectInit(&ETHD1);
+  ETHD1.peer = NULL;
+  ETHD1.pcap = NULL;
+  osalMutexObjectInit(&ETHD1.pcap_mtx);
+#endif
+#if USE_SIM_MAC2
+  macObjectInit(&ETHD2);
+  ETHD2.peer = NULL;
+  ETHD2.pcap = NULL;
+  osalMutexObjectInit(&ETHD2.pcap_mtx);
+#endif
+#if USE_SIM_MAC1 && USE_SIM_MAC2
+  /* The two interfaces are connected back to back.*/
+  ETHD1.peer = &ETHD2;
+  ETHD2.peer = &ETHD1;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_start(MACDriver *macp) {
+  unsigned i;
+
+  /* Slots reset.*/
+  for (i = 0U; i < SIM_MAC_BUFFERS; i++) {
+    macp->rd[i].state = SIM_MAC_FREE;
+    macp->td[i].state = SIM_MAC_FREE;
+  }
+  macp->rxptr   = &macp->rd[0];
+  macp->wrptr   = &macp->rd[0];
+  macp->txptr   = &macp->td[0];
+  macp->dropped = 0U;
+
+  /* Optional capture file.*/
+  if ((macp->state == MAC_STOP) && (macp->config->pcap_file != NULL)) {
+    macp->pcap = fopen(macp->config->pcap_file, "wb");
+    if (macp->pcap != NULL) {
+      (void) fwrite(pcap_header, sizeof pcap_header, 1, macp->pcap);
+    }
+  }
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_stop(MACDriver *macp) {
+
+  if ((macp->state != MAC_STOP) && (macp->pcap != NULL)) {
+    (void) fclose(macp->pcap);
+    macp->pcap = NULL;
+  }
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  sim_mac_slot_t *sp;
+
+  osalSysLock();
+  sp = macp->txptr;
+  if (sp->state != SIM_MAC_FREE) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+  sp->state = SIM_MAC_LOCKED;
+  macp->txptr = next_slot(macp->td, sp);
+  osalSysUnlock();
+
+  tdp->offset   = 0U;
+  tdp->size     = SIM_MAC_BUFFERS_SIZE;
+  tdp->macp     = macp;
+  tdp->physdesc = sp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ * @details The frame is copied in the next receive slot of the peer
+ *          interface, if available, then the peer is notified.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+  MACDriver *macp = tdp->macp;
+  MACDriver *peer = macp->peer;
+  sim_mac_slot_t *sp = tdp->physdesc;
+  sim_mac_slot_t *dp = NULL;
+
+  osalDbgAssert(sp->state == SIM_MAC_LOCKED, "attempt to release descriptor "
+                                             "already owned by the MAC");
+
+  sp->size = tdp->offset;
+  pcap_write(macp, sp);
+
+  /* Reserving a receive slot on the other side of the wire.*/
+  osalSysLock();
+  if ((peer != NULL) && (peer->state == MAC_ACTIVE) &&
+      (peer->wrptr->state == SIM_MAC_FREE)) {
+    dp = peer->wrptr;
+    dp->state = SIM_MAC_LOCKED;
+    peer->wrptr = next_slot(peer->rd, dp);
+  }
+  else {
+    macp->dropped++;
+  }
+  osalSysUnlock();
+
+  /* The copy is performed outside the critical zone.*/
+  if (dp != NULL) {
+    memcpy(dp->data, sp->data, sp->size);
+    dp->size = sp->size;
+    pcap_write(peer, dp);
+  }
+
+  osalSysLock();
+  if (dp != NULL) {
+    dp->state = SIM_MAC_READY;
+    osalThreadDequeueAllI(&peer->rdqueue, MSG_RESET);
+#if MAC_USE_EVENTS
+    osalEventBroadcastFlagsI(&peer->rdevent, 0);
+#endif
+  }
+  sp->state = SIM_MAC_FREE;
+  osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+  sim_mac_slot_t *sp;
+
+  osalSysLock();
+  sp = macp->rxptr;
+  if (sp->state != SIM_MAC_READY) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+  sp->state = SIM_MAC_LOCKED;
+  macp->rxptr = next_slot(macp->rd, sp);
+  osalSysUnlock();
+
+  rdp->offset   = 0U;
+  rdp->size     = sp->size;
+  rdp->macp     = macp;
+  rdp->physdesc = sp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+
+  osalDbgAssert(rdp->physdesc->state == SIM_MAC_LOCKED,
+                "attempt to release descriptor already owned by the MAC");
+
+  osalSysLock();
+  rdp->physdesc->state = SIM_MAC_FREE;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ * @details The link is up when the peer interface is active.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @notapi
+ */
+bool mac_lld_poll_link_status(MACDriver *macp) {
+
+  return (bool)((macp->peer != NULL) && (macp->peer->state == MAC_ACTIVE));
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer containing the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+
+  if (size > tdp->size - tdp->offset) {
+    size = tdp->size - tdp->offset;
+  }
+  memcpy(&tdp->physdesc->data[tdp->offset], buf, size);
+  tdp->offset += size;
+
+  return size;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  if (size > rdp->size - rdp->offset) {
+    size = rdp->size - rdp->offset;
+  }
+  memcpy(buf, &rdp->physdesc->data[rdp->offset], size);
+  rdp->offset += size;
+
+  return size;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ *                      Note that a returned size lower than the amount
+ *                      requested means that more buffers must be requested
+ *                      in order to fill the frame data entirely.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+  uint8_t *buf;
+
+  if (tdp->offset >= tdp->size) {
+    *sizep = 0U;
+    return NULL;
+  }
+  if (size > tdp->size - tdp->offset) {
+    size = tdp->size - tdp->offset;
+  }
+  buf = &tdp->physdesc->data[tdp->offset];
+  tdp->offset += size;
+  *sizep = size;
+
+  return buf;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+  const uint8_t *buf;
+
+  if (rdp->offset >= rdp->size) {
+    *sizep = 0U;
+    return NULL;
+  }
+  buf = &rdp->physdesc->data[rdp->offset];
+  *sizep = rdp->size - rdp->offset;
+  rdp->offset = rdp->size;
+
+  return buf;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
@@ -0,0 +1,308 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_mac_lld.h
+ * @brief   Simulator low level MAC driver header.
+ *
+ * @addtogroup SIM_MAC
+ * @{
+ */
+
+#ifndef HAL_MAC_LLD_H
+#define HAL_MAC_LLD_H
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+#include <stdio.h>
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the zero-copy mode API.
+ */
+#define MAC_SUPPORTS_ZERO_COPY      TRUE
+
+/**
+ * @name    Simulated descriptor states
+ * @{
+ */
+#define SIM_MAC_FREE                0U  /**< @brief Slot available.         */
+#define SIM_MAC_LOCKED              1U  /**< @brief Slot owned by a
+                                             descriptor.                    */
+#define SIM_MAC_READY               2U  /**< @brief Slot contains a frame.  */
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Simulator configuration options
+ * @{
+ */
+/**
+ * @brief   ETHD1 driver enable switch.
+ * @details If set to @p TRUE the support for ETHD1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_MAC1) || defined(__DOXYGEN__)
+#define USE_SIM_MAC1                        TRUE
+#endif
+
+/**
+ * @brief   ETHD2 driver enable switch.
+ * @details If set to @p TRUE the support for ETHD2 is included, ETHD2 is
+ *          cross-connected to ETHD1, frames sent on one interface are
+ *          received by the other.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_MAC2) || defined(__DOXYGEN__)
+#define USE_SIM_MAC2                        TRUE
+#endif
+
+/**
+ * @brief   Number of receive slots of each interface.
+ * @details The same number of transmit descriptors is available.
+ */
+#if !defined(SIM_MAC_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_BUFFERS                     8
+#endif
+
+/**
+ * @brief   Size of each slot, it is the maximum frame size.
+ */
+#if !defined(SIM_MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define SIM_MAC_BUFFERS_SIZE                1536
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_MAC1 && !USE_SIM_MAC2
+#error "MAC driver activated but no MAC peripheral assigned"
+#endif
+
+#if SIM_MAC_BUFFERS < 2
+#error "SIM_MAC_BUFFERS must be at least 2"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a simulated frame slot.
+ */
+typedef struct {
+  /**
+   * @brief Slot state.
+   */
+  volatile unsigned     state;
+  /**
+   * @brief Frame size.
+   */
+  size_t                size;
+  /**
+   * @brief Frame data.
+   */
+  uint8_t               data[SIM_MAC_BUFFERS_SIZE];
+} sim_mac_slot_t;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief MAC address.
+   */
+  uint8_t               *mac_address;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Capture file name or @p NULL.
+   * @details If specified then all the frames sent and received by the
+   *          interface are written in the file in pcap format.
+   */
+  const char            *pcap_file;
+} MACConfig;
+
+/**
+ * @brief   Structure representing a MAC driver.
+ */
+struct MACDriver {
+  /**
+   * @brief Driver state.
+   */
+  macstate_t            state;
+  /**
+   * @brief Current configuration data.
+   */
+  const MACConfig       *config;
+  /**
+   * @brief Transmit semaphore.
+   */
+  threads_queue_t       tdqueue;
+  /**
+   * @brief Receive semaphore.
+   */
+  threads_queue_t       rdqueue;
+#if MAC_USE_EVENTS || defined(__DOXYGEN__)
+  /**
+   * @brief Receive event.
+   */
+  event_source_t        rdevent;
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Cross-connected interface or @p NULL.
+   */
+  MACDriver             *peer;
+  /**
+   * @brief Receive slots, written by the peer interface.
+   */
+  sim_mac_slot_t        rd[SIM_MAC_BUFFERS];
+  /**
+   * @brief Transmit slots.
+   */
+  sim_mac_slot_t        td[SIM_MAC_BUFFERS];
+  /**
+   * @brief Next receive slot to be returned.
+   */
+  sim_mac_slot_t        *rxptr;
+  /**
+   * @brief Next receive slot to be written by the peer.
+   */
+  sim_mac_slot_t        *wrptr;
+  /**
+   * @brief Next transmit slot to be returned.
+   */
+  sim_mac_slot_t        *txptr;
+  /**
+   * @brief Capture file or @p NULL.
+   */
+  FILE                  *pcap;
+  /**
+   * @brief Capture file mutex.
+   * @details Both the interface and its peer append records to the file.
+   */
+  mutex_t               pcap_mtx;
+  /**
+   * @brief Frames dropped because the peer receive slots were full.
+   */
+  uint32_t              dropped;
+};
+
+/**
+ * @brief   Structure representing a transmit descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current write offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available space size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the owning driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Pointer to the transmit slot.
+   */
+  sim_mac_slot_t        *physdesc;
+} MACTransmitDescriptor;
+
+/**
+ * @brief   Structure representing a receive descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current read offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available data size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the owning driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Pointer to the receive slot.
+   */
+  sim_mac_slot_t        *physdesc;
+} MACReceiveDescriptor;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_MAC1 && !defined(__DOXYGEN__)
+extern MACDriver ETHD1;
+#endif
+
+#if USE_SIM_MAC2 && !defined(__DOXYGEN__)
+extern MACDriver ETHD2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mac_lld_init(void);
+  void mac_lld_start(MACDriver *macp);
+  void mac_lld_stop(MACDriver *macp);
+  msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                        MACTransmitDescriptor *tdp);
+  void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp);
+  msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                       MACReceiveDescriptor *rdp);
+  void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
+  bool mac_lld_poll_link_status(MACDriver *macp);
+  size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                           uint8_t *buf,
+                                           size_t size);
+  size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                         uint8_t *buf,
+                                         size_t size);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_MAC */
+
+#endif /* HAL_MAC_LLD_H */
+
+/** @} */
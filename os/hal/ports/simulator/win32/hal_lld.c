@@ -32,13 +32,41 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+static uint64_t nextcycles;
+#else
 static LARGE_INTEGER nextcnt;
 static LARGE_INTEGER slice;
+#endif
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Simulated system tick interrupt.
+ *
+ * @param[in] n         number of ticks to be processed back to back
+ */
+static void sim_tick(systime_t n) {
+
+  CH_IRQ_PROLOGUE();
+
+  chSysLockFromISR();
+  while (n > (systime_t)0) {
+    chSysTimerHandlerI();
+    n--;
+  }
+  chSysUnlockFromISR();
+
+  CH_IRQ_EPILOGUE();
+
+  _dbg_check_lock();
+  if (chSchIsPreemptionRequired())
+    chSchDoReschedule();
+  _dbg_check_unlock();
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -60,6 +88,10 @@ void hal_lld_init(void) {
   }
 
   printf("ChibiOS/RT simulator (Win32)\n");
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+  printf("Virtual time, %u Hz modelled clock\n", (unsigned)PORT_SIM_CLOCK);
+  nextcycles = port_sim_cycles + (PORT_SIM_CLOCK / CH_CFG_ST_FREQUENCY);
+#else
   if (!QueryPerformanceFrequency(&slice)) {
     printf("QueryPerformanceFrequency() error");
     exit(1);
@@ -67,6 +99,7 @@ void hal_lld_init(void) {
   slice.QuadPart /= CH_CFG_ST_FREQUENCY;
   QueryPerformanceCounter(&nextcnt);
   nextcnt.QuadPart += slice.QuadPart;
+#endif
 
   fflush(stdout);
 }
@@ -75,7 +108,9 @@ void hal_lld_init(void) {
  * @brief   Interrupt simulation.
  */
 void _sim_check_for_interrupts(void) {
+#if PORT_SIM_VIRTUAL_TIME == FALSE
   LARGE_INTEGER n;
+#endif
 
 #if HAL_USE_SERIAL
   if (sd_lld_interrupt_pending()) {
@@ -87,24 +122,67 @@ void _sim_check_for_interrupts(void) {
   }
 #endif
 
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+  /* Interrupt Timer simulation, the time spent by the caller since the
+     previous check is modelled as a fixed amount of cycles.*/
+  port_sim_cycles += (uint64_t)PORT_SIM_CHECK_CYCLES;
+  if (port_sim_cycles >= nextcycles) {
+    nextcycles += PORT_SIM_CLOCK / CH_CFG_ST_FREQUENCY;
+    sim_tick((systime_t)1);
+  }
+#else
   /* Interrupt Timer simulation (10ms interval).*/
   QueryPerformanceCounter(&n);
   if (n.QuadPart > nextcnt.QuadPart) {
     nextcnt.QuadPart += slice.QuadPart;
+    sim_tick((systime_t)1);
+  }
+#endif
+}
 
-    CH_IRQ_PROLOGUE();
-
-    chSysLockFromISR();
-    chSysTimerHandlerI();
-    chSysUnlockFromISR();
-
-    CH_IRQ_EPILOGUE();
+/**
+ * @brief   Interrupt wait simulation.
+ * @details Invoked by the idle thread. In virtual time mode nothing can
+ *          happen until the first virtual timer deadline so the virtual
+ *          clock jumps directly to it, the intermediate ticks are processed
+ *          back to back in a single step.
+ */
+void _sim_wait_for_interrupts(void) {
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+  systime_t delta;
+  bool pending;
 
+#if HAL_USE_SERIAL
+  if (sd_lld_interrupt_pending()) {
     _dbg_check_lock();
     if (chSchIsPreemptionRequired())
       chSchDoReschedule();
     _dbg_check_unlock();
+    return;
   }
+#endif
+
+  chSysLock();
+  pending = chVTGetTimersStateI(&delta);
+  chSysUnlock();
+
+  /* With no timers armed the time does not advance, only I/O events can
+     wake up a thread.*/
+  if (pending) {
+    if (delta == (systime_t)0) {
+      delta = (systime_t)1;
+    }
+    if (port_sim_cycles < nextcycles) {
+      port_sim_cycles = nextcycles;
+    }
+    port_sim_cycles += (uint64_t)(delta - (systime_t)1) *
+                       (PORT_SIM_CLOCK / CH_CFG_ST_FREQUENCY);
+    nextcycles = port_sim_cycles + (PORT_SIM_CLOCK / CH_CFG_ST_FREQUENCY);
+    sim_tick(delta);
+  }
+#else
+  _sim_check_for_interrupts();
+#endif
 }
 
 /** @} */
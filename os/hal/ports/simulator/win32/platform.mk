@@ -3,6 +3,7 @@ PLATFORMSRC = ${CHIBIOS}/os/hal/ports/simulator/win32/hal_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/win32/hal_serial_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/console.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_pal_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_mac_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_st_lld.c
 
 # Required include directories
@@ -0,0 +1,421 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_ioblock.c
+ * @brief   I/O block devices requests queue code.
+ * @details The requests queue makes the block devices accessible in an
+ *          asynchronous way. Requests are posted by any thread using
+ *          @p blkStartRead() or @p blkStartWrite() and are executed by a
+ *          thread running @p blkqServe(), the application defines the
+ *          serving thread priority and stack.<br>
+ *          Requests are served in block address order, requests touching
+ *          the same blocks of a pending request, where at least one of
+ *          them is a write, are never reordered.
+ * @note    While a queue is associated to a device the synchronous API
+ *          must not be used on the same device by other threads.
+ *
+ * @addtogroup IO_BLOCK
+ * @{
+ */
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks if two requests must be executed in arrival order.
+ *
+ * @param[in] a         first request
+ * @param[in] b         second request
+ * @return              The conflict status.
+ *
+ * @notapi
+ */
+static bool conflicting(const blk_request_t *a, const blk_request_t *b) {
+
+  return (a->write || b->write) &&
+         (a->startblk < (b->startblk + b->n)) &&
+         (b->startblk < (a->startblk + a->n));
+}
+
+/**
+ * @brief   Inserts a request in the pending list.
+ * @details The request is inserted in block address order unless it
+ *          conflicts with a pending request, in that case it is appended
+ *          to the deferred list.
+ *
+ * @param[in] bqp       pointer to the @p blk_queue_t object
+ * @param[in] brp       pointer to the request
+ * @return              The insertion result.
+ * @retval true         the request has been inserted in the pending list.
+ * @retval false        the request has been deferred.
+ *
+ * @notapi
+ */
+static bool insert(blk_queue_t *bqp, blk_request_t *brp) {
+  blk_request_t **pp, *p;
+
+  brp->next = NULL;
+
+  /* Once a request has been deferred all the following requests are
+     deferred too, the arrival order is preserved.*/
+  if (bqp->deferred == NULL) {
+    for (p = bqp->pending; p != NULL; p = p->next) {
+      if (conflicting(p, brp)) {
+        break;
+      }
+    }
+    if (p == NULL) {
+      pp = &bqp->pending;
+      while ((*pp != NULL) && ((*pp)->startblk <= brp->startblk)) {
+        pp = &(*pp)->next;
+      }
+      brp->next = *pp;
+      *pp = brp;
+      return true;
+    }
+  }
+
+  pp = &bqp->deferred;
+  while (*pp != NULL) {
+    pp = &(*pp)->next;
+  }
+  *pp = brp;
+  return false;
+}
+
+/**
+ * @brief   Completes a request.
+ *
+ * @param[in] brp       pointer to the request
+ * @param[in] result    the request result
+ *
+ * @notapi
+ */
+static void complete(blk_request_t *brp, bool result) {
+
+  /* The callback is invoked before waking up the waiting thread, in the
+     same critical zone, so the request cannot be reused while the callback
+     is still accessing it.*/
+  osalSysLock();
+  brp->result = result;
+  brp->done   = true;
+  if (brp->callback != NULL) {
+    brp->callback(brp);
+  }
+
+  /* The waiting thread is not resumed if the callback posted the request
+     again, it is resumed on the final completion.*/
+  if (brp->done) {
+    osalThreadResumeS(&brp->thread, MSG_OK);
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Completes a list of requests.
+ *
+ * @param[in] brp       pointer to the first request, the list is terminated
+ *                      by @p end
+ * @param[in] end       request following the last one or @p NULL
+ * @param[in] result    the requests result
+ *
+ * @notapi
+ */
+static void complete_list(blk_request_t *brp, blk_request_t *end,
+                          bool result) {
+
+  while (brp != end) {
+    /* The request can be reused as soon as it is completed.*/
+    blk_request_t *next = brp->next;
+
+    complete(brp, result);
+    brp = next;
+  }
+}
+
+/**
+ * @brief   Serves a list of requests sorted by block address.
+ *
+ * @param[in] bqp       pointer to the @p blk_queue_t object
+ * @param[in] list      the requests list
+ *
+ * @notapi
+ */
+static void serve_list(blk_queue_t *bqp, blk_request_t *list) {
+  BlockDeviceInfo bdi;
+  blk_request_t *brp, *last, **pp;
+
+  /* Circular scan, the requests starting after the current position are
+     served first, then the others.*/
+  pp = &list;
+  while ((*pp != NULL) && ((*pp)->startblk < bqp->position)) {
+    pp = &(*pp)->next;
+  }
+  if ((*pp != NULL) && (pp != &list)) {
+    brp = *pp;
+    *pp = NULL;
+    for (last = brp; last->next != NULL; last = last->next) {
+    }
+    last->next = list;
+    list = brp;
+  }
+
+  if (blkGetInfo(bqp->bdp, &bdi) != HAL_SUCCESS) {
+    complete_list(list, NULL, HAL_FAILED);
+    return;
+  }
+
+  brp = list;
+  while (brp != NULL) {
+    blk_request_t *next;
+    uint32_t n;
+    bool result;
+
+    /* Merging the following requests if adjacent on both the device and
+       the memory.*/
+    n = brp->n;
+    last = brp;
+    while ((last->next != NULL) &&
+           (last->next->write == brp->write) &&
+           (last->next->startblk == brp->startblk + n) &&
+           (last->next->buffer == brp->buffer + (n * bdi.blk_size))) {
+      last = last->next;
+      n += last->n;
+    }
+    next = last->next;
+
+    if (brp->write) {
+      result = blkWrite(bqp->bdp, brp->startblk, brp->buffer, n);
+    }
+    else {
+      result = blkRead(bqp->bdp, brp->startblk, brp->buffer, n);
+    }
+    bqp->position = brp->startblk + n;
+
+    complete_list(brp, next, result);
+    brp = next;
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a block requests queue.
+ * @details The queue is associated to the block device, the device
+ *          @p start_read and @p start_write methods post the requests
+ *          in the queue.
+ *
+ * @param[out] bqp      pointer to the @p blk_queue_t object
+ * @param[in] bdp       pointer to a @p BaseBlockDevice or derived class
+ *
+ * @init
+ */
+void blkqObjectInit(blk_queue_t *bqp, BaseBlockDevice *bdp) {
+
+  osalDbgCheck((bqp != NULL) && (bdp != NULL));
+
+  bqp->bdp      = bdp;
+  bqp->pending  = NULL;
+  bqp->deferred = NULL;
+  bqp->position = 0U;
+  bqp->stop     = false;
+  bqp->worker   = NULL;
+  bdp->queue    = bqp;
+}
+
+/**
+ * @brief   Posts a request in the queue associated to a device.
+ * @details This function can be used from a completion callback in order
+ *          to post a request again.
+ *
+ * @param[in] bdp       pointer to a @p BaseBlockDevice or derived class
+ * @param[in] brp       pointer to the request
+ * @param[in] write     @p true for a write request
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue or queue stopped.
+ *
+ * @iclass
+ */
+bool blkqStartRequestI(BaseBlockDevice *bdp, blk_request_t *brp,
+                       bool write) {
+  blk_queue_t *bqp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((bdp != NULL) && (brp != NULL) && (brp->n > 0U));
+
+  bqp = bdp->queue;
+  if ((bqp == NULL) || bqp->stop) {
+    return HAL_FAILED;
+  }
+  brp->write  = write;
+  brp->done   = false;
+  brp->result = HAL_FAILED;
+  (void) insert(bqp, brp);
+  osalThreadResumeI(&bqp->worker, MSG_OK);
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Posts a request in the queue associated to a device.
+ * @note    This function is meant to be used by the block devices
+ *          implementations of @p start_read and @p start_write.
+ *
+ * @param[in] bdp       pointer to a @p BaseBlockDevice or derived class
+ * @param[in] brp       pointer to the request
+ * @param[in] write     @p true for a write request
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue or queue stopped.
+ *
+ * @api
+ */
+bool blkqStartRequest(BaseBlockDevice *bdp, blk_request_t *brp,
+                      bool write) {
+  bool result;
+
+  osalSysLock();
+  result = blkqStartRequestI(bdp, brp, write);
+  osalOsRescheduleS();
+  osalSysUnlock();
+
+  return result;
+}
+
+/**
+ * @brief   Waits for a request completion.
+ *
+ * @param[in] brp       pointer to a posted request
+ *
+ * @return              The request result.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkqWaitRequest(blk_request_t *brp) {
+
+  osalDbgCheck(brp != NULL);
+
+  osalSysLock();
+  if (!brp->done) {
+    (void) osalThreadSuspendS(&brp->thread);
+  }
+  osalSysUnlock();
+
+  return brp->result;
+}
+
+/**
+ * @brief   Serves a requests queue.
+ * @details This function must be invoked by a dedicated thread, it
+ *          returns after @p blkqStop() has been called, the requests still
+ *          in the queue are completed with a failure result.
+ *
+ * @param[in] bqp       pointer to the @p blk_queue_t object
+ *
+ * @api
+ */
+void blkqServe(blk_queue_t *bqp) {
+
+  osalDbgCheck(bqp != NULL);
+
+  while (true) {
+    blk_request_t *list, *deferred;
+
+    osalSysLock();
+    while ((bqp->pending == NULL) && !bqp->stop) {
+      (void) osalThreadSuspendS(&bqp->worker);
+    }
+
+    if (bqp->stop) {
+      list = bqp->pending;
+      deferred = bqp->deferred;
+      bqp->pending = NULL;
+      bqp->deferred = NULL;
+      osalSysUnlock();
+
+      complete_list(list, NULL, HAL_FAILED);
+      complete_list(deferred, NULL, HAL_FAILED);
+      return;
+    }
+
+    /* Taking the whole pending list then moving the deferred requests
+       in the new pending list, the first conflicting request stops the
+       transfer.*/
+    list = bqp->pending;
+    deferred = bqp->deferred;
+    bqp->pending = NULL;
+    bqp->deferred = NULL;
+    while (deferred != NULL) {
+      blk_request_t *brp = deferred;
+
+      deferred = brp->next;
+      if (!insert(bqp, brp)) {
+        /* The request is now the only one in the deferred list, the
+           remaining ones follow it.*/
+        brp->next = deferred;
+        break;
+      }
+    }
+    osalSysUnlock();
+
+    serve_list(bqp, list);
+  }
+}
+
+/**
+ * @brief   Stops a requests queue.
+ * @details The serving thread completes the pending requests with a
+ *          failure result and returns from @p blkqServe(), new requests
+ *          are rejected.
+ *
+ * @param[in] bqp       pointer to the @p blk_queue_t object
+ *
+ * @api
+ */
+void blkqStop(blk_queue_t *bqp) {
+
+  osalDbgCheck(bqp != NULL);
+
+  osalSysLock();
+  bqp->stop = true;
+  osalThreadResumeS(&bqp->worker, MSG_RESET);
+  osalSysUnlock();
+}
+
+/** @} */
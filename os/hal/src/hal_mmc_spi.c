@@ -43,6 +43,9 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/* Forward declaration required by mmc_write().*/
+static void set_erase_count(MMCDriver *mmcp, uint32_t n);
+
 /* Forward declarations required by mmc_vmt.*/
 static bool mmc_read(void *instance, uint32_t startblk,
                        uint8_t *buffer, uint32_t n);
@@ -60,7 +63,9 @@ static const struct MMCDriverVMT mmc_vmt = {
   mmc_read,
   mmc_write,
   (bool (*)(void *))mmcSync,
-  (bool (*)(void *, BlockDeviceInfo *))mmcGetInfo
+  (bool (*)(void *, BlockDeviceInfo *))mmcGetInfo,
+  (bool (*)(void *, blk_request_t *))mmcStartRead,
+  (bool (*)(void *, blk_request_t *))mmcStartWrite
 };
 
 /**
@@ -91,6 +96,46 @@ static const uint8_t crc7_lookup_table[256] = {
   0x62, 0x6b, 0x70, 0x79
 };
 
+#if (MMC_USE_DATA_CRC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Lookup table for CRC-16 ( based on polynomial x^16 + x^12 + x^5 + 1).
+ */
+static const uint16_t crc16_lookup_table[256] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+  0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+  0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+  0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+  0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+  0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+  0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+  0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+  0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+  0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+  0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+  0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+  0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+  0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+  0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+  0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+  0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+  0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+  0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+  0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+  0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+  0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
+};
+#endif
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -119,6 +164,11 @@ static bool mmc_read(void *instance, uint32_t startblk,
 static bool mmc_write(void *instance, uint32_t startblk,
                  const uint8_t *buffer, uint32_t n) {
 
+  /* Multiple blocks are pre-erased, it speeds up the write operation.*/
+  if (n > 1U) {
+    set_erase_count((MMCDriver *)instance, n);
+  }
+
   if (mmcStartSequentialWrite((MMCDriver *)instance, startblk)) {
     return HAL_FAILED;
   }
@@ -154,8 +204,31 @@ static uint8_t crc7(uint8_t crc, const uint8_t *buffer, size_t len) {
   return crc;
 }
 
+#if (MMC_USE_DATA_CRC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief Calculate the MMC standard CRC-16 based on a lookup table.
+ *
+ * @param[in] crc       start value for CRC
+ * @param[in] buffer    pointer to data buffer
+ * @param[in] len       length of data
+ * @return              Calculated CRC
+ */
+static uint16_t crc16(uint16_t crc, const uint8_t *buffer, size_t len) {
+
+  while (len > 0U) {
+    crc = (uint16_t)(crc << 8U) ^
+          crc16_lookup_table[(uint8_t)(crc >> 8U) ^ *buffer++];
+    len--;
+  }
+  return crc;
+}
+#endif
+
 /**
  * @brief   Waits an idle condition.
+ * @details The card keeps its output low while busy, once released the
+ *          line stays high so checking the last byte of each poll is
+ *          enough.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
  *
@@ -163,18 +236,18 @@ static uint8_t crc7(uint8_t crc, const uint8_t *buffer, size_t len) {
  */
 static void wait(MMCDriver *mmcp) {
   int i;
-  uint8_t buf[4];
+  uint8_t buf[MMC_POLL_SIZE];
 
   for (i = 0; i < 16; i++) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFFU) {
+    spiReceive(mmcp->config->spip, MMC_POLL_SIZE, buf);
+    if (buf[MMC_POLL_SIZE - 1] == 0xFFU) {
       return;
     }
   }
   /* Looks like it is a long wait.*/
   while (true) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFFU) {
+    spiReceive(mmcp->config->spip, MMC_POLL_SIZE, buf);
+    if (buf[MMC_POLL_SIZE - 1] == 0xFFU) {
       break;
     }
 #if MMC_NICE_WAITING == TRUE
@@ -232,6 +305,27 @@ static uint8_t recvr1(MMCDriver *mmcp) {
   return 0xFFU;
 }
 
+/**
+ * @brief   Terminates a multiple blocks read.
+ * @details Sends the @p STOP_TRANSMISSION command then waits for the card
+ *          to leave the busy state.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @notapi
+ */
+static void stop_read(MMCDriver *mmcp) {
+  static const uint8_t stopcmd[] = {
+    (uint8_t)(0x40U | MMCSD_CMD_STOP_TRANSMISSION), 0, 0, 0, 0, 0x61, 0xFF
+  };
+
+  spiSend(mmcp->config->spip, sizeof(stopcmd), stopcmd);
+/*  result = recvr1(mmcp) != 0x00U;*/
+  /* Note, ignored r1 response, it can be not zero, unknown issue.*/
+  (void) recvr1(mmcp);
+  wait(mmcp);
+}
+
 /**
  * @brief   Receives a three byte response.
  *
@@ -352,22 +446,35 @@ static bool read_CxD(MMCDriver *mmcp, uint8_t cmd, uint32_t cxd[4]) {
  * @notapi
  */
 static void sync(MMCDriver *mmcp) {
-  uint8_t buf[1];
 
   spiSelect(mmcp->config->spip);
-  while (true) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFFU) {
-      break;
-    }
-#if MMC_NICE_WAITING == TRUE
-    /* Trying to be nice with the other threads.*/
-    osalThreadSleepMilliseconds(1);
-#endif
-  }
+  wait(mmcp);
   spiUnselect(mmcp->config->spip);
 }
 
+/**
+ * @brief   Sets the number of blocks to be pre-erased by the next write.
+ * @details Only SD cards accept ACMD23, on other cards the @p APP_CMD
+ *          command fails and the hint is skipped. Errors are not fatal
+ *          because the write operation is performed anyway.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] n         number of blocks
+ *
+ * @notapi
+ */
+static void set_erase_count(MMCDriver *mmcp, uint32_t n) {
+
+  if (mmcp->state != BLK_READY) {
+    return;
+  }
+
+  spiStart(mmcp->config->spip, mmcp->config->hscfg);
+  if (send_command_R1(mmcp, MMCSD_CMD_APP_CMD, 0) == 0x00U) {
+    (void) send_command_R1(mmcp, MMCSD_CMD_SET_WR_BLK_ERASE_COUNT, n);
+  }
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -396,6 +503,7 @@ void mmcObjectInit(MMCDriver *mmcp) {
   mmcp->state = BLK_STOP;
   mmcp->config = NULL;
   mmcp->block_addresses = false;
+  mmcp->queue = NULL;
 }
 
 /**
@@ -537,6 +645,13 @@ bool mmcConnect(MMCDriver *mmcp) {
     goto failed;
   }
 
+#if MMC_USE_DATA_CRC == TRUE
+  /* Enabling the CRC checks on the card side.*/
+  if (send_command_R1(mmcp, MMCSD_CMD_CRC_ON_OFF, 1) != 0x00U) {
+    goto failed;
+  }
+#endif
+
   /* Determine capacity.*/
   if (read_CxD(mmcp, MMCSD_CMD_SEND_CSD, mmcp->csd)) {
     goto failed;
@@ -650,6 +765,8 @@ bool mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
  */
 bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
   unsigned i;
+  size_t n;
+  uint8_t buf[MMC_POLL_SIZE], crc[2];
 
   osalDbgCheck((mmcp != NULL) && (buffer != NULL));
 
@@ -657,16 +774,38 @@ bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
     return HAL_FAILED;
   }
 
-  for (i = 0; i < MMC_WAIT_DATA; i++) {
-    spiReceive(mmcp->config->spip, 1, buffer);
-    if (buffer[0] == 0xFEU) {
-      spiReceive(mmcp->config->spip, MMCSD_BLOCK_SIZE, buffer);
-      /* CRC ignored. */
-      spiIgnore(mmcp->config->spip, 2);
+  for (i = 0U; i < MMC_WAIT_DATA; i += (unsigned)MMC_POLL_SIZE) {
+    spiReceive(mmcp->config->spip, MMC_POLL_SIZE, buf);
+
+    /* Searching for the data token.*/
+    n = 0U;
+    while ((n < (size_t)MMC_POLL_SIZE) && (buf[n] == 0xFFU)) {
+      n++;
+    }
+    if (n < (size_t)MMC_POLL_SIZE) {
+      if (buf[n] != 0xFEU) {
+        /* Data error token.*/
+        break;
+      }
+
+      /* The bytes received after the token are the start of the block,
+         the remaining part is received in a single exchange.*/
+      n = (size_t)MMC_POLL_SIZE - n - 1U;
+      memcpy(buffer, &buf[(size_t)MMC_POLL_SIZE - n], n);
+      spiReceive(mmcp->config->spip, MMCSD_BLOCK_SIZE - n, buffer + n);
+      spiReceive(mmcp->config->spip, 2, crc);
+#if MMC_USE_DATA_CRC == TRUE
+      if (crc16(0U, buffer, MMCSD_BLOCK_SIZE) !=
+          (((uint16_t)crc[0] << 8U) | (uint16_t)crc[1])) {
+        break;
+      }
+#endif
       return HAL_SUCCESS;
     }
   }
-  /* Timeout.*/
+  /* Timeout or error, the card is still sending blocks and must be stopped
+     before it can accept another command.*/
+  stop_read(mmcp);
   spiUnselect(mmcp->config->spip);
   spiStop(mmcp->config->spip);
   mmcp->state = BLK_READY;
@@ -685,9 +824,6 @@ bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
  * @api
  */
 bool mmcStopSequentialRead(MMCDriver *mmcp) {
-  static const uint8_t stopcmd[] = {
-    (uint8_t)(0x40U | MMCSD_CMD_STOP_TRANSMISSION), 0, 0, 0, 0, 1, 0xFF
-  };
 
   osalDbgCheck(mmcp != NULL);
 
@@ -695,10 +831,7 @@ bool mmcStopSequentialRead(MMCDriver *mmcp) {
     return HAL_FAILED;
   }
 
-  spiSend(mmcp->config->spip, sizeof(stopcmd), stopcmd);
-/*  result = recvr1(mmcp) != 0x00U;*/
-  /* Note, ignored r1 response, it can be not zero, unknown issue.*/
-  (void) recvr1(mmcp);
+  stop_read(mmcp);
 
   /* Read operation finished.*/
   spiUnselect(mmcp->config->spip);
@@ -758,7 +891,10 @@ bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
  */
 bool mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
   static const uint8_t start[] = {0xFF, 0xFC};
-  uint8_t b[1];
+  uint8_t tail[3], b[3];
+#if MMC_USE_DATA_CRC == TRUE
+  uint16_t crc;
+#endif
 
   osalDbgCheck((mmcp != NULL) && (buffer != NULL));
 
@@ -766,12 +902,25 @@ bool mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
     return HAL_FAILED;
   }
 
+#if MMC_USE_DATA_CRC == TRUE
+  crc = crc16(0U, buffer, MMCSD_BLOCK_SIZE);
+  tail[0] = (uint8_t)(crc >> 8U);
+  tail[1] = (uint8_t)crc;
+#else
+  tail[0] = 0xFFU;
+  tail[1] = 0xFFU;
+#endif
+  tail[2] = 0xFFU;
+
+  /* The card could still be programming the previous block, the busy
+     condition is checked here rather than after each block so that the
+     caller can prepare the next block while the card is busy.*/
+  wait(mmcp);
+
   spiSend(mmcp->config->spip, sizeof(start), start);    /* Data prologue.   */
   spiSend(mmcp->config->spip, MMCSD_BLOCK_SIZE, buffer);/* Data.            */
-  spiIgnore(mmcp->config->spip, 2);                     /* CRC ignored.     */
-  spiReceive(mmcp->config->spip, 1, b);
-  if ((b[0] & 0x1FU) == 0x05U) {
-    wait(mmcp);
+  spiExchange(mmcp->config->spip, 3, tail, b);          /* CRC and response.*/
+  if ((b[2] & 0x1FU) == 0x05U) {
     return HAL_SUCCESS;
   }
 
@@ -802,6 +951,8 @@ bool mmcStopSequentialWrite(MMCDriver *mmcp) {
     return HAL_FAILED;
   }
 
+  /* Waiting for the last block to be programmed.*/
+  wait(mmcp);
   spiSend(mmcp->config->spip, sizeof(stop), stop);
   spiUnselect(mmcp->config->spip);
 
@@ -914,6 +1065,48 @@ failed:
   return HAL_FAILED;
 }
 
+/**
+ * @brief   Starts an asynchronous read operation.
+ * @details The request is posted in the requests queue associated to the
+ *          driver, see @p blkqObjectInit().
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] brp       pointer to the @p blk_request_t object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue associated to the driver or queue stopped.
+ *
+ * @api
+ */
+bool mmcStartRead(MMCDriver *mmcp, blk_request_t *brp) {
+
+  osalDbgCheck((mmcp != NULL) && (brp != NULL));
+
+  return blkqStartRequest((BaseBlockDevice *)mmcp, brp, false);
+}
+
+/**
+ * @brief   Starts an asynchronous write operation.
+ * @details The request is posted in the requests queue associated to the
+ *          driver, see @p blkqObjectInit().
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] brp       pointer to the @p blk_request_t object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue associated to the driver or queue stopped.
+ *
+ * @api
+ */
+bool mmcStartWrite(MMCDriver *mmcp, blk_request_t *brp) {
+
+  osalDbgCheck((mmcp != NULL) && (brp != NULL));
+
+  return blkqStartRequest((BaseBlockDevice *)mmcp, brp, true);
+}
+
 #endif /* HAL_USE_MMC_SPI == TRUE */
 
 /** @} */
@@ -79,7 +79,9 @@ static const struct SDCDriverVMT sdc_vmt = {
   (bool (*)(void *, uint32_t, uint8_t *, uint32_t))sdcRead,
   (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))sdcWrite,
   (bool (*)(void *))sdcSync,
-  (bool (*)(void *, BlockDeviceInfo *))sdcGetInfo
+  (bool (*)(void *, BlockDeviceInfo *))sdcGetInfo,
+  (bool (*)(void *, blk_request_t *))sdcStartRead,
+  (bool (*)(void *, blk_request_t *))sdcStartWrite
 };
 
 /*===========================================================================*/
@@ -557,6 +559,7 @@ void sdcObjectInit(SDCDriver *sdcp) {
   sdcp->errors   = SDC_NO_ERROR;
   sdcp->config   = NULL;
   sdcp->capacity = 0;
+  sdcp->queue    = NULL;
 }
 
 /**
@@ -1003,6 +1006,48 @@ failed:
   return HAL_FAILED;
 }
 
+/**
+ * @brief   Starts an asynchronous read operation.
+ * @details The request is posted in the requests queue associated to the
+ *          driver, see @p blkqObjectInit().
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] brp       pointer to the @p blk_request_t object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue associated to the driver or queue stopped.
+ *
+ * @api
+ */
+bool sdcStartRead(SDCDriver *sdcp, blk_request_t *brp) {
+
+  osalDbgCheck((sdcp != NULL) && (brp != NULL));
+
+  return blkqStartRequest((BaseBlockDevice *)sdcp, brp, false);
+}
+
+/**
+ * @brief   Starts an asynchronous write operation.
+ * @details The request is posted in the requests queue associated to the
+ *          driver, see @p blkqObjectInit().
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] brp       pointer to the @p blk_request_t object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  request queued.
+ * @retval HAL_FAILED   no queue associated to the driver or queue stopped.
+ *
+ * @api
+ */
+bool sdcStartWrite(SDCDriver *sdcp, blk_request_t *brp) {
+
+  osalDbgCheck((sdcp != NULL) && (brp != NULL));
+
+  return blkqStartRequest((BaseBlockDevice *)sdcp, brp, true);
+}
+
 #endif /* HAL_USE_SDC == TRUE */
 
 /** @} */
@@ -275,6 +275,22 @@
 #if !defined(MMC_NICE_WAITING) || defined(__DOXYGEN__)
 #define MMC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Number of bytes exchanged on each card poll.
+ */
+#if !defined(MMC_POLL_SIZE) || defined(__DOXYGEN__)
+#define MMC_POLL_SIZE               16
+#endif
+
+/**
+ * @brief   Data blocks CRC check.
+ * @details If enabled the CRC16 of the transferred data blocks is computed
+ *          and verified.
+ */
+#if !defined(MMC_USE_DATA_CRC) || defined(__DOXYGEN__)
+#define MMC_USE_DATA_CRC            FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -178,6 +178,22 @@
 #define CH_CFG_ST_TIMEDELTA                 0
 #endif
 
+/**
+ * @brief   Ordered timeouts list.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a list ordered by deadline, the time handler only processes
+ *          the threads whose timeout expired instead of scanning the
+ *          whole threads table.
+ * @note    This option adds a pointer to each thread structure, enable it
+ *          when @p CH_CFG_NUM_THREADS is large or the tick frequency is
+ *          high.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_TIMEOUT_LIST) || defined(__DOXYGEN__)
+#define CH_CFG_USE_TIMEOUT_LIST             FALSE
+#endif
+
 /**
  * @brief   Semaphores APIs.
  * @details If enabled then the Semaphores APIs are included in the kernel.
@@ -535,6 +551,14 @@ struct nil_thread {
   } u1;
   volatile systime_t    timeout;    /**< @brief Timeout counter, zero
                                             if disabled.                    */
+#if (CH_CFG_USE_TIMEOUT_LIST == TRUE) || defined(__DOXYGEN__)
+  thread_t              *tnext;     /**< @brief Next thread in the timeouts
+                                            list or @p NULL.
+                                            @note When this field is used
+                                            then @p timeout is relative
+                                            to the previous thread in the
+                                            list.                           */
+#endif
 #if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
   eventmask_t           epmask;     /**< @brief Pending events mask.        */
 #endif
@@ -582,6 +606,13 @@ struct nil_system {
    */
   systime_t             nexttime;
 #endif
+#if (CH_CFG_USE_TIMEOUT_LIST == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Threads waiting with a timeout ordered by deadline.
+   * @note    The list is terminated by the idle thread.
+   */
+  thread_t              *timeouts;
+#endif
 #if (CH_DBG_SYSTEM_STATE_CHECK == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief   ISR nesting level.
@@ -1376,6 +1407,7 @@ extern "C" {
 #include "chmemcore.h"
 #include "chmempools.h"
 #include "chheap.h"
+#include "chobjfifos.h"
 
 #endif /* CH_H */
 
@@ -15,12 +15,16 @@ endif
 ifneq ($(findstring CH_CFG_USE_MEMPOOLS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmempools.c
 endif
+ifneq ($(findstring CH_CFG_USE_OBJ_FIFOS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/chobjfifos.c
+endif
 else
 KERNSRC := ${CHIBIOS}/os/nil/src/ch.c \
            ${CHIBIOS}/os/common/oslib/src/chmboxes.c \
            ${CHIBIOS}/os/common/oslib/src/chmemcore.c \
            ${CHIBIOS}/os/common/oslib/src/chmempools.c \
-           ${CHIBIOS}/os/common/oslib/src/chheap.c
+           ${CHIBIOS}/os/common/oslib/src/chheap.c \
+           ${CHIBIOS}/os/common/oslib/src/chobjfifos.c
 endif
 
 # Required include directories
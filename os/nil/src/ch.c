@@ -48,6 +48,92 @@ nil_system_t nil;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_TIMEOUT_LIST == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Inserts a thread in the timeouts list.
+ * @details The list is delta-ordered, the @p timeout field of each thread
+ *          is relative to the deadline of the previous thread, threads
+ *          with the same deadline are kept in FIFO order.
+ *
+ * @param[in] tp        thread to be inserted, the @p timeout field must
+ *                      contain the delay relative to the list base time
+ *
+ * @notapi
+ */
+static void timeout_insert(thread_t *tp) {
+  thread_t **pp = &nil.timeouts;
+  thread_t *p = nil.timeouts;
+  systime_t delta = tp->timeout;
+
+  while ((p != &nil.threads[CH_CFG_NUM_THREADS]) && (p->timeout <= delta)) {
+    delta -= p->timeout;
+    pp = &p->tnext;
+    p = p->tnext;
+  }
+  if (p != &nil.threads[CH_CFG_NUM_THREADS]) {
+    p->timeout -= delta;
+  }
+  tp->timeout = delta;
+  tp->tnext = p;
+  *pp = tp;
+}
+
+/**
+ * @brief   Removes a thread from the timeouts list.
+ *
+ * @param[in] tp        thread to be removed
+ *
+ * @notapi
+ */
+static void timeout_remove(thread_t *tp) {
+  thread_t **pp = &nil.timeouts;
+
+  while (*pp != tp) {
+    pp = &(*pp)->tnext;
+  }
+  *pp = tp->tnext;
+  if (tp->tnext != &nil.threads[CH_CFG_NUM_THREADS]) {
+    tp->tnext->timeout += tp->timeout;
+  }
+  tp->tnext = NULL;
+}
+
+/**
+ * @brief   Wakes up the threads at the head of the list with expired
+ *          timeout.
+ *
+ * @notapi
+ */
+static void timeout_expire(void) {
+  thread_t *tp = nil.timeouts;
+
+  while ((tp != &nil.threads[CH_CFG_NUM_THREADS]) &&
+         (tp->timeout == (systime_t)0)) {
+
+    chDbgAssert(!NIL_THD_IS_READY(tp), "is ready");
+
+    nil.timeouts = tp->tnext;
+    tp->tnext = NULL;
+#if CH_CFG_USE_SEMAPHORES == TRUE
+    /* Timeout on semaphores requires a special handling because the
+       semaphore counter must be incremented.*/
+    if (NIL_THD_IS_WTSEM(tp)) {
+      tp->u1.semp->cnt++;
+    }
+    else {
+#endif
+      if (NIL_THD_IS_SUSP(tp)) {
+        *tp->u1.trp = NULL;
+      }
+#if CH_CFG_USE_SEMAPHORES == TRUE
+    }
+#endif
+    (void) chSchReadyI(tp, MSG_TIMEOUT);
+    tp = nil.timeouts;
+  }
+}
+#endif /* CH_CFG_USE_TIMEOUT_LIST == TRUE */
+
 /*===========================================================================*/
 /* Module interrupt handlers.                                                */
 /*===========================================================================*/
@@ -247,6 +333,11 @@ void chSysInit(void) {
     tcp++;
   }
 
+#if CH_CFG_USE_TIMEOUT_LIST == TRUE
+  /* The idle thread terminates the timeouts list.*/
+  nil.timeouts = tp;
+#endif
+
 #if CH_DBG_ENABLE_STACK_CHECK
   /* The idle thread is a special case because its stack is set up by the
      runtime environment.*/
@@ -309,6 +400,9 @@ void chSysHalt(const char *reason) {
  * @brief   Time management handler.
  * @note    This handler has to be invoked by a periodic ISR in order to
  *          reschedule the waiting threads.
+ * @note    If @p CH_CFG_USE_TIMEOUT_LIST is enabled then only the threads
+ *          whose timeout expired are processed, else the whole threads
+ *          table is scanned.
  *
  * @iclass
  */
@@ -316,7 +410,35 @@ void chSysTimerHandlerI(void) {
 
   chDbgCheckClassI();
 
+#if CH_CFG_USE_TIMEOUT_LIST == TRUE
 #if CH_CFG_ST_TIMEDELTA == 0
+  nil.systime++;
+  if (nil.timeouts != &nil.threads[CH_CFG_NUM_THREADS]) {
+    nil.timeouts->timeout--;
+    timeout_expire();
+  }
+#else
+  chDbgAssert(nil.nexttime == port_timer_get_alarm(), "time mismatch");
+
+  /* The head delta is relative to the previous tick event.*/
+  if (nil.timeouts != &nil.threads[CH_CFG_NUM_THREADS]) {
+    chDbgAssert(nil.timeouts->timeout >= (nil.nexttime - nil.lasttime),
+                "skipped one");
+
+    nil.timeouts->timeout -= nil.nexttime - nil.lasttime;
+    timeout_expire();
+  }
+  nil.lasttime = nil.nexttime;
+  if (nil.timeouts != &nil.threads[CH_CFG_NUM_THREADS]) {
+    nil.nexttime += nil.timeouts->timeout;
+    port_timer_set_alarm(nil.nexttime);
+  }
+  else {
+    /* No tick event needed.*/
+    port_timer_stop_alarm();
+  }
+#endif
+#elif CH_CFG_ST_TIMEDELTA == 0
   thread_t *tp = &nil.threads[0];
   nil.systime++;
   do {
@@ -537,6 +659,11 @@ thread_t *chSchReadyI(thread_t *tp, msg_t msg) {
   chDbgAssert(!NIL_THD_IS_READY(tp), "already ready");
   chDbgAssert(nil.next <= nil.current, "priority ordering");
 
+#if CH_CFG_USE_TIMEOUT_LIST == TRUE
+  if (tp->tnext != NULL) {
+    timeout_remove(tp);
+  }
+#endif
   tp->u1.msg = msg;
   tp->state = NIL_STATE_READY;
   tp->timeout = (systime_t)0;
@@ -652,11 +779,19 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, systime_t timeout) {
 
     /* Timeout settings.*/
     otp->timeout = abstime - nil.lasttime;
+#if CH_CFG_USE_TIMEOUT_LIST == TRUE
+    timeout_insert(otp);
+#endif
   }
 #else
 
   /* Timeout settings.*/
   otp->timeout = timeout;
+#if CH_CFG_USE_TIMEOUT_LIST == TRUE
+  if (timeout != TIME_INFINITE) {
+    timeout_insert(otp);
+  }
+#endif
 #endif
 
   /* Scanning the whole threads array.*/
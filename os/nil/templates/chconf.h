@@ -77,6 +77,16 @@
  */
 #define CH_CFG_ST_TIMEDELTA                 0
 
+/**
+ * @brief   Ordered timeouts list.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a list ordered by deadline, the time handler only processes
+ *          the threads whose timeout expired.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_TIMEOUT_LIST             FALSE
+
 /** @} */
 
 /*===========================================================================*/
@@ -148,6 +158,16 @@
  */
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 
+/**
+ * @brief   Objects FIFOs APIs.
+ * @details If enabled then the objects FIFOs APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_SEMAPHORES.
+ */
+#define CH_CFG_USE_OBJ_FIFOS                FALSE
+
 /**
  * @brief   Managed RAM size.
  * @details Size of the RAM area to be managed by the OS. If set to zero
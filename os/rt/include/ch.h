@@ -90,17 +90,21 @@
 
 /* Optional subsystems headers.*/
 #include "chregistry.h"
+#include "chbudget.h"
 #include "chsem.h"
 #include "chbsem.h"
 #include "chmtx.h"
 #include "chcond.h"
+#include "chrwlock.h"
 #include "chevents.h"
 #include "chmsg.h"
 #include "chmboxes.h"
 #include "chmemcore.h"
 #include "chheap.h"
 #include "chmempools.h"
+#include "chobjfifos.h"
 #include "chdynamic.h"
+#include "chworkq.h"
 
 #if !defined(_CHIBIOS_RT_CONF_)
 #error "missing or wrong configuration file"
@@ -0,0 +1,152 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chbudget.h
+ * @brief   CPU budget reservations macros and structures.
+ *
+ * @addtogroup budgets
+ * @{
+ */
+
+#ifndef CHBUDGET_H
+#define CHBUDGET_H
+
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_ST_TIMEDELTA > 0
+#error "CH_CFG_USE_BUDGETS is not supported in tick-less mode"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _budget_tick(void);
+  void chBudgetSetI(thread_t *tp, systime_t budget,
+                    systime_t period, tprio_t lowprio);
+  void chBudgetSet(thread_t *tp, systime_t budget,
+                   systime_t period, tprio_t lowprio);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the ticks consumed by a thread under reservation.
+ * @note    Ticks consumed while throttled are included.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of ticks consumed since the reservation
+ *                      has been set.
+ *
+ * @xclass
+ */
+static inline systime_t chBudgetGetConsumedX(thread_t *tp) {
+
+  return tp->budget.consumed;
+}
+
+/**
+ * @brief   Returns the ticks used by a thread in the current period.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of ticks used in the current period.
+ *
+ * @xclass
+ */
+static inline systime_t chBudgetGetUsedX(thread_t *tp) {
+
+  return tp->budget.used;
+}
+
+/**
+ * @brief   Returns the number of periods in which a thread exhausted its
+ *          budget.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The overruns counter.
+ *
+ * @xclass
+ */
+static inline ucnt_t chBudgetGetOverrunsX(thread_t *tp) {
+
+  return tp->budget.overruns;
+}
+
+/**
+ * @brief   Returns the throttling state of a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The throttling state.
+ * @retval false        if the thread is running at its own priority.
+ * @retval true         if the thread exhausted its budget and has been
+ *                      demoted until the next replenishment.
+ *
+ * @xclass
+ */
+static inline bool chBudgetIsThrottledX(thread_t *tp) {
+
+  return tp->budget.throttled;
+}
+
+/**
+ * @brief   Removes the budget reservation of a thread.
+ * @details If the thread is throttled then its priority is restored.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @api
+ */
+static inline void chBudgetReset(thread_t *tp) {
+
+  chBudgetSet(tp, (systime_t)0, (systime_t)0, (tprio_t)0);
+}
+
+#endif /* CH_CFG_USE_BUDGETS == TRUE */
+
+#endif /* CHBUDGET_H */
+
+/** @} */
@@ -46,12 +46,51 @@
 #if !defined(CH_DBG_STACK_FILL_VALUE) || defined(__DOXYGEN__)
 #define CH_DBG_STACK_FILL_VALUE             0x55
 #endif
+
+/**
+ * @brief   Stack sentinel thread.
+ * @details If enabled then a thread at @p LOWPRIO periodically scans the
+ *          stacks of all the registered threads and records their minimum
+ *          headroom.
+ * @note    Requires @p CH_DBG_FILL_THREADS and @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_DBG_STACK_SENTINEL) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_SENTINEL               FALSE
+#endif
+
+/**
+ * @brief   Stack sentinel scan period in milliseconds.
+ */
+#if !defined(CH_DBG_STACK_SENTINEL_PERIOD) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_SENTINEL_PERIOD        1000
+#endif
+
+/**
+ * @brief   Stack sentinel thread stack size.
+ */
+#if !defined(CH_DBG_STACK_SENTINEL_STACK_SIZE) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_SENTINEL_STACK_SIZE    128
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_DBG_STACK_SENTINEL == TRUE
+#if CH_DBG_FILL_THREADS == FALSE
+#error "CH_DBG_STACK_SENTINEL requires CH_DBG_FILL_THREADS"
+#endif
+
+#if CH_CFG_USE_REGISTRY == FALSE
+#error "CH_DBG_STACK_SENTINEL requires CH_CFG_USE_REGISTRY"
+#endif
+
+#if (CH_DBG_ENABLE_STACK_CHECK == FALSE) && (CH_CFG_USE_DYNAMIC == FALSE)
+#error "CH_DBG_STACK_SENTINEL requires CH_DBG_ENABLE_STACK_CHECK or CH_CFG_USE_DYNAMIC"
+#endif
+#endif /* CH_DBG_STACK_SENTINEL == TRUE */
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
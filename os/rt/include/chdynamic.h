@@ -38,6 +38,35 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Working areas cache.
+ * @details If enabled then the working areas of the threads created from
+ *          the default heap are kept in a cache on release and reused by
+ *          the next threads requiring the same working area size.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#if !defined(CH_CFG_USE_WA_CACHE) || defined(__DOXYGEN__)
+#define CH_CFG_USE_WA_CACHE                 FALSE
+#endif
+
+/**
+ * @brief   Number of size classes in the working areas cache.
+ * @details Each class caches working areas of a single size, classes are
+ *          assigned to sizes on first use.
+ */
+#if !defined(CH_CFG_WA_CACHE_CLASSES) || defined(__DOXYGEN__)
+#define CH_CFG_WA_CACHE_CLASSES             4
+#endif
+
+/**
+ * @brief   Maximum number of free working areas cached in each class.
+ * @details Released working areas exceeding this limit are returned to
+ *          the heap.
+ */
+#if !defined(CH_CFG_WA_CACHE_DEPTH) || defined(__DOXYGEN__)
+#define CH_CFG_WA_CACHE_DEPTH               4
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -57,10 +86,38 @@
 #error "CH_CFG_USE_DYNAMIC requires CH_CFG_USE_HEAP and/or CH_CFG_USE_MEMPOOLS"
 #endif
 
+#if (CH_CFG_USE_WA_CACHE == TRUE) && (CH_CFG_USE_HEAP == FALSE)
+#error "CH_CFG_USE_WA_CACHE requires CH_CFG_USE_HEAP"
+#endif
+
+#if (CH_CFG_USE_WA_CACHE == TRUE) &&                                       \
+    ((CH_CFG_WA_CACHE_CLASSES < 1) || (CH_CFG_WA_CACHE_DEPTH < 1))
+#error "invalid working areas cache settings"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_WA_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a working areas cache class statistics structure.
+ */
+typedef struct {
+  size_t                size;       /**< @brief Working areas size or zero
+                                                if the class is unused.     */
+  ucnt_t                n_cached;   /**< @brief Working areas currently in
+                                                the cache.                  */
+  ucnt_t                n_reused;   /**< @brief Allocations served by the
+                                                cache.                      */
+  ucnt_t                n_allocated;/**< @brief Allocations served by the
+                                                heap.                       */
+  ucnt_t                n_dropped;  /**< @brief Releases returned to the
+                                                heap because the class was
+                                                full.                       */
+} wa_cache_stats_t;
+#endif
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -84,6 +141,11 @@ extern "C" {
   thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
                                       tprio_t prio, tfunc_t pf, void *arg);
 #endif
+#if CH_CFG_USE_WA_CACHE == TRUE
+  void _thread_cache_free(void *wsp);
+  void chThdCacheFlush(void);
+  bool chThdCacheGetStats(unsigned n, wa_cache_stats_t *wcsp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,20 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Broadcast modes
+ * @{
+ */
+#define EVT_BCAST_ALL       (evtbmode_t)0   /**< @brief All the listeners are
+                                                 signaled.                  */
+#define EVT_BCAST_HIGHEST   (evtbmode_t)1   /**< @brief Only the listener
+                                                 with the highest priority
+                                                 thread is signaled.        */
+#define EVT_BCAST_COALESCE  (evtbmode_t)2   /**< @brief Listeners with the
+                                                 events already pending only
+                                                 accumulate flags.          */
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -49,6 +63,11 @@
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type of a broadcast mode mask.
+ */
+typedef uint8_t evtbmode_t;
+
 typedef struct event_listener event_listener_t;
 
 /**
@@ -133,6 +152,12 @@ extern "C" {
   void chEvtSignalI(thread_t *tp, eventmask_t events);
   void chEvtBroadcastFlags(event_source_t *esp, eventflags_t flags);
   void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags);
+  cnt_t chEvtBroadcastFlagsMode(event_source_t *esp,
+                                eventflags_t flags,
+                                evtbmode_t mode);
+  cnt_t chEvtBroadcastFlagsModeI(event_source_t *esp,
+                                 eventflags_t flags,
+                                 evtbmode_t mode);
   void chEvtDispatch(const evhandler_t *handlers, eventmask_t events);
 #if (CH_CFG_OPTIMIZE_SPEED == TRUE) || (CH_CFG_USE_EVENTS_TIMEOUT == FALSE)
   eventmask_t chEvtWaitOne(eventmask_t events);
@@ -38,6 +38,15 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Priority ceiling mutexes.
+ * @details If enabled then mutexes can be given a ceiling priority, the
+ *          owner is raised to the ceiling on lock.
+ */
+#if !defined(CH_CFG_USE_MUTEXES_CEILING) || defined(__DOXYGEN__)
+#define CH_CFG_USE_MUTEXES_CEILING          FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -51,6 +60,23 @@
  */
 typedef struct ch_mutex mutex_t;
 
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a mutex contention statistics structure.
+ */
+typedef struct {
+  ucnt_t                n_lock;     /**< @brief Number of acquisitions.     */
+  ucnt_t                n_contended;/**< @brief Number of acquisitions that
+                                                required waiting.           */
+  rttime_t              wait;       /**< @brief Cumulative waiting time in
+                                                realtime counter cycles.    */
+  const char            *name;      /**< @brief Name of a registered mutex
+                                                or @p NULL.                 */
+  mutex_t               *next;      /**< @brief Next registered mutex or
+                                                @p NULL.                    */
+} mutex_stats_t;
+#endif
+
 /**
  * @brief   Mutex structure.
  */
@@ -64,6 +90,13 @@ struct ch_mutex {
 #if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
   cnt_t                 cnt;        /**< @brief Mutex recursion counter.    */
 #endif
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+  tprio_t               ceiling;    /**< @brief Ceiling priority or
+                                                @p NOPRIO.                  */
+#endif
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  mutex_stats_t         stats;      /**< @brief Contention statistics.      */
+#endif
 };
 
 /*===========================================================================*/
@@ -77,10 +110,49 @@ struct ch_mutex {
  *
  * @param[in] name      the name of the mutex variable
  */
+#define _MUTEX_DATA(name) _CEILING_MUTEX_DATA(name, NOPRIO)
+
+/**
+ * @brief   Data part of a static priority ceiling mutex initializer.
+ * @details This macro should be used when statically initializing a mutex
+ *          that is part of a bigger structure.
+ * @note    The ceiling is ignored if @p CH_CFG_USE_MUTEXES_CEILING is
+ *          disabled.
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the ceiling priority
+ */
 #if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
-#define _MUTEX_DATA(name) {_THREADS_QUEUE_DATA(name.queue), NULL, NULL, 0}
+#define _CEILING_MUTEX_DATA(name, ceiling)                                  \
+  {_THREADS_QUEUE_DATA(name.queue), NULL, NULL, 0                           \
+   _MUTEX_CEILING_DATA(ceiling) _MUTEX_STATS_DATA}
+#else
+#define _CEILING_MUTEX_DATA(name, ceiling)                                  \
+  {_THREADS_QUEUE_DATA(name.queue), NULL, NULL                              \
+   _MUTEX_CEILING_DATA(ceiling) _MUTEX_STATS_DATA}
+#endif
+
+/**
+ * @brief   Ceiling part of a static mutex initializer.
+ *
+ * @notapi
+ */
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+#define _MUTEX_CEILING_DATA(ceiling) , (tprio_t)(ceiling)
+#else
+#define _MUTEX_CEILING_DATA(ceiling)
+#endif
+
+/**
+ * @brief   Statistics part of a static mutex initializer.
+ *
+ * @notapi
+ */
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+#define _MUTEX_STATS_DATA                                                   \
+  , {(ucnt_t)0, (ucnt_t)0, (rttime_t)0, NULL, NULL}
 #else
-#define _MUTEX_DATA(name) {_THREADS_QUEUE_DATA(name.queue), NULL, NULL}
+#define _MUTEX_STATS_DATA
 #endif
 
 /**
@@ -92,6 +164,17 @@ struct ch_mutex {
  */
 #define MUTEX_DECL(name) mutex_t name = _MUTEX_DATA(name)
 
+/**
+ * @brief   Static priority ceiling mutex initializer.
+ * @details Statically initialized mutexes require no explicit initialization
+ *          using @p chMtxObjectInitCeiling().
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the ceiling priority
+ */
+#define CEILING_MUTEX_DECL(name, ceiling)                                   \
+  mutex_t name = _CEILING_MUTEX_DATA(name, ceiling)
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -101,6 +184,9 @@ struct ch_mutex {
 extern "C" {
 #endif
   void chMtxObjectInit(mutex_t *mp);
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  void chMtxObjectInitCeiling(mutex_t *mp, tprio_t ceiling);
+#endif
   void chMtxLock(mutex_t *mp);
   void chMtxLockS(mutex_t *mp);
   bool chMtxTryLock(mutex_t *mp);
@@ -109,6 +195,14 @@ extern "C" {
   void chMtxUnlockS(mutex_t *mp);
   void chMtxUnlockAll(void);
   void chMtxUnlockAllS(void);
+  void _mtx_boost(thread_t *tp, tprio_t prio);
+#if CH_CFG_USE_CONDVARS == TRUE
+  void _mtx_handoff(mutex_t *mp, thread_t *tp);
+#endif
+#if CH_DBG_STATISTICS == TRUE
+  void chMtxStatsRegister(mutex_t *mp, const char *name);
+  void chMtxStatsUnregister(mutex_t *mp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -147,6 +241,39 @@ static inline mutex_t *chMtxGetNextMutexS(void) {
   return chThdGetSelfX()->mtxlist;
 }
 
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the first mutex registered for statistics.
+ *
+ * @return              A pointer to the first registered mutex.
+ * @retval NULL         if no mutex is registered.
+ *
+ * @iclass
+ */
+static inline mutex_t *chMtxStatsFirstI(void) {
+
+  chDbgCheckClassI();
+
+  return ch.kernel_stats.mtxlist;
+}
+
+/**
+ * @brief   Returns the next mutex registered for statistics.
+ *
+ * @param[in] mp        pointer to a registered @p mutex_t structure
+ * @return              A pointer to the next registered mutex.
+ * @retval NULL         if there are no more registered mutexes.
+ *
+ * @iclass
+ */
+static inline mutex_t *chMtxStatsNextI(mutex_t *mp) {
+
+  chDbgCheckClassI();
+
+  return mp->stats.next;
+}
+#endif
+
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
 #endif /* CHMTX_H */
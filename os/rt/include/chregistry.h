@@ -42,6 +42,11 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_REGISTRY_HASH_SIZE < 0) ||                                      \
+    ((CH_CFG_REGISTRY_HASH_SIZE & (CH_CFG_REGISTRY_HASH_SIZE - 1)) != 0)
+#error "CH_CFG_REGISTRY_HASH_SIZE must be zero or a power of two"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -70,6 +75,78 @@ typedef struct {
   uint8_t   off_time;               /**< @brief Offset of @p time field.    */
 } chdebug_t;
 
+/**
+ * @brief   Thread snapshot record.
+ * @details Copy of the state of a thread taken by @p chRegGetSnapshot().
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the thread.
+   * @note    No reference is held on the thread, the pointer is meant for
+   *          identification only.
+   */
+  thread_t              *tp;
+  /**
+   * @brief   Thread name or @p NULL.
+   */
+  const char            *name;
+  /**
+   * @brief   Thread current priority.
+   */
+  tprio_t               prio;
+#if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Thread priority without inheritance.
+   */
+  tprio_t               realprio;
+#endif
+  /**
+   * @brief   Thread state.
+   */
+  tstate_t              state;
+  /**
+   * @brief   Thread flags.
+   */
+  tmode_t               flags;
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
+    defined(__DOXYGEN__)
+  /**
+   * @brief   Working area base address.
+   */
+  stkalign_t            *wabase;
+#endif
+#if (CH_DBG_THREADS_PROFILING == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Thread consumed time in ticks.
+   */
+  systime_t             time;
+#endif
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Cumulative execution time in realtime counter cycles.
+   */
+  rttime_t              cumulative;
+#endif
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Budget reservation, zero if none.
+   */
+  systime_t             budget;
+  /**
+   * @brief   Budget replenishment period.
+   */
+  systime_t             period;
+  /**
+   * @brief   Ticks consumed under reservation.
+   */
+  systime_t             consumed;
+  /**
+   * @brief   Number of periods in which the budget has been exhausted.
+   */
+  ucnt_t                overruns;
+#endif
+} thread_snapshot_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -80,10 +157,18 @@ typedef struct {
  *
  * @param[in] tp        thread to remove from the registry
  */
+#if (CH_CFG_REGISTRY_HASH_SIZE == 0) || defined(__DOXYGEN__)
+#define REG_REMOVE(tp) {                                                    \
+  (tp)->older->newer = (tp)->newer;                                         \
+  (tp)->newer->older = (tp)->older;                                         \
+}
+#else
 #define REG_REMOVE(tp) {                                                    \
   (tp)->older->newer = (tp)->newer;                                         \
   (tp)->newer->older = (tp)->older;                                         \
+  (void) _reg_hash_remove(tp);                                              \
 }
+#endif
 
 /**
  * @brief   Adds a thread to the registry list.
@@ -91,12 +176,23 @@ typedef struct {
  *
  * @param[in] tp        thread to add to the registry
  */
+#if (CH_CFG_REGISTRY_HASH_SIZE == 0) || defined(__DOXYGEN__)
+#define REG_INSERT(tp) {                                                    \
+  (tp)->newer = (thread_t *)&ch.rlist;                                      \
+  (tp)->older = ch.rlist.older;                                           \
+  (tp)->older->newer = (tp);                                                \
+  ch.rlist.older = (tp);                                                  \
+}
+#else
 #define REG_INSERT(tp) {                                                    \
   (tp)->newer = (thread_t *)&ch.rlist;                                      \
   (tp)->older = ch.rlist.older;                                           \
   (tp)->older->newer = (tp);                                                \
   ch.rlist.older = (tp);                                                  \
+  (tp)->regseq = ch.regseq++;                                               \
+  _reg_hash_insert(tp);                                                     \
 }
+#endif
 
 /*===========================================================================*/
 /* External declarations.                                                    */
@@ -111,6 +207,12 @@ extern "C" {
   thread_t *chRegFindThreadByName(const char *name);
   thread_t *chRegFindThreadByPointer(thread_t *tp);
   thread_t *chRegFindThreadByWorkingArea(stkalign_t *wa);
+  cnt_t chRegGetSnapshot(thread_snapshot_t *snp, cnt_t n);
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  void _reg_hash_insert(thread_t *tp);
+  bool _reg_hash_remove(thread_t *tp);
+  void _reg_hash_rename(thread_t *tp, const char *name);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -132,7 +234,9 @@ extern "C" {
  */
 static inline void chRegSetThreadName(const char *name) {
 
-#if CH_CFG_USE_REGISTRY == TRUE
+#if (CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)
+  _reg_hash_rename(ch.rlist.current, name);
+#elif CH_CFG_USE_REGISTRY == TRUE
   ch.rlist.current->name = name;
 #else
   (void)name;
@@ -172,7 +276,9 @@ static inline const char *chRegGetThreadNameX(thread_t *tp) {
  */
 static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 
-#if CH_CFG_USE_REGISTRY == TRUE
+#if (CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)
+  _reg_hash_rename(tp, name);
+#elif CH_CFG_USE_REGISTRY == TRUE
   tp->name = name;
 #else
   (void)tp;
@@ -0,0 +1,141 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chrwlock.h
+ * @brief   Reader/Writer locks macros and structures.
+ *
+ * @addtogroup rwlocks
+ * @{
+ */
+
+#ifndef CHRWLOCK_H
+#define CHRWLOCK_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Reader/Writer locks APIs.
+ * @details If enabled then the reader/writer locks APIs are included in
+ *          the kernel.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#if !defined(CH_CFG_USE_RWLOCKS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_RWLOCKS                  FALSE
+#endif
+
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MUTEXES == FALSE
+#error "CH_CFG_USE_RWLOCKS requires CH_CFG_USE_MUTEXES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a reader/writer lock structure.
+ */
+typedef struct ch_rwlock {
+  mutex_t               mtx;        /**< @brief Mutex owned by the writer,
+                                                readers only hold it while
+                                                registering.                */
+  thread_reference_t    writer;     /**< @brief Writer waiting for the
+                                                readers to leave or
+                                                @p NULL.                    */
+  cnt_t                 readers;    /**< @brief Number of active readers.   */
+} rwlock_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static reader/writer lock initializer.
+ * @details This macro should be used when statically initializing a
+ *          reader/writer lock that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the reader/writer lock variable
+ */
+#define _RWLOCK_DATA(name) {_MUTEX_DATA(name.mtx), NULL, (cnt_t)0}
+
+/**
+ * @brief   Static reader/writer lock initializer.
+ * @details Statically initialized reader/writer locks require no explicit
+ *          initialization using @p chRWLockObjectInit().
+ *
+ * @param[in] name      the name of the reader/writer lock variable
+ */
+#define RWLOCK_DECL(name) rwlock_t name = _RWLOCK_DATA(name)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRWLockObjectInit(rwlock_t *rwp);
+  void chRWLockReadLock(rwlock_t *rwp);
+  void chRWLockReadLockS(rwlock_t *rwp);
+  void chRWLockReadUnlock(rwlock_t *rwp);
+  void chRWLockReadUnlockS(rwlock_t *rwp);
+  void chRWLockWriteLock(rwlock_t *rwp);
+  void chRWLockWriteLockS(rwlock_t *rwp);
+  void chRWLockWriteUnlock(rwlock_t *rwp);
+  void chRWLockWriteUnlockS(rwlock_t *rwp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of readers currently holding the lock.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ * @return              The number of active readers.
+ *
+ * @iclass
+ */
+static inline cnt_t chRWLockGetReadersI(rwlock_t *rwp) {
+
+  chDbgCheckClassI();
+
+  return rwp->readers;
+}
+
+#endif /* CH_CFG_USE_RWLOCKS == TRUE */
+
+#endif /* CHRWLOCK_H */
+
+/** @} */
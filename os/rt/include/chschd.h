@@ -102,14 +102,53 @@
                                                  from a Memory Heap.        */
 #define CH_FLAG_MODE_MPOOL  (tmode_t)2U     /**< @brief Thread allocated
                                                  from a Memory Pool.        */
+#define CH_FLAG_MODE_CACHE  (tmode_t)3U     /**< @brief Thread allocated
+                                                 from the working areas
+                                                 cache.                     */
 #define CH_FLAG_TERMINATE   (tmode_t)4U     /**< @brief Termination requested
                                                  flag.                      */
+#define CH_FLAG_BROADCAST   (tmode_t)8U     /**< @brief Released from a
+                                                 condition variable by a
+                                                 broadcast.                 */
 /** @} */
 
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Size of the registry names hash index.
+ * @details If greater than zero then the registry keeps an hash index of
+ *          the threads names and @p chRegFindThreadByName() does not need
+ *          to scan the whole registry. The value must be a power of two.
+ * @note    The setting is declared here because it affects the
+ *          @p thread_t structure, it is only meaningful when
+ *          @p CH_CFG_USE_REGISTRY is enabled.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_REGISTRY_HASH_SIZE           0
+#endif
+
+/**
+ * @brief   Earliest Deadline First scheduling.
+ * @details If enabled then threads can be given a period and a relative
+ *          deadline, EDF threads having the same priority are ordered by
+ *          absolute deadline instead of FIFO.
+ */
+#if !defined(CH_CFG_USE_EDF) || defined(__DOXYGEN__)
+#define CH_CFG_USE_EDF                      FALSE
+#endif
+
+/**
+ * @brief   CPU budget reservations.
+ * @details If enabled then threads can be given an execution budget
+ *          replenished periodically, a thread exhausting its budget is
+ *          demoted to a background priority until the next replenishment.
+ */
+#if !defined(CH_CFG_USE_BUDGETS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_BUDGETS                  FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -145,6 +184,21 @@ struct ch_threads_queue {
   thread_t              *prev;      /**< @brief Previous in the queue.      */
 };
 
+/**
+ * @extends virtual_timers_list_t
+ *
+ * @brief   Virtual Timer descriptor structure.
+ */
+struct ch_virtual_timer {
+  virtual_timer_t       *next;      /**< @brief Next timer in the list.     */
+  virtual_timer_t       *prev;      /**< @brief Previous timer in the list. */
+  systime_t             delta;      /**< @brief Time delta before timeout.  */
+  vtfunc_t              func;       /**< @brief Timer callback function
+                                                pointer.                    */
+  void                  *par;       /**< @brief Timer callback function
+                                                parameter.                  */
+};
+
 /**
  * @brief   Structure representing a thread.
  * @note    Not all the listed fields are always needed, by switching off some
@@ -166,6 +220,18 @@ struct ch_thread {
    */
   const char            *name;
 #endif
+#if ((CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)) ||   \
+    defined(__DOXYGEN__)
+  /**
+   * @brief   Next thread in the same names hash bucket.
+   */
+  thread_t              *hashnext;
+  /**
+   * @brief   Registry insertion sequence number.
+   * @note    Hash buckets are kept sorted by this field.
+   */
+  ucnt_t                regseq;
+#endif
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
     defined(__DOXYGEN__)
   /**
@@ -201,6 +267,13 @@ struct ch_thread {
    * @note    This field can overflow.
    */
   volatile systime_t    time;
+#endif
+#if (CH_DBG_STACK_SENTINEL == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Minimum stack headroom in bytes recorded by the sentinel.
+   * @note    The value is @p ~0 until the first sentinel scan.
+   */
+  size_t                headroom;
 #endif
   /**
    * @brief   State-specific fields.
@@ -298,6 +371,79 @@ struct ch_thread {
    */
   tprio_t               realprio;
 #endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   EDF scheduling parameters.
+   * @note    A zero relative deadline means that the thread is not subject
+   *          to EDF ordering.
+   */
+  struct {
+    /**
+     * @brief   Release period.
+     */
+    systime_t           period;
+    /**
+     * @brief   Relative deadline.
+     */
+    systime_t           reldeadline;
+    /**
+     * @brief   Release time of the current job.
+     */
+    systime_t           release;
+    /**
+     * @brief   Absolute deadline of the current job.
+     */
+    systime_t           deadline;
+    /**
+     * @brief   Number of jobs completed after their deadline.
+     */
+    ucnt_t              misses;
+  } edf;
+#endif
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   CPU budget reservation.
+   * @note    A zero budget means that the thread has no reservation.
+   */
+  struct {
+    /**
+     * @brief   Ticks allowed in each period.
+     */
+    systime_t           budget;
+    /**
+     * @brief   Replenishment period.
+     */
+    systime_t           period;
+    /**
+     * @brief   Ticks used in the current period.
+     */
+    systime_t           used;
+    /**
+     * @brief   Total ticks consumed since the reservation was set.
+     */
+    systime_t           consumed;
+    /**
+     * @brief   Number of periods in which the budget has been exhausted.
+     */
+    ucnt_t              overruns;
+    /**
+     * @brief   Priority of the thread while throttled.
+     */
+    tprio_t             lowprio;
+    /**
+     * @brief   Priority to be restored on replenishment.
+     */
+    tprio_t             prio;
+    /**
+     * @brief   The thread is running at @p lowprio.
+     */
+    bool                throttled;
+    /**
+     * @brief   Replenishment timer.
+     */
+    virtual_timer_t     vt;
+  } budget;
+#endif
 #if ((CH_CFG_USE_DYNAMIC == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE)) ||      \
     defined(__DOXYGEN__)
   /**
@@ -317,21 +463,6 @@ struct ch_thread {
 #endif
 };
 
-/**
- * @extends virtual_timers_list_t
- *
- * @brief   Virtual Timer descriptor structure.
- */
-struct ch_virtual_timer {
-  virtual_timer_t       *next;      /**< @brief Next timer in the list.     */
-  virtual_timer_t       *prev;      /**< @brief Previous timer in the list. */
-  systime_t             delta;      /**< @brief Time delta before timeout.  */
-  vtfunc_t              func;       /**< @brief Timer callback function
-                                                pointer.                    */
-  void                  *par;       /**< @brief Timer callback function
-                                                parameter.                  */
-};
-
 /**
  * @brief   Virtual timers list header.
  * @note    The timers list is implemented as a double link bidirectional list
@@ -438,6 +569,17 @@ struct ch_system {
    */
   kernel_stats_t        kernel_stats;
 #endif
+#if ((CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)) ||   \
+    defined(__DOXYGEN__)
+  /**
+   * @brief   Registry names hash index.
+   */
+  thread_t              *reghash[CH_CFG_REGISTRY_HASH_SIZE];
+  /**
+   * @brief   Sequence number of the next thread added to the registry.
+   */
+  ucnt_t                regseq;
+#endif
 };
 
 /*===========================================================================*/
@@ -475,6 +617,7 @@ extern "C" {
   void _scheduler_init(void);
   thread_t *chSchReadyI(thread_t *tp);
   thread_t *chSchReadyAheadI(thread_t *tp);
+  void chSchReadyListI(thread_t *tp);
   void chSchGoSleepS(tstate_t newstate);
   msg_t chSchGoSleepTimeoutS(tstate_t newstate, systime_t time);
   void chSchWakeupS(thread_t *ntp, msg_t msg);
@@ -641,6 +784,36 @@ static inline thread_t *queue_dequeue(thread_t *tp) {
 }
 #endif /* CH_CFG_OPTIMIZE_SPEED == TRUE */
 
+/**
+ * @brief   Threads precedence.
+ * @details A thread precedes another if it has higher priority or, if
+ *          @p CH_CFG_USE_EDF is enabled, if both are EDF threads with the
+ *          same priority and its absolute deadline is earlier.
+ * @note    Deadlines are compared as a difference so they must be less
+ *          than half the system time range apart.
+ * @note    The ready list header can be passed as @p tp2, its priority is
+ *          lower than any thread so its other fields are never accessed.
+ *
+ * @param[in] tp1       first thread
+ * @param[in] tp2       second thread
+ * @return              The precedence of @p tp1 over @p tp2.
+ *
+ * @notapi
+ */
+static inline bool sch_precedes(const thread_t *tp1, const thread_t *tp2) {
+
+#if CH_CFG_USE_EDF == TRUE
+  return (tp1->prio > tp2->prio) ||
+         ((tp1->prio == tp2->prio) &&
+          (tp1->edf.reldeadline > (systime_t)0) &&
+          (tp2->edf.reldeadline > (systime_t)0) &&
+          ((systime_t)(tp2->edf.deadline - tp1->edf.deadline - (systime_t)1) <
+           (systime_t)(((systime_t)-1) / (systime_t)2)));
+#else
+  return tp1->prio > tp2->prio;
+#endif
+}
+
 /**
  * @brief   Determines if the current thread must reschedule.
  * @details This function returns @p true if there is a ready thread with
@@ -656,7 +829,7 @@ static inline bool chSchIsRescRequiredI(void) {
 
   chDbgCheckClassI();
 
-  return firstprio(&ch.rlist.queue) > currp->prio;
+  return sch_precedes(ch.rlist.queue.next, currp);
 }
 
 /**
@@ -674,7 +847,7 @@ static inline bool chSchCanYieldS(void) {
 
   chDbgCheckClassS();
 
-  return firstprio(&ch.rlist.queue) >= currp->prio;
+  return !sch_precedes(currp, ch.rlist.queue.next);
 }
 
 /**
@@ -701,22 +874,21 @@ static inline void chSchDoYieldS(void) {
  * @special
  */
 static inline void chSchPreemption(void) {
-  tprio_t p1 = firstprio(&ch.rlist.queue);
-  tprio_t p2 = currp->prio;
+  thread_t *ftp = ch.rlist.queue.next;
 
 #if CH_CFG_TIME_QUANTUM > 0
   if (currp->preempt > (tslices_t)0) {
-    if (p1 > p2) {
+    if (sch_precedes(ftp, currp)) {
       chSchDoRescheduleAhead();
     }
   }
   else {
-    if (p1 >= p2) {
+    if (!sch_precedes(currp, ftp)) {
       chSchDoRescheduleBehind();
     }
   }
 #else /* CH_CFG_TIME_QUANTUM == 0 */
-  if (p1 > p2) {
+  if (sch_precedes(ftp, currp)) {
     chSchDoRescheduleAhead();
   }
 #endif /* CH_CFG_TIME_QUANTUM == 0 */
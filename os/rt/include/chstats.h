@@ -28,6 +28,43 @@
 #ifndef CHSTATS_H
 #define CHSTATS_H
 
+/**
+ * @brief   Critical zones profiler.
+ * @details If enabled then the call sites of the critical zones longer
+ *          than all the previous ones, or longer than
+ *          @p CH_DBG_CRIT_PROFILER_THRESHOLD, are recorded in a table of
+ *          the worst @p CH_DBG_CRIT_PROFILER_SIZE call sites.
+ * @note    Requires @p CH_DBG_STATISTICS.
+ */
+#if !defined(CH_DBG_CRIT_PROFILER) || defined(__DOXYGEN__)
+#define CH_DBG_CRIT_PROFILER                FALSE
+#endif
+
+/**
+ * @brief   Number of call sites recorded by the critical zones profiler.
+ */
+#if !defined(CH_DBG_CRIT_PROFILER_SIZE) || defined(__DOXYGEN__)
+#define CH_DBG_CRIT_PROFILER_SIZE           8
+#endif
+
+/**
+ * @brief   Critical zones profiler recording threshold.
+ * @details Critical zones lasting at least this number of realtime counter
+ *          cycles are always recorded, zero means that only new worst
+ *          cases are recorded.
+ */
+#if !defined(CH_DBG_CRIT_PROFILER_THRESHOLD) || defined(__DOXYGEN__)
+#define CH_DBG_CRIT_PROFILER_THRESHOLD      0
+#endif
+
+#if (CH_DBG_CRIT_PROFILER == TRUE) && (CH_DBG_STATISTICS == FALSE)
+#error "CH_DBG_CRIT_PROFILER requires CH_DBG_STATISTICS"
+#endif
+
+#if (CH_DBG_CRIT_PROFILER == TRUE) && (CH_DBG_CRIT_PROFILER_SIZE < 1)
+#error "invalid CH_DBG_CRIT_PROFILER_SIZE value"
+#endif
+
 #if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
 
 /*===========================================================================*/
@@ -50,6 +87,20 @@
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+#if (CH_DBG_CRIT_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a critical zones profiler entry.
+ */
+typedef struct {
+  const void            *site;      /**< @brief Return address of the code
+                                                that entered the zone.      */
+  rtcnt_t               worst;      /**< @brief Longest recorded zone.      */
+  ucnt_t                n;          /**< @brief Number of recorded zones,
+                                                zero if the entry is free.  */
+  bool                  isr;        /**< @brief Zone entered from an ISR.   */
+} crit_site_t;
+#endif
+
 /**
  * @brief   Type of a kernel statistics structure.
  */
@@ -60,6 +111,22 @@ typedef struct {
                                                 critical zones duration.    */
   time_measurement_t    m_crit_isr; /**< @brief Measurement of ISRs critical
                                                 zones duration.             */
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+  time_measurement_t    m_evt_bcast;/**< @brief Measurement of the mode
+                                                broadcasts duration.        */
+#endif
+#if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
+  struct ch_mutex       *mtxlist;   /**< @brief List of the mutexes
+                                                registered for statistics.  */
+#endif
+#if (CH_DBG_CRIT_PROFILER == TRUE) || defined(__DOXYGEN__)
+  const void            *crit_thd_site; /**< @brief Call site of the current
+                                                thread critical zone.       */
+  const void            *crit_isr_site; /**< @brief Call site of the current
+                                                ISR critical zone.          */
+  crit_site_t           crit_sites[CH_DBG_CRIT_PROFILER_SIZE];
+                                    /**< @brief Worst call sites, unordered.*/
+#endif
 } kernel_stats_t;
 
 /*===========================================================================*/
@@ -80,6 +147,10 @@ extern "C" {
   void _stats_stop_measure_crit_thd(void);
   void _stats_start_measure_crit_isr(void);
   void _stats_stop_measure_crit_isr(void);
+#if CH_DBG_CRIT_PROFILER == TRUE
+  unsigned chStatsGetCritSites(crit_site_t *csp, unsigned n);
+  void chStatsResetCritSites(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -226,6 +226,9 @@ extern "C" {
    thread_t *_thread_init(thread_t *tp, const char *name, tprio_t prio);
 #if CH_DBG_FILL_THREADS == TRUE
   void _thread_memfill(uint8_t *startp, uint8_t *endp, uint8_t v);
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE)
+  size_t chThdGetStackUnusedX(thread_t *tp);
+#endif
 #endif
   thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp);
   thread_t *chThdCreateSuspended(const thread_descriptor_t *tdp);
@@ -244,6 +247,10 @@ extern "C" {
   msg_t chThdWait(thread_t *tp);
 #endif
   tprio_t chThdSetPriority(tprio_t newprio);
+#if CH_CFG_USE_EDF == TRUE
+  void chThdSetEDF(systime_t period, systime_t deadline);
+  bool chThdSleepUntilNextPeriod(void);
+#endif
   void chThdTerminate(thread_t *tp);
   msg_t chThdSuspendS(thread_reference_t *trp);
   msg_t chThdSuspendTimeoutS(thread_reference_t *trp, systime_t timeout);
@@ -307,6 +314,23 @@ static inline systime_t chThdGetTicksX(thread_t *tp) {
 }
 #endif
 
+/**
+ * @brief   Returns the number of deadlines missed by the specified thread.
+ * @note    This function is only available when the
+ *          @p CH_CFG_USE_EDF configuration option is enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of EDF jobs completed late.
+ *
+ * @xclass
+ */
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+static inline ucnt_t chThdGetDeadlineMissesX(thread_t *tp) {
+
+  return tp->edf.misses;
+}
+#endif
+
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
     defined(__DOXYGEN__)
 /**
@@ -323,6 +347,22 @@ static inline stkalign_t *chThdGetWorkingAreaX(thread_t *tp) {
 }
 #endif /* CH_DBG_ENABLE_STACK_CHECK == TRUE */
 
+#if (CH_DBG_STACK_SENTINEL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the minimum stack headroom recorded by the sentinel.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The minimum headroom in bytes, @p ~0 if the thread
+ *                      has not been scanned yet.
+ *
+ * @xclass
+ */
+static inline size_t chThdGetStackHeadroomX(thread_t *tp) {
+
+  return tp->headroom;
+}
+#endif /* CH_DBG_STACK_SENTINEL == TRUE */
+
 /**
  * @brief   Verifies if the specified thread is in the @p CH_STATE_FINAL state.
  *
@@ -0,0 +1,200 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chworkq.h
+ * @brief   Work queues macros and structures.
+ *
+ * @addtogroup workqueues
+ * @{
+ */
+
+#ifndef CHWORKQ_H
+#define CHWORKQ_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Work item states
+ * @{
+ */
+#define WQ_STATE_IDLE       (wqstate_t)0U   /**< @brief Not pending.        */
+#define WQ_STATE_QUEUED     (wqstate_t)1U   /**< @brief Waiting for a
+                                                 worker.                    */
+#define WQ_STATE_DELAYED    (wqstate_t)2U   /**< @brief Waiting for the
+                                                 delay to expire.           */
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Work queues APIs.
+ * @details If enabled then the work queues APIs are included in the
+ *          kernel.
+ */
+#if !defined(CH_CFG_USE_WORKQUEUES) || defined(__DOXYGEN__)
+#define CH_CFG_USE_WORKQUEUES               FALSE
+#endif
+
+#if (CH_CFG_USE_WORKQUEUES == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a work item state.
+ */
+typedef uint8_t wqstate_t;
+
+/**
+ * @brief   Type of a work function.
+ *
+ * @param[in] arg       the argument specified in the work item
+ */
+typedef void (*wqfunc_t)(void *arg);
+
+/**
+ * @brief   Type of a work queue.
+ */
+typedef struct ch_work_queue work_queue_t;
+
+/**
+ * @brief   Type of a work item.
+ */
+typedef struct ch_work_item work_item_t;
+
+/**
+ * @brief   Work item structure.
+ */
+struct ch_work_item {
+  work_item_t           *next;      /**< @brief Next item in the queue.     */
+  wqfunc_t              func;       /**< @brief Work function.              */
+  void                  *arg;       /**< @brief Work function argument.     */
+  work_queue_t          *wqp;       /**< @brief Queue the item is pending
+                                                on or @p NULL.              */
+  wqstate_t             state;      /**< @brief Item state.                 */
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  rtcnt_t               posted;     /**< @brief Realtime counter value when
+                                                the item has been queued.   */
+#endif
+};
+
+/**
+ * @brief   Type of a delayed work item.
+ */
+typedef struct {
+  work_item_t           item;       /**< @brief The work item.              */
+  virtual_timer_t       vt;         /**< @brief Delay timer.                */
+} delayed_work_t;
+
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a work queue statistics structure.
+ */
+typedef struct {
+  ucnt_t                n_posted;   /**< @brief Number of queued items.     */
+  ucnt_t                n_merged;   /**< @brief Number of posts merged with
+                                                an already pending item.    */
+  ucnt_t                n_executed; /**< @brief Number of executed items.   */
+  rtcnt_t               worst;      /**< @brief Worst latency in realtime
+                                                counter cycles.             */
+  rttime_t              cumulative; /**< @brief Cumulative latency in
+                                                realtime counter cycles.    */
+} work_queue_stats_t;
+#endif
+
+/**
+ * @brief   Work queue structure.
+ */
+struct ch_work_queue {
+  work_item_t           *head;      /**< @brief First queued item or
+                                                @p NULL.                    */
+  work_item_t           *tail;      /**< @brief Last queued item.           */
+  threads_queue_t       workers;    /**< @brief Idle worker threads.        */
+  const char            *name;      /**< @brief Name of the worker
+                                                threads.                    */
+  bool                  terminate;  /**< @brief Termination requested.      */
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  work_queue_stats_t    stats;      /**< @brief Latency statistics.         */
+#endif
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chWQObjectInit(work_queue_t *wqp, const char *name);
+  thread_t *chWQAddWorker(work_queue_t *wqp, void *wsp, size_t size,
+                          tprio_t prio);
+  void chWQTerminate(work_queue_t *wqp);
+  void chWQItemObjectInit(work_item_t *wip, wqfunc_t func, void *arg);
+  void chWQDelayedObjectInit(delayed_work_t *dwp, wqfunc_t func, void *arg);
+  bool chWQPostI(work_queue_t *wqp, work_item_t *wip);
+  bool chWQPost(work_queue_t *wqp, work_item_t *wip);
+  bool chWQPostDelayedI(work_queue_t *wqp, delayed_work_t *dwp,
+                        systime_t delay);
+  bool chWQPostDelayed(work_queue_t *wqp, delayed_work_t *dwp,
+                       systime_t delay);
+  bool chWQCancelI(work_item_t *wip);
+  bool chWQCancelDelayedI(delayed_work_t *dwp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns @p true if a work item is pending.
+ * @details An item is pending while queued or while its delay is running.
+ *
+ * @param[in] wip       pointer to the @p work_item_t structure
+ * @return              The item pending state.
+ *
+ * @iclass
+ */
+static inline bool chWQIsPendingI(work_item_t *wip) {
+
+  chDbgCheckClassI();
+
+  return (bool)(wip->state != WQ_STATE_IDLE);
+}
+
+#endif /* CH_CFG_USE_WORKQUEUES == TRUE */
+
+#endif /* CHWORKQ_H */
+
+/** @} */
@@ -18,6 +18,9 @@ endif
 ifneq ($(findstring CH_CFG_USE_REGISTRY TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chregistry.c
 endif
+ifneq ($(findstring CH_CFG_USE_BUDGETS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chbudget.c
+endif
 ifneq ($(findstring CH_CFG_USE_SEMAPHORES TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chsem.c
 endif
@@ -27,6 +30,9 @@ endif
 ifneq ($(findstring CH_CFG_USE_CONDVARS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chcond.c
 endif
+ifneq ($(findstring CH_CFG_USE_RWLOCKS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chrwlock.c
+endif
 ifneq ($(findstring CH_CFG_USE_EVENTS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chevents.c
 endif
@@ -36,6 +42,9 @@ endif
 ifneq ($(findstring CH_CFG_USE_DYNAMIC TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chdynamic.c
 endif
+ifneq ($(findstring CH_CFG_USE_WORKQUEUES TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chworkq.c
+endif
 ifneq ($(findstring CH_CFG_USE_MAILBOXES TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmboxes.c
 endif
@@ -48,6 +57,9 @@ endif
 ifneq ($(findstring CH_CFG_USE_MEMPOOLS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmempools.c
 endif
+ifneq ($(findstring CH_CFG_USE_OBJ_FIFOS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/chobjfifos.c
+endif
 else
 KERNSRC := $(CHIBIOS)/os/rt/src/chsys.c \
            $(CHIBIOS)/os/rt/src/chdebug.c \
@@ -58,16 +70,20 @@ KERNSRC := $(CHIBIOS)/os/rt/src/chsys.c \
            $(CHIBIOS)/os/rt/src/chtm.c \
            $(CHIBIOS)/os/rt/src/chstats.c \
            $(CHIBIOS)/os/rt/src/chregistry.c \
+           $(CHIBIOS)/os/rt/src/chbudget.c \
            $(CHIBIOS)/os/rt/src/chsem.c \
            $(CHIBIOS)/os/rt/src/chmtx.c \
            $(CHIBIOS)/os/rt/src/chcond.c \
+           $(CHIBIOS)/os/rt/src/chrwlock.c \
            $(CHIBIOS)/os/rt/src/chevents.c \
            $(CHIBIOS)/os/rt/src/chmsg.c \
            $(CHIBIOS)/os/rt/src/chdynamic.c \
+           $(CHIBIOS)/os/rt/src/chworkq.c \
            $(CHIBIOS)/os/common/oslib/src/chmboxes.c \
            $(CHIBIOS)/os/common/oslib/src/chmemcore.c \
            $(CHIBIOS)/os/common/oslib/src/chheap.c \
-           $(CHIBIOS)/os/common/oslib/src/chmempools.c
+           $(CHIBIOS)/os/common/oslib/src/chmempools.c \
+           $(CHIBIOS)/os/common/oslib/src/chobjfifos.c
 endif
 
 # Required include directories
@@ -0,0 +1,258 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chbudget.c
+ * @brief   CPU budget reservations code.
+ *
+ * @addtogroup budgets
+ * @details CPU budget reservations related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          A thread can be given a budget of system ticks to be consumed
+ *          in each period, the ticks are charged to the running thread
+ *          from the system tick handler.<br>
+ *          When the budget is exhausted the thread is throttled, its
+ *          priority is lowered to a background level specified with the
+ *          reservation, so it cannot starve the threads below its normal
+ *          priority. The budget is replenished, and the priority restored,
+ *          at the end of each period by a virtual timer.<br>
+ *          A priority boosted by the mutexes priority inheritance is not
+ *          lowered while throttled, it falls on the mutex release as it
+ *          would do after @p chThdSetPriority().
+ *          <h2>Constraints</h2>
+ *          Accounting is tick based so the tick-less mode is not supported,
+ *          priority changes performed on a throttled thread are overridden
+ *          on replenishment.
+ * @pre     In order to use the budget APIs the @p CH_CFG_USE_BUDGETS option
+ *          must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Changes the priority of a thread in any state.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] newprio   the new priority level
+ */
+static void budget_set_prio(thread_t *tp, tprio_t newprio) {
+
+#if CH_CFG_USE_MUTEXES == TRUE
+  /* Same rules of chThdSetPriority(), an inherited priority is kept.*/
+  if ((tp->prio == tp->realprio) || (newprio > tp->prio)) {
+    tp->prio = newprio;
+  }
+  tp->realprio = newprio;
+#else
+  tp->prio = newprio;
+#endif
+
+  /* The following states need priority queues reordering.*/
+  switch (tp->state) {
+#if CH_CFG_USE_MUTEXES == TRUE
+  case CH_STATE_WTMTX:
+    /* Re-enqueues tp with its new priority on the mutex queue then the
+       priority is propagated to the owner as the priority inheritance
+       protocol does.*/
+    queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
+    _mtx_boost(tp->u.wtmtxp->owner, tp->prio);
+    break;
+#endif
+#if CH_CFG_USE_CONDVARS == TRUE
+  case CH_STATE_WTCOND:
+    /* Re-enqueues tp with its new priority on the condition variable.*/
+    queue_prio_insert(queue_dequeue(tp),
+                      &((condition_variable_t *)tp->u.wtobjp)->queue);
+    break;
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
+    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
+  case CH_STATE_WTSEM:
+    /* Re-enqueues tp with its new priority on the semaphore.*/
+    queue_prio_insert(queue_dequeue(tp), &tp->u.wtsemp->queue);
+    break;
+#endif
+  case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+    /* Prevents an assertion in chSchReadyI().*/
+    tp->state = CH_STATE_CURRENT;
+#endif
+    /* Re-enqueues tp with its new priority on the ready list.*/
+    (void) chSchReadyI(queue_dequeue(tp));
+    break;
+  default:
+    /* Nothing to do for other states, a sender in CH_STATE_SNDMSGQ keeps
+       its position because the message queue is not reachable from the
+       thread.*/
+    break;
+  }
+}
+
+/**
+ * @brief   Restores a throttled thread.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+static void budget_restore(thread_t *tp) {
+
+  if (tp->budget.throttled) {
+    tp->budget.throttled = false;
+    budget_set_prio(tp, tp->budget.prio);
+  }
+}
+
+/**
+ * @brief   Budget replenishment timer callback.
+ *
+ * @param[in] p         pointer to the thread
+ */
+static void budget_replenish(void *p) {
+  thread_t *tp = (thread_t *)p;
+
+  chSysLockFromISR();
+  tp->budget.used = (systime_t)0;
+  budget_restore(tp);
+  chVTDoSetI(&tp->budget.vt, tp->budget.period, budget_replenish, tp);
+  chSysUnlockFromISR();
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Charges the current tick to the running thread.
+ * @details If the running thread exhausts its budget then it is demoted,
+ *          the preemption check at the end of the tick interrupt performs
+ *          the switch to the next thread.
+ *
+ * @notapi
+ */
+void _budget_tick(void) {
+  thread_t *tp = currp;
+
+  if (tp->budget.budget > (systime_t)0) {
+    tp->budget.consumed++;
+    if (!tp->budget.throttled) {
+      tp->budget.used++;
+      if (tp->budget.used >= tp->budget.budget) {
+        tp->budget.throttled = true;
+        tp->budget.overruns++;
+#if CH_CFG_USE_MUTEXES == TRUE
+        tp->budget.prio = tp->realprio;
+#else
+        tp->budget.prio = tp->prio;
+#endif
+        if (tp->budget.lowprio < tp->budget.prio) {
+          budget_set_prio(tp, tp->budget.lowprio);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief   Sets a thread budget reservation.
+ * @details The thread is allowed to run for @p budget ticks in each
+ *          @p period, the first period starts immediately. Any previous
+ *          reservation is replaced and the statistics are cleared.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] budget    ticks allowed in each period, zero removes the
+ *                      reservation
+ * @param[in] period    replenishment period
+ * @param[in] lowprio   priority of the thread after exhausting its budget
+ *
+ * @iclass
+ */
+void chBudgetSetI(thread_t *tp, systime_t budget,
+                  systime_t period, tprio_t lowprio) {
+
+  chDbgCheckClassI();
+  chDbgCheck((tp != NULL) && (budget <= period) && (lowprio <= HIGHPRIO));
+  chDbgAssert(tp->state != CH_STATE_FINAL, "terminated thread");
+
+  /* Removing the current reservation, if any.*/
+  if (chVTIsArmedI(&tp->budget.vt)) {
+    chVTDoResetI(&tp->budget.vt);
+  }
+  budget_restore(tp);
+
+  tp->budget.budget   = budget;
+  tp->budget.period   = period;
+  tp->budget.lowprio  = lowprio;
+  tp->budget.used     = (systime_t)0;
+  tp->budget.consumed = (systime_t)0;
+  tp->budget.overruns = (ucnt_t)0;
+  if (budget > (systime_t)0) {
+    chVTDoSetI(&tp->budget.vt, period, budget_replenish, tp);
+  }
+}
+
+/**
+ * @brief   Sets a thread budget reservation.
+ * @details The thread is allowed to run for @p budget ticks in each
+ *          @p period, the first period starts immediately. Any previous
+ *          reservation is replaced and the statistics are cleared.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] budget    ticks allowed in each period, zero removes the
+ *                      reservation
+ * @param[in] period    replenishment period
+ * @param[in] lowprio   priority of the thread after exhausting its budget
+ *
+ * @api
+ */
+void chBudgetSet(thread_t *tp, systime_t budget,
+                 systime_t period, tprio_t lowprio) {
+
+  chSysLock();
+  chBudgetSetI(tp, budget, period, lowprio);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_BUDGETS == TRUE */
+
+/** @} */
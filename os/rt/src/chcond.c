@@ -31,7 +31,15 @@
  *          <h2>Operation mode</h2>
  *          The condition variable is a synchronization object meant to be
  *          used inside a zone protected by a mutex. Mutexes and condition
- *          variables together can implement a Monitor construct.
+ *          variables together can implement a Monitor construct.<br>
+ *          Signaled threads are not made ready, they are moved from the
+ *          condition variable queue directly on the mutex queue (wait
+ *          morphing), only the thread actually getting the mutex is
+ *          awakened. This avoids the threads woken by a broadcast to just
+ *          run in order to go to sleep again on the mutex.
+ *          <h2>Constraints</h2>
+ *          All the threads waiting at the same time on a condition variable
+ *          must release the same mutex.
  * @pre     In order to use the condition variable APIs the @p CH_CFG_USE_CONDVARS
  *          option must be enabled in @p chconf.h.
  * @{
@@ -61,6 +69,35 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Releases the first thread waiting on the condition variable.
+ * @details The thread is not made ready, the mutex it released is locked
+ *          on its behalf.
+ *
+ * @param[in] cp        pointer to the @p condition_variable_t structure
+ * @param[in] flags     @p CH_FLAG_BROADCAST or zero
+ */
+static void cond_release(condition_variable_t *cp, tmode_t flags) {
+  thread_t *tp = queue_fifo_remove(&cp->queue);
+
+  tp->flags = (tp->flags & (tmode_t)~CH_FLAG_BROADCAST) | flags;
+  _mtx_handoff(cp->mtx, tp);
+}
+
+/**
+ * @brief   Waiting threads message.
+ *
+ * @param[in] tp        pointer to the released thread
+ * @return              The message returned by the wait functions.
+ */
+static msg_t cond_msg(thread_t *tp) {
+
+  if ((tp->flags & CH_FLAG_BROADCAST) != (tmode_t)0) {
+    return MSG_RESET;
+  }
+  return MSG_OK;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -77,6 +114,7 @@ void chCondObjectInit(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   queue_init(&cp->queue);
+  cp->mtx = NULL;
 }
 
 /**
@@ -91,9 +129,8 @@ void chCondSignal(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   chSysLock();
-  if (queue_notempty(&cp->queue)) {
-    chSchWakeupS(queue_fifo_remove(&cp->queue), MSG_OK);
-  }
+  chCondSignalI(cp);
+  chSchRescheduleS();
   chSysUnlock();
 }
 
@@ -114,9 +151,7 @@ void chCondSignalI(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   if (queue_notempty(&cp->queue)) {
-    thread_t *tp = queue_fifo_remove(&cp->queue);
-    tp->u.rdymsg = MSG_OK;
-    (void) chSchReadyI(tp);
+    cond_release(cp, (tmode_t)0);
   }
 }
 
@@ -151,11 +186,12 @@ void chCondBroadcastI(condition_variable_t *cp) {
   chDbgCheckClassI();
   chDbgCheck(cp != NULL);
 
-  /* Empties the condition variable queue and inserts all the threads into the
-     ready list in FIFO order. The wakeup message is set to @p MSG_RESET in
-     order to make a chCondBroadcast() detectable from a chCondSignal().*/
+  /* Empties the condition variable queue moving all the threads on the
+     mutex queue in FIFO order, at most one of them is made ready. The
+     threads are marked in order to make a chCondBroadcast() detectable
+     from a chCondSignal().*/
   while (queue_notempty(&cp->queue)) {
-    chSchReadyI(queue_fifo_remove(&cp->queue))->u.rdymsg = MSG_RESET;
+    cond_release(cp, CH_FLAG_BROADCAST);
   }
 }
 
@@ -213,15 +249,18 @@ msg_t chCondWaitS(condition_variable_t *cp) {
 
   /* Getting "current" mutex and releasing it.*/
   mp = chMtxGetNextMutexS();
+  chDbgAssert(queue_isempty(&cp->queue) || (cp->mtx == mp),
+              "different mutex");
   chMtxUnlockS(mp);
 
-  /* Start waiting on the condition variable, on exit the mutex is taken
-     again.*/
+  /* Start waiting on the condition variable, on exit the mutex has already
+     been taken again on behalf of this thread.*/
+  cp->mtx = mp;
   ctp->u.wtobjp = cp;
   queue_prio_insert(ctp, &cp->queue);
   chSchGoSleepS(CH_STATE_WTCOND);
-  msg = ctp->u.rdymsg;
-  chMtxLockS(mp);
+  chDbgAssert(mp->owner == ctp, "not owner");
+  msg = cond_msg(ctp);
 
   return msg;
 }
@@ -296,6 +335,9 @@ msg_t chCondWaitTimeout(condition_variable_t *cp, systime_t time) {
 msg_t chCondWaitTimeoutS(condition_variable_t *cp, systime_t time) {
   mutex_t *mp;
   msg_t msg;
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  bool kept;
+#endif
 
   chDbgCheckClassS();
   chDbgCheck((cp != NULL) && (time != TIME_IMMEDIATE));
@@ -303,16 +345,33 @@ msg_t chCondWaitTimeoutS(condition_variable_t *cp, systime_t time) {
 
   /* Getting "current" mutex and releasing it.*/
   mp = chMtxGetNextMutexS();
+  chDbgAssert(queue_isempty(&cp->queue) || (cp->mtx == mp),
+              "different mutex");
   chMtxUnlockS(mp);
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  kept = (bool)(mp->owner == currp);
+#endif
 
-  /* Start waiting on the condition variable, on exit the mutex is taken
-     again.*/
+  /* Start waiting on the condition variable, on exit the mutex has already
+     been taken again on behalf of this thread unless a timeout occurred.*/
+  cp->mtx = mp;
   currp->u.wtobjp = cp;
   queue_prio_insert(currp, &cp->queue);
   msg = chSchGoSleepTimeoutS(CH_STATE_WTCOND, time);
-  if (msg != MSG_TIMEOUT) {
-    chMtxLockS(mp);
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  /* A recursively locked mutex is still owned, the wakeup message tells
+     the timeout apart.*/
+  if (kept) {
+    if (msg == MSG_TIMEOUT) {
+      return MSG_TIMEOUT;
+    }
+    return cond_msg(currp);
+  }
+#endif
+  if (mp->owner != currp) {
+    return MSG_TIMEOUT;
   }
+  msg = cond_msg(currp);
 
   return msg;
 }
@@ -23,6 +23,15 @@
  *
  * @addtogroup dynamic_threads
  * @details Dynamic threads related APIs and services.
+ *          <h2>Working areas cache</h2>
+ *          When the option @p CH_CFG_USE_WA_CACHE is enabled the working
+ *          areas of threads created from the default heap are not returned
+ *          to the heap on release but kept in a cache, the next thread
+ *          requiring a working area of the same size reuses one in constant
+ *          time instead of walking the heap. The cache is organized in
+ *          @p CH_CFG_WA_CACHE_CLASSES size classes assigned on first use,
+ *          each one holding up to @p CH_CFG_WA_CACHE_DEPTH free working
+ *          areas.
  * @{
  */
 
@@ -42,14 +51,104 @@
 /* Module local types.                                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_WA_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Working areas cache class.
+ */
+typedef struct {
+  wa_cache_stats_t      stats;      /**< @brief Class statistics.           */
+  void                  *free;      /**< @brief Cached working areas list,
+                                                linked through the first
+                                                word of each area.          */
+} wa_cache_class_t;
+#endif
+
 /*===========================================================================*/
 /* Module local variables.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_WA_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Working areas cache classes.
+ */
+static wa_cache_class_t wa_cache[CH_CFG_WA_CACHE_CLASSES];
+#endif
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_WA_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the cache class associated to a working area size.
+ *
+ * @param[in] size      the working area size
+ * @param[in] assign    if @p true then an unused class is assigned to the
+ *                      size if there is no class for it
+ * @return              The pointer to the class.
+ * @retval NULL         if there is no class for the specified size.
+ *
+ * @notapi
+ */
+static wa_cache_class_t *wa_cache_get_class(size_t size, bool assign) {
+  wa_cache_class_t *unused = NULL;
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_WA_CACHE_CLASSES; i++) {
+    if (wa_cache[i].stats.size == size) {
+      return &wa_cache[i];
+    }
+    if ((unused == NULL) && (wa_cache[i].stats.size == 0U)) {
+      unused = &wa_cache[i];
+    }
+  }
+
+  if (assign && (unused != NULL)) {
+    unused->stats.size = size;
+    return unused;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Allocates a working area from the cache.
+ * @details If the cache has no working areas of the specified size then
+ *          the default heap is used.
+ *
+ * @param[in] size      the working area size
+ * @return              The pointer to the working area.
+ * @retval NULL         if the memory cannot be allocated.
+ *
+ * @notapi
+ */
+static void *wa_cache_alloc(size_t size) {
+  wa_cache_class_t *wccp;
+  void *wsp = NULL;
+
+  chSysLock();
+  wccp = wa_cache_get_class(size, true);
+  if (wccp != NULL) {
+    wsp = wccp->free;
+    if (wsp != NULL) {
+      wccp->free = *(void **)wsp;
+      wccp->stats.n_cached--;
+      wccp->stats.n_reused++;
+    }
+    else {
+      wccp->stats.n_allocated++;
+    }
+  }
+  chSysUnlock();
+
+  if (wsp == NULL) {
+    wsp = chHeapAllocAligned(NULL, size, PORT_WORKING_AREA_ALIGN);
+  }
+
+  return wsp;
+}
+#endif /* CH_CFG_USE_WA_CACHE == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -64,6 +163,8 @@
  * @note    The memory allocated for the thread is not released automatically,
  *          it is responsibility of the creator thread to call @p chThdWait()
  *          and then release the allocated memory.
+ * @note    If @p CH_CFG_USE_WA_CACHE is enabled and @p heapp is @p NULL then
+ *          the working area is taken from the working areas cache.
  *
  * @param[in] heapp     heap from which allocate the memory or @p NULL for the
  *                      default heap
@@ -83,9 +184,23 @@ thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
                               const char *name, tprio_t prio,
                               tfunc_t pf, void *arg) {
   thread_t *tp;
+  tmode_t mode;
   void *wsp;
 
-  wsp = chHeapAllocAligned(heapp, size, PORT_WORKING_AREA_ALIGN);
+#if CH_CFG_USE_WA_CACHE == TRUE
+  /* Working areas from the default heap go through the cache.*/
+  if (heapp == NULL) {
+    wsp  = wa_cache_alloc(size);
+    mode = CH_FLAG_MODE_CACHE;
+  }
+  else {
+    wsp  = chHeapAllocAligned(heapp, size, PORT_WORKING_AREA_ALIGN);
+    mode = CH_FLAG_MODE_HEAP;
+  }
+#else
+  wsp  = chHeapAllocAligned(heapp, size, PORT_WORKING_AREA_ALIGN);
+  mode = CH_FLAG_MODE_HEAP;
+#endif
   if (wsp == NULL) {
     return NULL;
   }
@@ -107,7 +222,7 @@ thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
 
   chSysLock();
   tp = chThdCreateSuspendedI(&td);
-  tp->flags = CH_FLAG_MODE_HEAP;
+  tp->flags = mode;
   chSchWakeupS(tp, MSG_OK);
   chSysUnlock();
 
@@ -181,6 +296,91 @@ thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
 }
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
+#if (CH_CFG_USE_WA_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Releases a working area to the cache.
+ * @details If the size class is full then the working area is returned
+ *          to the heap.
+ *
+ * @param[in] wsp       pointer to the working area
+ *
+ * @notapi
+ */
+void _thread_cache_free(void *wsp) {
+  wa_cache_class_t *wccp;
+
+  chSysLock();
+  wccp = wa_cache_get_class(chHeapGetSize(wsp), false);
+  if (wccp != NULL) {
+    if (wccp->stats.n_cached < (ucnt_t)CH_CFG_WA_CACHE_DEPTH) {
+      *(void **)wsp = wccp->free;
+      wccp->free = wsp;
+      wccp->stats.n_cached++;
+      chSysUnlock();
+      return;
+    }
+    wccp->stats.n_dropped++;
+  }
+  chSysUnlock();
+
+  chHeapFree(wsp);
+}
+
+/**
+ * @brief   Returns all the cached working areas to the heap.
+ * @note    Size classes and statistics are not affected.
+ *
+ * @api
+ */
+void chThdCacheFlush(void) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_WA_CACHE_CLASSES; i++) {
+    void *wsp;
+
+    chSysLock();
+    wsp = wa_cache[i].free;
+    wa_cache[i].free = NULL;
+    wa_cache[i].stats.n_cached = (ucnt_t)0;
+    chSysUnlock();
+
+    while (wsp != NULL) {
+      void *next = *(void **)wsp;
+
+      chHeapFree(wsp);
+      wsp = next;
+    }
+  }
+}
+
+/**
+ * @brief   Returns the statistics of a working areas cache class.
+ *
+ * @param[in] n         the class index, from zero to
+ *                      @p CH_CFG_WA_CACHE_CLASSES minus one
+ * @param[out] wcsp     pointer to a @p wa_cache_stats_t structure
+ * @return              The class state.
+ * @retval false        if the class is unused or the index is out of range.
+ * @retval true         if the class is assigned to a size.
+ *
+ * @api
+ */
+bool chThdCacheGetStats(unsigned n, wa_cache_stats_t *wcsp) {
+
+  chDbgCheck(wcsp != NULL);
+
+  if (n >= (unsigned)CH_CFG_WA_CACHE_CLASSES) {
+    return false;
+  }
+
+  chSysLock();
+  *wcsp = wa_cache[n].stats;
+  chSysUnlock();
+
+  return (bool)(wcsp->size > 0U);
+}
+#endif /* CH_CFG_USE_WA_CACHE == TRUE */
+
 #endif /* CH_CFG_USE_DYNAMIC == TRUE */
 
 /** @} */
@@ -81,6 +81,26 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Checks if a thread would be awakened by a set of pending events.
+ *
+ * @param[in] tp        the thread to be checked
+ * @param[in] pending   the pending events mask to be evaluated
+ * @return              The check result.
+ * @retval false        if the thread is not waiting for those events.
+ * @retval true         if the thread wait condition is satisfied.
+ *
+ * @notapi
+ */
+static bool evt_wakes(const thread_t *tp, eventmask_t pending) {
+
+  /* Test on the AND/OR conditions wait states.*/
+  return ((tp->state == CH_STATE_WTOREVT) &&
+          ((pending & tp->u.ewmask) != (eventmask_t)0)) ||
+         ((tp->state == CH_STATE_WTANDEVT) &&
+          ((pending & tp->u.ewmask) == tp->u.ewmask));
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -285,11 +305,7 @@ void chEvtSignalI(thread_t *tp, eventmask_t events) {
   chDbgCheck(tp != NULL);
 
   tp->epending |= events;
-  /* Test on the AND/OR conditions wait states.*/
-  if (((tp->state == CH_STATE_WTOREVT) &&
-       ((tp->epending & tp->u.ewmask) != (eventmask_t)0)) ||
-      ((tp->state == CH_STATE_WTANDEVT) &&
-       ((tp->epending & tp->u.ewmask) == tp->u.ewmask))) {
+  if (evt_wakes(tp, tp->epending)) {
     tp->u.rdymsg = MSG_OK;
     (void) chSchReadyI(tp);
   }
@@ -316,6 +332,159 @@ void chEvtBroadcastFlags(event_source_t *esp, eventflags_t flags) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Signals the Event Listeners registered on the specified Event
+ *          Source using the specified broadcast mode.
+ * @details See @p chEvtBroadcastFlagsModeI().
+ *
+ * @param[in] esp       pointer to the @p event_source_t structure
+ * @param[in] flags     the flags set to be added to the listener flags mask
+ * @param[in] mode      the broadcast mode, a combination of:
+ *                      - @a EVT_BCAST_HIGHEST
+ *                      - @a EVT_BCAST_COALESCE
+ *                      .
+ *                      or @a EVT_BCAST_ALL.
+ * @return              The number of threads made ready.
+ *
+ * @api
+ */
+cnt_t chEvtBroadcastFlagsMode(event_source_t *esp,
+                              eventflags_t flags,
+                              evtbmode_t mode) {
+  cnt_t n;
+
+  chSysLock();
+  n = chEvtBroadcastFlagsModeI(esp, flags, mode);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Signals the Event Listeners registered on the specified Event
+ *          Source using the specified broadcast mode.
+ * @details This is an alternative to @p chEvtBroadcastFlagsI() meant for
+ *          sources with many listeners. The threads to be awakened are
+ *          first collected in a local priority ordered list then they are
+ *          moved into the ready list in a single pass, the ready list is no
+ *          more scanned once for each awakened thread. The resulting scheduling
+ *          order is the same.<br>
+ *          The following modes can be combined:
+ *          - @a EVT_BCAST_HIGHEST, only the eligible listener owned by
+ *            the highest priority thread is signaled, listeners whose
+ *            thread is actually waiting for the events are preferred. The
+ *            other listeners are not touched, not even their flags.
+ *          - @a EVT_BCAST_COALESCE, listeners whose events are all already
+ *            pending in their thread only accumulate the flags, no signal
+ *            is performed.
+ *          .
+ *          When @p CH_DBG_STATISTICS is enabled the duration of each
+ *          broadcast is accumulated in the kernel statistics.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] esp       pointer to the @p event_source_t structure
+ * @param[in] flags     the flags set to be added to the listener flags mask
+ * @param[in] mode      the broadcast mode, a combination of:
+ *                      - @a EVT_BCAST_HIGHEST
+ *                      - @a EVT_BCAST_COALESCE
+ *                      .
+ *                      or @a EVT_BCAST_ALL.
+ * @return              The number of threads made ready.
+ *
+ * @iclass
+ */
+cnt_t chEvtBroadcastFlagsModeI(event_source_t *esp,
+                               eventflags_t flags,
+                               evtbmode_t mode) {
+  thread_t *rlp = NULL;
+  event_listener_t *elp, *hlp = NULL;
+  bool hwakes = false;
+  cnt_t n = (cnt_t)0;
+
+  chDbgCheckClassI();
+  chDbgCheck(esp != NULL);
+
+#if CH_DBG_STATISTICS == TRUE
+  chTMStartMeasurementX(&ch.kernel_stats.m_evt_bcast);
+#endif
+
+  elp = esp->next;
+  /*lint -save -e9087 -e740 [11.3, 1.3] Cast required by list handling.*/
+  while (elp != (event_listener_t *)esp) {
+  /*lint -restore*/
+    thread_t *tp = elp->listener;
+
+    /* Same filtering of chEvtBroadcastFlagsI(), when flags == 0 the
+       listener is always eligible.*/
+    if ((flags == (eventflags_t)0) ||
+        (((elp->flags | flags) & elp->wflags) != (eventflags_t)0)) {
+      if (((mode & EVT_BCAST_COALESCE) != (evtbmode_t)0) &&
+          ((tp->epending & elp->events) == elp->events)) {
+        /* Already pending, nothing else to do for this listener.*/
+        elp->flags |= flags;
+      }
+      else if ((mode & EVT_BCAST_HIGHEST) != (evtbmode_t)0) {
+        bool wakes = evt_wakes(tp, tp->epending | elp->events);
+
+        /* Selection only, the chosen listener is signaled at the end.*/
+        if ((hlp == NULL) || (wakes && !hwakes) ||
+            ((wakes == hwakes) && (tp->prio > hlp->listener->prio))) {
+          hlp    = elp;
+          hwakes = wakes;
+        }
+      }
+      else {
+        elp->flags   |= flags;
+        tp->epending |= elp->events;
+        if (evt_wakes(tp, tp->epending)) {
+          /* Marked as ready immediately so that other listeners of the
+             same thread cannot queue it twice.*/
+          thread_t **tpp = &rlp;
+
+          tp->u.rdymsg = MSG_OK;
+          tp->state    = CH_STATE_READY;
+
+          /* Collected in priority order, FIFO among equal priorities.*/
+          while ((*tpp != NULL) && ((*tpp)->prio >= tp->prio)) {
+            tpp = &(*tpp)->queue.next;
+          }
+          tp->queue.next = *tpp;
+          *tpp           = tp;
+          n++;
+        }
+      }
+    }
+    else {
+      elp->flags |= flags;
+    }
+    elp = elp->next;
+  }
+
+  if (hlp != NULL) {
+    hlp->flags |= flags;
+    if (hwakes) {
+      n++;
+    }
+    chEvtSignalI(hlp->listener, hlp->events);
+  }
+  else if (rlp != NULL) {
+    chSchReadyListI(rlp);
+  }
+  else {
+    /* Nothing to wake.*/
+  }
+
+#if CH_DBG_STATISTICS == TRUE
+  chTMStopMeasurementX(&ch.kernel_stats.m_evt_bcast);
+#endif
+
+  return n;
+}
+
 /**
  * @brief   Returns the flags associated to an @p event_listener_t.
  * @details The flags are returned and the @p event_listener_t flags mask is
@@ -62,6 +62,25 @@
  *          The mechanism works with any number of nested mutexes and any
  *          number of involved threads. The algorithm complexity (worst case)
  *          is N with N equal to the number of nested mutexes.
+ *
+ *          <h2>Priority ceiling</h2>
+ *          When the option @p CH_CFG_USE_MUTEXES_CEILING is enabled a mutex
+ *          can be initialized with a ceiling priority using
+ *          @p chMtxObjectInitCeiling(), the locking thread is immediately
+ *          raised to the ceiling (immediate priority ceiling protocol).
+ *          If the ceiling is not lower than the priority of any thread
+ *          using the mutex then, on a single core, the mutex is always
+ *          found unlocked unless the owner sleeps while holding it, the
+ *          lock path does not walk any inheritance chain and chained
+ *          blocking cannot happen. If contention happens anyway then the
+ *          priority inheritance mechanism still applies.
+ *
+ *          <h2>Contention statistics</h2>
+ *          When the option @p CH_DBG_STATISTICS is enabled each mutex counts
+ *          its acquisitions, the acquisitions that required the caller to
+ *          wait and the cumulative waiting time in realtime counter cycles.
+ *          Mutexes can be registered by name in order to make their
+ *          statistics reachable by inspection tools like the shell.
  * @pre     In order to use the mutex APIs the @p CH_CFG_USE_MUTEXES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling mutexes requires 5-12 (depending on the architecture)
@@ -89,6 +108,65 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Recalculates the priority of a mutexes owner.
+ * @details The result is the highest among the thread base priority, the
+ *          priority of the threads waiting on the owned mutexes and the
+ *          ceiling of the owned mutexes.
+ *
+ * @param[in] ctp       pointer to the owner thread
+ * @return              The optimal thread priority.
+ */
+static tprio_t mtx_owner_prio(thread_t *ctp) {
+  tprio_t newprio = ctp->realprio;
+  mutex_t *lmp = ctp->mtxlist;
+
+  while (lmp != NULL) {
+    /* If the highest priority thread waiting in the mutexes list has a
+       greater priority than the current thread base priority then the
+       final priority will have at least that priority.*/
+    if (chMtxQueueNotEmptyS(lmp) &&
+        (lmp->queue.next->prio > newprio)) {
+      newprio = lmp->queue.next->prio;
+    }
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+    /* Same for the ceilings of the mutexes still owned.*/
+    if (lmp->ceiling > newprio) {
+      newprio = lmp->ceiling;
+    }
+#endif
+    lmp = lmp->next;
+  }
+
+  return newprio;
+}
+
+/**
+ * @brief   Passes a mutex to the highest priority waiting thread.
+ * @details The thread becomes the new owner and is made ready.
+ * @pre     The mutex queue must not be empty.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ */
+static void mtx_pass(mutex_t *mp) {
+  thread_t *tp = queue_fifo_remove(&mp->queue);
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  mp->cnt = (cnt_t)1;
+#endif
+  mp->owner = tp;
+  mp->next = tp->mtxlist;
+  tp->mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  /* Threads moved on the mutex by a condition variable do not return into
+     chMtxLockS(), the ceiling is applied here.*/
+  if (tp->prio < mp->ceiling) {
+    tp->prio = mp->ceiling;
+  }
+#endif
+  (void) chSchReadyI(tp);
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -109,7 +187,37 @@ void chMtxObjectInit(mutex_t *mp) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   mp->cnt = (cnt_t)0;
 #endif
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  mp->ceiling = NOPRIO;
+#endif
+#if CH_DBG_STATISTICS == TRUE
+  mp->stats.n_lock      = (ucnt_t)0;
+  mp->stats.n_contended = (ucnt_t)0;
+  mp->stats.wait        = (rttime_t)0;
+  mp->stats.name        = NULL;
+  mp->stats.next        = NULL;
+#endif
+}
+
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes s @p mutex_t structure with a priority ceiling.
+ * @note    The ceiling must be greater or equal to the priority of all the
+ *          threads locking the mutex.
+ *
+ * @param[out] mp       pointer to a @p mutex_t structure
+ * @param[in] ceiling   the ceiling priority
+ *
+ * @init
+ */
+void chMtxObjectInitCeiling(mutex_t *mp, tprio_t ceiling) {
+
+  chDbgCheck((ceiling > IDLEPRIO) && (ceiling <= HIGHPRIO));
+
+  chMtxObjectInit(mp);
+  mp->ceiling = ceiling;
 }
+#endif
 
 /**
  * @brief   Locks the specified mutex.
@@ -138,10 +246,17 @@ void chMtxLock(mutex_t *mp) {
  */
 void chMtxLockS(mutex_t *mp) {
   thread_t *ctp = currp;
+#if CH_DBG_STATISTICS == TRUE
+  rtcnt_t start;
+#endif
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
 
+#if CH_DBG_STATISTICS == TRUE
+  mp->stats.n_lock++;
+#endif
+
   /* Is the mutex already locked? */
   if (mp->owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -155,64 +270,23 @@ void chMtxLockS(mutex_t *mp) {
     }
     else {
 #endif
-      /* Priority inheritance protocol; explores the thread-mutex dependencies
-         boosting the priority of all the affected threads to equal the
-         priority of the running thread requesting the mutex.*/
-      thread_t *tp = mp->owner;
-
-      /* Does the running thread have higher priority than the mutex
-         owning thread? */
-      while (tp->prio < ctp->prio) {
-        /* Make priority of thread tp match the running thread's priority.*/
-        tp->prio = ctp->prio;
-
-        /* The following states need priority queues reordering.*/
-        switch (tp->state) {
-        case CH_STATE_WTMTX:
-          /* Re-enqueues the mutex owner with its new priority.*/
-          queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
-          tp = tp->u.wtmtxp->owner;
-          /*lint -e{9042} [16.1] Continues the while.*/
-          continue;
-#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
-    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
-     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
-    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
-     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
-#if CH_CFG_USE_CONDVARS == TRUE
-        case CH_STATE_WTCOND:
-#endif
-#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
-    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
-        case CH_STATE_WTSEM:
-#endif
-#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
-        case CH_STATE_SNDMSGQ:
-#endif
-          /* Re-enqueues tp with its new priority on the queue.*/
-          queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
-          break;
+      /* Priority inheritance protocol.*/
+      _mtx_boost(mp->owner, ctp->prio);
+
+#if CH_DBG_STATISTICS == TRUE
+      mp->stats.n_contended++;
+      start = chSysGetRealtimeCounterX();
 #endif
-        case CH_STATE_READY:
-#if CH_DBG_ENABLE_ASSERTS == TRUE
-          /* Prevents an assertion in chSchReadyI().*/
-          tp->state = CH_STATE_CURRENT;
-#endif
-          /* Re-enqueues tp with its new priority on the ready list.*/
-          (void) chSchReadyI(queue_dequeue(tp));
-          break;
-        default:
-          /* Nothing to do for other states.*/
-          break;
-        }
-        break;
-      }
 
       /* Sleep on the mutex.*/
       queue_prio_insert(ctp, &mp->queue);
       ctp->u.wtmtxp = mp;
       chSchGoSleepS(CH_STATE_WTMTX);
 
+#if CH_DBG_STATISTICS == TRUE
+      mp->stats.wait += (rttime_t)(chSysGetRealtimeCounterX() - start);
+#endif
+
       /* It is assumed that the thread performing the unlock operation assigns
          the mutex to this thread.*/
       chDbgAssert(mp->owner == ctp, "not owner");
@@ -233,6 +307,16 @@ void chMtxLockS(mutex_t *mp) {
     mp->next = ctp->mtxlist;
     ctp->mtxlist = mp;
   }
+
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  /* Immediate priority ceiling, the owner is raised to the ceiling so no
+     other user of the mutex can preempt it while it is held.*/
+  chDbgAssert((mp->ceiling == NOPRIO) || (ctp->realprio <= mp->ceiling),
+              "ceiling violation");
+  if (ctp->prio < mp->ceiling) {
+    ctp->prio = mp->ceiling;
+  }
+#endif
 }
 
 /**
@@ -291,6 +375,9 @@ bool chMtxTryLockS(mutex_t *mp) {
 
     if (mp->owner == currp) {
       mp->cnt++;
+#if CH_DBG_STATISTICS == TRUE
+      mp->stats.n_lock++;
+#endif
       return true;
     }
 #endif
@@ -301,10 +388,20 @@ bool chMtxTryLockS(mutex_t *mp) {
   chDbgAssert(mp->cnt == (cnt_t)0, "counter is not zero");
 
   mp->cnt++;
+#endif
+#if CH_DBG_STATISTICS == TRUE
+  mp->stats.n_lock++;
 #endif
   mp->owner = currp;
   mp->next = currp->mtxlist;
   currp->mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  chDbgAssert((mp->ceiling == NOPRIO) || (currp->realprio <= mp->ceiling),
+              "ceiling violation");
+  if (currp->prio < mp->ceiling) {
+    currp->prio = mp->ceiling;
+  }
+#endif
   return true;
 }
 
@@ -322,7 +419,6 @@ bool chMtxTryLockS(mutex_t *mp) {
  */
 void chMtxUnlock(mutex_t *mp) {
   thread_t *ctp = currp;
-  mutex_t *lmp;
 
   chDbgCheck(mp != NULL);
 
@@ -345,46 +441,30 @@ void chMtxUnlock(mutex_t *mp) {
 
     /* If a thread is waiting on the mutex then the fun part begins.*/
     if (chMtxQueueNotEmptyS(mp)) {
-      thread_t *tp;
-
-      /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = ctp->realprio;
-      lmp = ctp->mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) &&
-            (lmp->queue.next->prio > newprio)) {
-          newprio = lmp->queue.next->prio;
-        }
-        lmp = lmp->next;
-      }
 
       /* Assigns to the current thread the highest priority among all the
          waiting threads.*/
-      ctp->prio = newprio;
+      ctp->prio = mtx_owner_prio(ctp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
-         assigns the mutex to it.*/
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-      mp->cnt = (cnt_t)1;
-#endif
-      tp = queue_fifo_remove(&mp->queue);
-      mp->owner = tp;
-      mp->next = tp->mtxlist;
-      tp->mtxlist = mp;
-
-      /* Note, not using chSchWakeupS() becuase that function expects the
+         assigns the mutex to it.
+         Note, not using chSchWakeupS() becuase that function expects the
          current thread to have the higher or equal priority than the ones
          in the ready list. This is not necessarily true here because we
          just changed priority.*/
-      (void) chSchReadyI(tp);
+      mtx_pass(mp);
       chSchRescheduleS();
     }
     else {
       mp->owner = NULL;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+      /* Leaving the ceiling, other owned mutexes could still require an
+         higher priority than the base one.*/
+      if (mp->ceiling != NOPRIO) {
+        ctp->prio = mtx_owner_prio(ctp);
+        chSchRescheduleS();
+      }
+#endif
     }
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   }
@@ -409,7 +489,6 @@ void chMtxUnlock(mutex_t *mp) {
  */
 void chMtxUnlockS(mutex_t *mp) {
   thread_t *ctp = currp;
-  mutex_t *lmp;
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
@@ -431,40 +510,24 @@ void chMtxUnlockS(mutex_t *mp) {
 
     /* If a thread is waiting on the mutex then the fun part begins.*/
     if (chMtxQueueNotEmptyS(mp)) {
-      thread_t *tp;
-
-      /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = ctp->realprio;
-      lmp = ctp->mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) &&
-            (lmp->queue.next->prio > newprio)) {
-          newprio = lmp->queue.next->prio;
-        }
-        lmp = lmp->next;
-      }
 
       /* Assigns to the current thread the highest priority among all the
          waiting threads.*/
-      ctp->prio = newprio;
+      ctp->prio = mtx_owner_prio(ctp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-      mp->cnt = (cnt_t)1;
-#endif
-      tp = queue_fifo_remove(&mp->queue);
-      mp->owner = tp;
-      mp->next = tp->mtxlist;
-      tp->mtxlist = mp;
-      (void) chSchReadyI(tp);
+      mtx_pass(mp);
     }
     else {
       mp->owner = NULL;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+      /* Leaving the ceiling, other owned mutexes could still require an
+         higher priority than the base one.*/
+      if (mp->ceiling != NOPRIO) {
+        ctp->prio = mtx_owner_prio(ctp);
+      }
+#endif
     }
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   }
@@ -491,14 +554,7 @@ void chMtxUnlockAllS(void) {
     mutex_t *mp = ctp->mtxlist;
     ctp->mtxlist = mp->next;
     if (chMtxQueueNotEmptyS(mp)) {
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-      mp->cnt = (cnt_t)1;
-#endif
-      thread_t *tp = queue_fifo_remove(&mp->queue);
-      mp->owner = tp;
-      mp->next = tp->mtxlist;
-      tp->mtxlist = mp;
-      (void) chSchReadyI(tp);
+      mtx_pass(mp);
     }
     else {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -530,14 +586,7 @@ void chMtxUnlockAll(void) {
       mutex_t *mp = ctp->mtxlist;
       ctp->mtxlist = mp->next;
       if (chMtxQueueNotEmptyS(mp)) {
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-        mp->cnt = (cnt_t)1;
-#endif
-        thread_t *tp = queue_fifo_remove(&mp->queue);
-        mp->owner = tp;
-        mp->next = tp->mtxlist;
-        tp->mtxlist = mp;
-        (void) chSchReadyI(tp);
+        mtx_pass(mp);
       }
       else {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -552,6 +601,191 @@ void chMtxUnlockAll(void) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Priority inheritance protocol.
+ * @details Explores the thread-mutex dependencies boosting the priority of
+ *          all the affected threads to equal the priority of the thread
+ *          requesting the mutex.
+ *
+ * @param[in] tp        pointer to the mutex owner thread
+ * @param[in] prio      priority of the thread requesting the mutex
+ *
+ * @notapi
+ */
+void _mtx_boost(thread_t *tp, tprio_t prio) {
+
+  while (tp->prio < prio) {
+    /* Make priority of thread tp match the requesting thread's priority.*/
+    tp->prio = prio;
+
+    /* The following states need priority queues reordering.*/
+    switch (tp->state) {
+    case CH_STATE_WTMTX:
+      /* Re-enqueues the mutex owner with its new priority.*/
+      queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
+      tp = tp->u.wtmtxp->owner;
+      /*lint -e{9042} [16.1] Continues the while.*/
+      continue;
+#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
+    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
+     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
+    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
+     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
+#if CH_CFG_USE_CONDVARS == TRUE
+    case CH_STATE_WTCOND:
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
+    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
+    case CH_STATE_WTSEM:
+#endif
+#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
+    case CH_STATE_SNDMSGQ:
+#endif
+      /* Re-enqueues tp with its new priority on the queue.*/
+      queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      (void) chSchReadyI(queue_dequeue(tp));
+      break;
+    default:
+      /* Nothing to do for other states.*/
+      break;
+    }
+    break;
+  }
+}
+
+#if (CH_CFG_USE_CONDVARS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Locks a mutex on behalf of a sleeping thread.
+ * @details If the mutex is not owned then the thread becomes its owner and
+ *          is made ready, else the thread is queued on the mutex exactly as
+ *          if it had invoked @p chMtxLockS(), priority inheritance included.
+ *          Condition variables use this function in order to move signaled
+ *          threads directly on the mutex queue (wait morphing), only the
+ *          thread getting the mutex is made ready.
+ * @pre     The thread must be sleeping and not enqueued on any object.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void _mtx_handoff(mutex_t *mp, thread_t *tp) {
+
+#if CH_DBG_STATISTICS == TRUE
+  mp->stats.n_lock++;
+#endif
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  /* The thread kept the ownership of a recursively locked mutex while
+     waiting, restoring the counter is enough.*/
+  if (mp->owner == tp) {
+    mp->cnt++;
+    tp->u.rdymsg = MSG_OK;
+    (void) chSchReadyI(tp);
+    return;
+  }
+#endif
+
+  if (mp->owner != NULL) {
+    chDbgAssert(mp->owner != tp, "already owner");
+
+#if CH_DBG_STATISTICS == TRUE
+    mp->stats.n_contended++;
+#endif
+
+    /* Priority inheritance protocol.*/
+    _mtx_boost(mp->owner, tp->prio);
+
+    /* The thread will be awakened by the unlocking thread.*/
+    queue_prio_insert(tp, &mp->queue);
+    tp->u.wtmtxp = mp;
+    tp->state = CH_STATE_WTMTX;
+  }
+  else {
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+    chDbgAssert(mp->cnt == (cnt_t)0, "counter is not zero");
+
+    mp->cnt++;
+#endif
+    mp->owner = tp;
+    mp->next = tp->mtxlist;
+    tp->mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+    if (tp->prio < mp->ceiling) {
+      tp->prio = mp->ceiling;
+    }
+#endif
+    tp->u.rdymsg = MSG_OK;
+    (void) chSchReadyI(tp);
+  }
+}
+#endif /* CH_CFG_USE_CONDVARS == TRUE */
+
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Registers a mutex for statistics inspection.
+ * @details The mutex is inserted in the list of the registered mutexes
+ *          under the specified name, the list can be scanned using
+ *          @p chMtxStatsFirstI() and @p chMtxStatsNextI().
+ * @pre     This function is only available when the @p CH_DBG_STATISTICS
+ *          debug option is enabled.
+ * @note    A registered mutex must be unregistered before going out of
+ *          scope or being re-initialized.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] name      name to be associated to the mutex
+ *
+ * @api
+ */
+void chMtxStatsRegister(mutex_t *mp, const char *name) {
+
+  chDbgCheck((mp != NULL) && (name != NULL));
+
+  chSysLock();
+  chDbgAssert(mp->stats.name == NULL, "already registered");
+  mp->stats.name = name;
+  mp->stats.next = ch.kernel_stats.mtxlist;
+  ch.kernel_stats.mtxlist = mp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Removes a mutex from the statistics list.
+ * @pre     This function is only available when the @p CH_DBG_STATISTICS
+ *          debug option is enabled.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ *
+ * @api
+ */
+void chMtxStatsUnregister(mutex_t *mp) {
+  mutex_t **mpp;
+
+  chDbgCheck(mp != NULL);
+
+  chSysLock();
+  mpp = &ch.kernel_stats.mtxlist;
+  while (*mpp != NULL) {
+    if (*mpp == mp) {
+      *mpp = mp->stats.next;
+      break;
+    }
+    mpp = &(*mpp)->stats.next;
+  }
+  mp->stats.name = NULL;
+  mp->stats.next = NULL;
+  chSysUnlock();
+}
+#endif /* CH_DBG_STATISTICS == TRUE */
+
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
 /** @} */
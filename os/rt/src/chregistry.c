@@ -39,7 +39,13 @@
  *          Another possible use is for centralized threads memory management,
  *          terminating threads can pulse an event source and an event handler
  *          can perform a scansion of the registry in order to recover the
- *          memory.
+ *          memory.<br>
+ *          Monitoring code should prefer @p chRegGetSnapshot(), it copies
+ *          the state of all threads within a single critical zone instead
+ *          of locking the kernel and updating references at each step.
+ *          If @p CH_CFG_REGISTRY_HASH_SIZE is greater than zero then the
+ *          threads names are also kept in an hash index and lookups by
+ *          name do not need to scan the registry.
  * @pre     In order to use the threads registry the @p CH_CFG_USE_REGISTRY
  *          option must be enabled in @p chconf.h.
  * @{
@@ -73,6 +79,25 @@
   ((size_t)((char *)&((st *)0)->m - (char *)0))                             \
   /*lint -restore*/
 
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the hash bucket associated to a name.
+ *
+ * @param[in] name      the thread name
+ * @return              Pointer to the hash bucket.
+ */
+static thread_t **reg_hash_bucket(const char *name) {
+  uint32_t h = 5381U;
+
+  while (*name != '\0') {
+    h = (h * 33U) ^ (uint32_t)(uint8_t)*name;
+    name++;
+  }
+
+  return &ch.reghash[h & ((uint32_t)CH_CFG_REGISTRY_HASH_SIZE - 1U)];
+}
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -194,6 +219,26 @@ thread_t *chRegNextThread(thread_t *tp) {
 thread_t *chRegFindThreadByName(const char *name) {
   thread_t *ctp;
 
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  chDbgCheck(name != NULL);
+
+  /* Scanning the hash bucket only.*/
+  chSysLock();
+  ctp = *reg_hash_bucket(name);
+  while (ctp != NULL) {
+    if (strcmp(ctp->name, name) == 0) {
+#if CH_CFG_USE_DYNAMIC == TRUE
+      chDbgAssert(ctp->refs < (trefs_t)255, "too many references");
+      ctp->refs++;
+#endif
+      break;
+    }
+    ctp = ctp->hashnext;
+  }
+  chSysUnlock();
+
+  return ctp;
+#else
   /* Scanning registry.*/
   ctp = chRegFirstThread();
   do {
@@ -204,6 +249,7 @@ thread_t *chRegFindThreadByName(const char *name) {
   } while (ctp != NULL);
 
   return NULL;
+#endif
 }
 
 /**
@@ -263,6 +309,153 @@ thread_t *chRegFindThreadByWorkingArea(stkalign_t *wa) {
 }
 #endif
 
+/**
+ * @brief   Takes a snapshot of the registry.
+ * @details The state of the threads in the registry is copied, in creation
+ *          order, into the specified array within a single critical zone.
+ *          No references are taken on the threads so the copy is consistent
+ *          but the threads can terminate right after it has been taken.
+ *
+ * @param[out] snp      pointer to an array of @p thread_snapshot_t
+ * @param[in] n         number of elements in the array
+ * @return              The number of threads in the registry, if it is
+ *                      greater than @p n then only the first @p n threads
+ *                      have been copied.
+ *
+ * @api
+ */
+cnt_t chRegGetSnapshot(thread_snapshot_t *snp, cnt_t n) {
+  thread_t *tp;
+  cnt_t i = (cnt_t)0;
+
+  chDbgCheck((snp != NULL) || (n == (cnt_t)0));
+
+  chSysLock();
+  tp = ch.rlist.newer;
+  /*lint -save -e9087 -e740 [11.3, 1.3] Cast required by list handling.*/
+  while (tp != (thread_t *)&ch.rlist) {
+  /*lint -restore*/
+    if (i < n) {
+      snp->tp       = tp;
+      snp->name     = tp->name;
+      snp->prio     = tp->prio;
+#if CH_CFG_USE_MUTEXES == TRUE
+      snp->realprio = tp->realprio;
+#endif
+      snp->state    = tp->state;
+      snp->flags    = tp->flags;
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE)
+      snp->wabase   = tp->wabase;
+#endif
+#if CH_DBG_THREADS_PROFILING == TRUE
+      snp->time     = tp->time;
+#endif
+#if CH_DBG_STATISTICS == TRUE
+      snp->cumulative = tp->stats.cumulative;
+#endif
+#if CH_CFG_USE_BUDGETS == TRUE
+      snp->budget   = tp->budget.budget;
+      snp->period   = tp->budget.period;
+      snp->consumed = tp->budget.consumed;
+      snp->overruns = tp->budget.overruns;
+#endif
+      snp++;
+    }
+    i++;
+    tp = tp->newer;
+  }
+  chSysUnlock();
+
+  return i;
+}
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Adds a thread to the names hash index.
+ * @note    Threads without a name are not indexed.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void _reg_hash_insert(thread_t *tp) {
+  thread_t **tpp;
+
+  if (tp->name != NULL) {
+    /* Buckets are kept in registry insertion order so that lookups return
+       the oldest thread, as a registry scan would do, also after a thread
+       has been renamed. The difference is used because the sequence
+       counter can wrap.*/
+    tpp = reg_hash_bucket(tp->name);
+    while ((*tpp != NULL) && ((cnt_t)((*tpp)->regseq - tp->regseq) < 0)) {
+      tpp = &(*tpp)->hashnext;
+    }
+    tp->hashnext = *tpp;
+    *tpp = tp;
+  }
+  else {
+    tp->hashnext = NULL;
+  }
+}
+
+/**
+ * @brief   Removes a thread from the names hash index.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The operation result.
+ * @retval false        if the thread was not indexed.
+ * @retval true         if the thread has been removed.
+ *
+ * @notapi
+ */
+bool _reg_hash_remove(thread_t *tp) {
+  thread_t **tpp;
+
+  if (tp->name != NULL) {
+    tpp = reg_hash_bucket(tp->name);
+    while (*tpp != NULL) {
+      if (*tpp == tp) {
+        *tpp = tp->hashnext;
+        return true;
+      }
+      tpp = &(*tpp)->hashnext;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Changes a thread name updating the names hash index.
+ * @note    A thread no more in the registry is renamed but not indexed.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] name      thread name as a zero terminated string
+ *
+ * @xclass
+ */
+void _reg_hash_rename(thread_t *tp, const char *name) {
+  syssts_t sts;
+
+  sts = chSysGetStatusAndLockX();
+  if (tp->name == NULL) {
+    /* Unnamed threads are not indexed, checking registry membership.*/
+    tp->name = name;
+    if (tp->newer->older == tp) {
+      _reg_hash_insert(tp);
+    }
+  }
+  else if (_reg_hash_remove(tp)) {
+    tp->name = name;
+    _reg_hash_insert(tp);
+  }
+  else {
+    tp->name = name;
+  }
+  chSysRestoreStatusX(sts);
+}
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 #endif /* CH_CFG_USE_REGISTRY == TRUE */
 
 /** @} */
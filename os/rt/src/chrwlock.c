@@ -0,0 +1,249 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chrwlock.c
+ * @brief   Reader/Writer locks code.
+ *
+ * @addtogroup rwlocks
+ * @details Reader/Writer locks related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          A reader/writer lock allows any number of threads to access a
+ *          shared resource for reading or a single thread to access it for
+ *          writing.<br>
+ *          The lock embeds a mutex which is held by the writer for the
+ *          whole write operation and only for an instant by readers while
+ *          they register themselves. This gives the following properties:
+ *          - Readers do not serialize, once registered they proceed in
+ *            parallel.
+ *          - A writer gets the mutex first and then waits for the active
+ *            readers to leave, new readers queue on the mutex behind it so
+ *            writers cannot starve.
+ *          - Threads queued behind a writer raise its priority using the
+ *            mutexes priority inheritance mechanism, chained blocking is
+ *            handled as for any other mutex.
+ *          .
+ *          Readers are not subject to priority inheritance.
+ *          <h2>Constraints</h2>
+ *          The write lock is a mutex so it must be released in lock-reverse
+ *          order with respect to the other mutexes owned by the writer.
+ * @pre     In order to use the reader/writer lock APIs the
+ *          @p CH_CFG_USE_RWLOCKS option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p rwlock_t structure.
+ *
+ * @param[out] rwp      pointer to a @p rwlock_t structure
+ *
+ * @init
+ */
+void chRWLockObjectInit(rwlock_t *rwp) {
+
+  chDbgCheck(rwp != NULL);
+
+  chMtxObjectInit(&rwp->mtx);
+  rwp->writer  = NULL;
+  rwp->readers = (cnt_t)0;
+}
+
+/**
+ * @brief   Acquires the lock for reading.
+ * @details If a writer owns the lock, or is waiting for it, then the
+ *          invoking thread is queued and the writer priority is raised.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockReadLock(rwlock_t *rwp) {
+
+  chSysLock();
+  chRWLockReadLockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Acquires the lock for reading.
+ * @details If a writer owns the lock, or is waiting for it, then the
+ *          invoking thread is queued and the writer priority is raised.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRWLockReadLockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  /* The mutex is only taken in order to get in line behind writers, it is
+     released immediately, the next waiting thread, if any, is readied.*/
+  chMtxLockS(&rwp->mtx);
+  rwp->readers++;
+  chMtxUnlockS(&rwp->mtx);
+}
+
+/**
+ * @brief   Releases a read lock.
+ * @details If this is the last reader and a writer is waiting then the
+ *          writer is resumed.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockReadUnlock(rwlock_t *rwp) {
+
+  chSysLock();
+  chRWLockReadUnlockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Releases a read lock.
+ * @details If this is the last reader and a writer is waiting then the
+ *          writer is resumed.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRWLockReadUnlockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+  chDbgAssert(rwp->readers > (cnt_t)0, "not read locked");
+
+  if (--rwp->readers == (cnt_t)0) {
+    chThdResumeI(&rwp->writer, MSG_OK);
+  }
+}
+
+/**
+ * @brief   Acquires the lock for writing.
+ * @details The embedded mutex is locked, this blocks any new reader or
+ *          writer, then the function waits for the active readers to
+ *          leave.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockWriteLock(rwlock_t *rwp) {
+
+  chSysLock();
+  chRWLockWriteLockS(rwp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Acquires the lock for writing.
+ * @details The embedded mutex is locked, this blocks any new reader or
+ *          writer, then the function waits for the active readers to
+ *          leave.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRWLockWriteLockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  chMtxLockS(&rwp->mtx);
+  while (rwp->readers > (cnt_t)0) {
+    (void) chThdSuspendS(&rwp->writer);
+  }
+}
+
+/**
+ * @brief   Releases a write lock.
+ * @details The embedded mutex is released and passed to the highest
+ *          priority waiting thread, the writer priority is restored.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockWriteUnlock(rwlock_t *rwp) {
+
+  chDbgCheck(rwp != NULL);
+
+  chMtxUnlock(&rwp->mtx);
+}
+
+/**
+ * @brief   Releases a write lock.
+ * @details The embedded mutex is released and passed to the highest
+ *          priority waiting thread, the writer priority is restored.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to a @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRWLockWriteUnlockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  chMtxUnlockS(&rwp->mtx);
+}
+
+#endif /* CH_CFG_USE_RWLOCKS == TRUE */
+
+/** @} */
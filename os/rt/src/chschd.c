@@ -69,6 +69,16 @@ void _scheduler_init(void) {
 #if CH_CFG_USE_REGISTRY == TRUE
   ch.rlist.newer = (thread_t *)&ch.rlist;
   ch.rlist.older = (thread_t *)&ch.rlist;
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  {
+    unsigned i;
+
+    for (i = 0U; i < (unsigned)CH_CFG_REGISTRY_HASH_SIZE; i++) {
+      ch.reghash[i] = NULL;
+    }
+    ch.regseq = (ucnt_t)0;
+  }
+#endif
 #endif
 }
 
@@ -228,7 +238,7 @@ thread_t *chSchReadyI(thread_t *tp) {
   cp = (thread_t *)&ch.rlist.queue;
   do {
     cp = cp->queue.next;
-  } while (cp->prio >= tp->prio);
+  } while (!sch_precedes(tp, cp));
   /* Insertion on prev.*/
   tp->queue.next             = cp;
   tp->queue.prev             = cp->queue.prev;
@@ -267,7 +277,7 @@ thread_t *chSchReadyAheadI(thread_t *tp) {
   cp = (thread_t *)&ch.rlist.queue;
   do {
     cp = cp->queue.next;
-  } while (cp->prio > tp->prio);
+  } while (sch_precedes(cp, tp));
   /* Insertion on prev.*/
   tp->queue.next             = cp;
   tp->queue.prev             = cp->queue.prev;
@@ -277,6 +287,60 @@ thread_t *chSchReadyAheadI(thread_t *tp) {
   return tp;
 }
 
+/**
+ * @brief   Inserts a list of threads in the Ready List.
+ * @details The threads are moved into the ready list in a single pass, the
+ *          final order is the same obtained by calling @p chSchReadyI() on
+ *          each thread in list order but the ready list is scanned only
+ *          once.
+ * @pre     The list is linked through the @p queue.next field and
+ *          terminated by @p NULL, it must be ordered by decreasing
+ *          priority, threads with equal priority in FIFO order.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ * @note    The threads can already be marked as @p CH_STATE_READY, this
+ *          allows the caller to detect threads already collected.
+ *
+ * @param[in] tp        pointer to the first thread of the list
+ *
+ * @iclass
+ */
+void chSchReadyListI(thread_t *tp) {
+  thread_t *cp;
+
+  chDbgCheckClassI();
+  chDbgCheck(tp != NULL);
+
+  cp = ch.rlist.queue.next;
+  while (tp != NULL) {
+    thread_t *ntp = tp->queue.next;
+
+    chDbgAssert(tp->state != CH_STATE_FINAL, "invalid state");
+
+    tp->state = CH_STATE_READY;
+#if CH_CFG_USE_EDF == TRUE
+    /* Deadlines are not ordered in the queue, for EDF threads the scan
+       restarts from the beginning.*/
+    if (tp->edf.reldeadline > (systime_t)0) {
+      cp = ch.rlist.queue.next;
+    }
+#endif
+    /* Priorities are not increasing so the scan continues from the
+       previous insertion point.*/
+    while (!sch_precedes(tp, cp)) {
+      cp = cp->queue.next;
+    }
+    /* Insertion on prev.*/
+    tp->queue.next             = cp;
+    tp->queue.prev             = cp->queue.prev;
+    tp->queue.prev->queue.next = tp;
+    cp->queue.prev             = tp;
+    tp = ntp;
+  }
+}
+
 /**
  * @brief   Puts the current thread to sleep into the specified state.
  * @details The thread goes into a sleeping state. The possible
@@ -326,6 +390,13 @@ static void wakeup(void *p) {
        another thread with higher priority.*/
     chSysUnlockFromISR();
     return;
+#if (CH_CFG_USE_CONDVARS == TRUE) && (CH_CFG_USE_CONDVARS_TIMEOUT == TRUE)
+  case CH_STATE_WTMTX:
+    /* The thread has already been signaled and moved from the condition
+       variable on the mutex queue, the timeout no longer applies.*/
+    chSysUnlockFromISR();
+    return;
+#endif
   case CH_STATE_SUSPENDED:
     *tp->u.wttrp = NULL;
     break;
@@ -425,7 +496,7 @@ void chSchWakeupS(thread_t *ntp, msg_t msg) {
      one then it is just inserted in the ready list else it made
      running immediately and the invoking thread goes in the ready
      list instead.*/
-  if (ntp->prio <= otp->prio) {
+  if (!sch_precedes(ntp, otp)) {
     (void) chSchReadyI(ntp);
   }
   else {
@@ -475,19 +546,19 @@ void chSchRescheduleS(void) {
  * @special
  */
 bool chSchIsPreemptionRequired(void) {
-  tprio_t p1 = firstprio(&ch.rlist.queue);
-  tprio_t p2 = currp->prio;
+  thread_t *ftp = ch.rlist.queue.next;
 
 #if CH_CFG_TIME_QUANTUM > 0
   /* If the running thread has not reached its time quantum, reschedule only
      if the first thread on the ready queue has a higher priority.
      Otherwise, if the running thread has used up its time quantum, reschedule
      if the first thread on the ready queue has equal or higher priority.*/
-  return (currp->preempt > (tslices_t)0) ? (p1 > p2) : (p1 >= p2);
+  return (currp->preempt > (tslices_t)0) ? sch_precedes(ftp, currp) :
+                                           !sch_precedes(currp, ftp);
 #else
   /* If the round robin preemption feature is not enabled then performs a
      simpler comparison.*/
-  return p1 > p2;
+  return sch_precedes(ftp, currp);
 #endif
 }
 
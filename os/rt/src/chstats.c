@@ -26,6 +26,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "ch.h"
 
 #if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
@@ -34,6 +36,17 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+#if (CH_DBG_CRIT_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Return address of the current function.
+ */
+#if defined(__GNUC__) || defined(__DOXYGEN__)
+#define STATS_CALLER()      ((const void *)__builtin_return_address(0))
+#else
+#define STATS_CALLER()      ((const void *)NULL)
+#endif
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -50,6 +63,56 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_DBG_CRIT_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Records a critical zone in the profiler table.
+ * @details The zone is recorded if it is longer than the previous worst
+ *          case or if it exceeds the threshold. An entry with the same
+ *          call site is updated, else the entry with the shortest zone is
+ *          replaced if shorter.
+ *
+ * @param[in] site      call site of the zone
+ * @param[in] last      duration of the zone
+ * @param[in] worst     previous worst duration
+ * @param[in] isr       @p true if the zone was entered from an ISR
+ */
+static void crit_record(const void *site, rtcnt_t last, rtcnt_t worst,
+                        bool isr) {
+  crit_site_t *csp, *minp;
+
+#if CH_DBG_CRIT_PROFILER_THRESHOLD > 0
+  if ((last <= worst) && (last < (rtcnt_t)CH_DBG_CRIT_PROFILER_THRESHOLD)) {
+#else
+  if (last <= worst) {
+#endif
+    return;
+  }
+
+  minp = &ch.kernel_stats.crit_sites[0];
+  for (csp = &ch.kernel_stats.crit_sites[0];
+       csp < &ch.kernel_stats.crit_sites[CH_DBG_CRIT_PROFILER_SIZE];
+       csp++) {
+    if ((csp->n > (ucnt_t)0) && (csp->site == site) && (csp->isr == isr)) {
+      csp->n++;
+      if (last > csp->worst) {
+        csp->worst = last;
+      }
+      return;
+    }
+    if (csp->worst < minp->worst) {
+      minp = csp;
+    }
+  }
+
+  if (last > minp->worst) {
+    minp->site  = site;
+    minp->worst = last;
+    minp->n     = (ucnt_t)1;
+    minp->isr   = isr;
+  }
+}
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -65,6 +128,17 @@ void _stats_init(void) {
   ch.kernel_stats.n_ctxswc = (ucnt_t)0;
   chTMObjectInit(&ch.kernel_stats.m_crit_thd);
   chTMObjectInit(&ch.kernel_stats.m_crit_isr);
+#if CH_CFG_USE_EVENTS == TRUE
+  chTMObjectInit(&ch.kernel_stats.m_evt_bcast);
+#endif
+#if CH_CFG_USE_MUTEXES == TRUE
+  ch.kernel_stats.mtxlist = NULL;
+#endif
+#if CH_DBG_CRIT_PROFILER == TRUE
+  ch.kernel_stats.crit_thd_site = NULL;
+  ch.kernel_stats.crit_isr_site = NULL;
+  memset(ch.kernel_stats.crit_sites, 0, sizeof (ch.kernel_stats.crit_sites));
+#endif
 }
 
 /**
@@ -91,35 +165,118 @@ void _stats_ctxswc(thread_t *ntp, thread_t *otp) {
 
 /**
  * @brief   Starts the measurement of a thread critical zone.
+ * @note    Must not be inlined, the return address identifies the code
+ *          entering the zone.
  */
-void _stats_start_measure_crit_thd(void) {
+NOINLINE void _stats_start_measure_crit_thd(void) {
 
   chTMStartMeasurementX(&ch.kernel_stats.m_crit_thd);
+#if CH_DBG_CRIT_PROFILER == TRUE
+  ch.kernel_stats.crit_thd_site = STATS_CALLER();
+#endif
 }
 
 /**
  * @brief   Stops the measurement of a thread critical zone.
  */
 void _stats_stop_measure_crit_thd(void) {
+#if CH_DBG_CRIT_PROFILER == TRUE
+  rtcnt_t worst = ch.kernel_stats.m_crit_thd.worst;
+#endif
 
   chTMStopMeasurementX(&ch.kernel_stats.m_crit_thd);
+#if CH_DBG_CRIT_PROFILER == TRUE
+  crit_record(ch.kernel_stats.crit_thd_site,
+              ch.kernel_stats.m_crit_thd.last, worst, false);
+#endif
 }
 
 /**
  * @brief   Starts the measurement of an ISR critical zone.
+ * @note    Must not be inlined, the return address identifies the code
+ *          entering the zone.
  */
-void _stats_start_measure_crit_isr(void) {
+NOINLINE void _stats_start_measure_crit_isr(void) {
 
   chTMStartMeasurementX(&ch.kernel_stats.m_crit_isr);
+#if CH_DBG_CRIT_PROFILER == TRUE
+  ch.kernel_stats.crit_isr_site = STATS_CALLER();
+#endif
 }
 
 /**
  * @brief   Stops the measurement of an ISR critical zone.
  */
 void _stats_stop_measure_crit_isr(void) {
+#if CH_DBG_CRIT_PROFILER == TRUE
+  rtcnt_t worst = ch.kernel_stats.m_crit_isr.worst;
+#endif
 
   chTMStopMeasurementX(&ch.kernel_stats.m_crit_isr);
+#if CH_DBG_CRIT_PROFILER == TRUE
+  crit_record(ch.kernel_stats.crit_isr_site,
+              ch.kernel_stats.m_crit_isr.last, worst, true);
+#endif
+}
+
+#if (CH_DBG_CRIT_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the worst critical zones call sites.
+ * @details The entries are returned ordered by decreasing duration.
+ *
+ * @param[out] csp      pointer to an array of @p crit_site_t
+ * @param[in] n         size of the array
+ * @return              The number of returned entries.
+ *
+ * @api
+ */
+unsigned chStatsGetCritSites(crit_site_t *csp, unsigned n) {
+  crit_site_t sites[CH_DBG_CRIT_PROFILER_SIZE];
+  crit_site_t tmp;
+  unsigned i, j, cnt;
+
+  chDbgCheck((csp != NULL) || (n == 0U));
+
+  /* Snapshot of the table, sorting is done outside the critical zone.*/
+  chSysLock();
+  memcpy(sites, ch.kernel_stats.crit_sites, sizeof (sites));
+  chSysUnlock();
+
+  /* Insertion sort, free entries have zero duration.*/
+  for (i = 1U; i < (unsigned)CH_DBG_CRIT_PROFILER_SIZE; i++) {
+    tmp = sites[i];
+    for (j = i; (j > 0U) && (sites[j - 1U].worst < tmp.worst); j--) {
+      sites[j] = sites[j - 1U];
+    }
+    sites[j] = tmp;
+  }
+
+  cnt = 0U;
+  for (i = 0U; (i < (unsigned)CH_DBG_CRIT_PROFILER_SIZE) && (cnt < n); i++) {
+    if (sites[i].n > (ucnt_t)0) {
+      csp[cnt++] = sites[i];
+    }
+  }
+
+  return cnt;
+}
+
+/**
+ * @brief   Clears the critical zones profiler.
+ * @details The critical zones worst durations are also reset so that the
+ *          next zones are recorded again.
+ *
+ * @api
+ */
+void chStatsResetCritSites(void) {
+
+  chSysLock();
+  memset(ch.kernel_stats.crit_sites, 0, sizeof (ch.kernel_stats.crit_sites));
+  ch.kernel_stats.m_crit_thd.worst = (rtcnt_t)0;
+  ch.kernel_stats.m_crit_isr.worst = (rtcnt_t)0;
+  chSysUnlock();
 }
+#endif
 
 #endif /* CH_DBG_STATISTICS == TRUE */
 
@@ -54,6 +54,14 @@ THD_WORKING_AREA(ch_idle_thread_wa, PORT_IDLE_THREAD_STACK_SIZE);
 /* Module local variables.                                                   */
 /*===========================================================================*/
 
+#if (CH_DBG_STACK_SENTINEL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Stack sentinel thread working area.
+ */
+static THD_WORKING_AREA(ch_sentinel_thread_wa,
+                        CH_DBG_STACK_SENTINEL_STACK_SIZE);
+#endif
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
@@ -83,6 +91,36 @@ static void _idle_thread(void *p) {
 }
 #endif /* CH_CFG_NO_IDLE_THREAD == FALSE */
 
+#if (CH_DBG_STACK_SENTINEL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Stack sentinel thread.
+ * @details Periodically scans the stack of each registered thread and
+ *          records the minimum headroom, the thread runs at @p LOWPRIO so
+ *          it only uses otherwise idle time.
+ *
+ * @param[in] p         the thread parameter, unused in this scenario
+ */
+static void _sentinel_thread(void *p) {
+
+  (void)p;
+
+  while (true) {
+    thread_t *tp = chRegFirstThread();
+
+    do {
+      size_t n = chThdGetStackUnusedX(tp);
+
+      if (n < tp->headroom) {
+        tp->headroom = n;
+      }
+      tp = chRegNextThread(tp);
+    } while (tp != NULL);
+
+    chThdSleepMilliseconds(CH_DBG_STACK_SENTINEL_PERIOD);
+  }
+}
+#endif /* CH_DBG_STACK_SENTINEL == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -175,6 +213,21 @@ void chSysInit(void) {
     (void) chThdCreate(&idle_descriptor);
   }
 #endif
+
+#if CH_DBG_STACK_SENTINEL == TRUE
+  {
+    static const thread_descriptor_t sentinel_descriptor = {
+      "sentinel",
+      THD_WORKING_AREA_BASE(ch_sentinel_thread_wa),
+      THD_WORKING_AREA_END(ch_sentinel_thread_wa),
+      LOWPRIO,
+      _sentinel_thread,
+      NULL
+    };
+
+    (void) chThdCreate(&sentinel_descriptor);
+  }
+#endif
 }
 
 /**
@@ -345,6 +398,9 @@ void chSysTimerHandlerI(void) {
 #endif
 #if CH_DBG_THREADS_PROFILING == TRUE
   currp->time++;
+#endif
+#if CH_CFG_USE_BUDGETS == TRUE
+  _budget_tick();
 #endif
   chVTDoTickI();
   CH_CFG_SYSTEM_TICK_HOOK();
@@ -97,12 +97,27 @@ thread_t *_thread_init(thread_t *tp, const char *name, tprio_t prio) {
   tp->realprio  = prio;
   tp->mtxlist   = NULL;
 #endif
+#if CH_CFG_USE_EDF == TRUE
+  tp->edf.period      = (systime_t)0;
+  tp->edf.reldeadline = (systime_t)0;
+  tp->edf.release     = (systime_t)0;
+  tp->edf.deadline    = (systime_t)0;
+  tp->edf.misses      = (ucnt_t)0;
+#endif
+#if CH_CFG_USE_BUDGETS == TRUE
+  tp->budget.budget    = (systime_t)0;
+  tp->budget.throttled = false;
+  chVTObjectInit(&tp->budget.vt);
+#endif
 #if CH_CFG_USE_EVENTS == TRUE
   tp->epending  = (eventmask_t)0;
 #endif
 #if CH_DBG_THREADS_PROFILING == TRUE
   tp->time      = (systime_t)0;
 #endif
+#if CH_DBG_STACK_SENTINEL == TRUE
+  tp->headroom  = ~(size_t)0;
+#endif
 #if CH_CFG_USE_REGISTRY == TRUE
   tp->refs      = (trefs_t)1;
   tp->name      = name;
@@ -126,6 +141,8 @@ thread_t *_thread_init(thread_t *tp, const char *name, tprio_t prio) {
 #if (CH_DBG_FILL_THREADS == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Memory fill utility.
+ * @details The area is filled a word at time, four words per iteration,
+ *          unaligned head and tail bytes are filled individually.
  *
  * @param[in] startp    first address to fill
  * @param[in] endp      last address to fill +1
@@ -134,13 +151,75 @@ thread_t *_thread_init(thread_t *tp, const char *name, tprio_t prio) {
  * @notapi
  */
 void _thread_memfill(uint8_t *startp, uint8_t *endp, uint8_t v) {
+  uint32_t w = (uint32_t)v * 0x01010101U;
+  uint32_t *wp;
+
+  while ((startp < endp) && !MEM_IS_ALIGNED(startp, sizeof (uint32_t))) {
+    *startp++ = v;
+  }
 
+  wp = (uint32_t *)startp;
+  while ((uint8_t *)(wp + 4) <= endp) {
+    wp[0] = w;
+    wp[1] = w;
+    wp[2] = w;
+    wp[3] = w;
+    wp += 4;
+  }
+  while ((uint8_t *)(wp + 1) <= endp) {
+    *wp++ = w;
+  }
+
+  startp = (uint8_t *)wp;
   while (startp < endp) {
     *startp++ = v;
   }
 }
 #endif /* CH_DBG_FILL_THREADS */
 
+#if ((CH_DBG_FILL_THREADS == TRUE) &&                                       \
+     ((CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE))) || \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Returns the stack space never used by a thread.
+ * @details The stack is scanned a word at time starting from the working
+ *          area base, the scan stops on the first word not matching the
+ *          fill value. A binary search would be faster but it would be
+ *          fooled by untouched areas in the middle of the used stack, for
+ *          example unused local buffers.
+ * @pre     The thread working area must have been filled on creation,
+ *          threads created using I-class functions are not filled.
+ * @note    The main thread is measured only if its stack base is known,
+ *          see @p CH_DBG_ENABLE_STACK_CHECK.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of never used bytes in the stack area,
+ *                      with word granularity.
+ *
+ * @xclass
+ */
+size_t chThdGetStackUnusedX(thread_t *tp) {
+  const uint32_t w = (uint32_t)CH_DBG_STACK_FILL_VALUE * 0x01010101U;
+  const uint8_t *endp = (const uint8_t *)tp;
+  const uint32_t *wp;
+
+  chDbgCheck(tp != NULL);
+
+  /* Threads whose structure is not in the upper part of the working area
+     cannot be measured.*/
+  if ((tp->wabase == NULL) || (endp <= (const uint8_t *)tp->wabase)) {
+    return (size_t)0;
+  }
+
+  wp = (const uint32_t *)tp->wabase;
+  while (((const uint8_t *)(wp + 1) <= endp) && (*wp == w)) {
+    wp++;
+  }
+
+  return (size_t)((const uint8_t *)wp - (const uint8_t *)tp->wabase);
+}
+#endif
+
 /**
  * @brief   Creates a new thread into a static memory area.
  * @details The new thread is initialized but not inserted in the ready list,
@@ -442,6 +521,11 @@ void chThdRelease(thread_t *tp) {
       chHeapFree(chThdGetWorkingAreaX(tp));
       break;
 #endif
+#if CH_CFG_USE_WA_CACHE == TRUE
+    case CH_FLAG_MODE_CACHE:
+      _thread_cache_free(chThdGetWorkingAreaX(tp));
+      break;
+#endif
 #if CH_CFG_USE_MEMPOOLS == TRUE
     case CH_FLAG_MODE_MPOOL:
       chPoolFree(tp->mpool, chThdGetWorkingAreaX(tp));
@@ -505,6 +589,13 @@ void chThdExitS(msg_t msg) {
   /* Exit handler hook.*/
   CH_CFG_THREAD_EXIT_HOOK(tp);
 
+#if CH_CFG_USE_BUDGETS == TRUE
+  /* Stopping the budget replenishment timer, if armed.*/
+  if (chVTIsArmedI(&tp->budget.vt)) {
+    chVTDoResetI(&tp->budget.vt);
+  }
+#endif
+
 #if CH_CFG_USE_WAITEXIT == TRUE
   /* Waking up any waiting thread.*/
   while (list_notempty(&tp->waiting)) {
@@ -615,6 +706,79 @@ tprio_t chThdSetPriority(tprio_t newprio) {
   return oldprio;
 }
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Sets the EDF parameters of the running thread.
+ * @details The first job is released immediately, its absolute deadline is
+ *          the current time plus @p deadline. Among ready threads with the
+ *          same priority, EDF threads are scheduled in order of absolute
+ *          deadline, non-EDF threads keep the usual FIFO ordering.
+ * @note    The deadline misses counter is reset.
+ *
+ * @param[in] period    the release period of the thread jobs
+ * @param[in] deadline  the relative deadline of the thread jobs, zero
+ *                      returns the thread to normal scheduling
+ *
+ * @api
+ */
+void chThdSetEDF(systime_t period, systime_t deadline) {
+  thread_t *tp = currp;
+
+  chDbgCheck((deadline == (systime_t)0) || (period > (systime_t)0));
+
+  chSysLock();
+  tp->edf.period      = period;
+  tp->edf.reldeadline = deadline;
+  tp->edf.release     = chVTGetSystemTimeX();
+  tp->edf.deadline    = tp->edf.release + deadline;
+  tp->edf.misses      = (ucnt_t)0;
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Terminates the current EDF job and waits for the next release.
+ * @details If the current time is past the job absolute deadline then the
+ *          thread deadline misses counter is increased. The next job is
+ *          released one period after the current one, if that time is
+ *          already past then the function does not sleep.
+ * @pre     The EDF parameters must have been set using @p chThdSetEDF().
+ *
+ * @return              The deadline status of the terminated job.
+ * @retval false        if the job completed within its deadline.
+ * @retval true         if the job missed its deadline.
+ *
+ * @api
+ */
+bool chThdSleepUntilNextPeriod(void) {
+  thread_t *tp = currp;
+  systime_t now, prev;
+  bool missed;
+
+  chDbgCheck(tp->edf.reldeadline > (systime_t)0);
+
+  chSysLock();
+  now    = chVTGetSystemTimeX();
+  missed = !chVTIsTimeWithinX(now, tp->edf.release, tp->edf.deadline);
+  if (missed) {
+    tp->edf.misses++;
+  }
+  prev                = tp->edf.release;
+  tp->edf.release    += tp->edf.period;
+  tp->edf.deadline    = tp->edf.release + tp->edf.reldeadline;
+  if (chVTIsTimeWithinX(now, prev, tp->edf.release)) {
+    chThdSleepS(tp->edf.release - now);
+  }
+  else {
+    /* Late, the new deadline could be earlier than other threads.*/
+    chSchRescheduleS();
+  }
+  chSysUnlock();
+
+  return missed;
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /**
  * @brief   Requests a thread termination.
  * @pre     The target thread must be written to invoke periodically
@@ -0,0 +1,513 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chworkq.c
+ * @brief   Work queues code.
+ *
+ * @addtogroup workqueues
+ * @details Work queues related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          A work queue allows interrupt handlers and threads to defer
+ *          processing to a pool of worker threads. Work items are posted
+ *          using I-class functions so an ISR can move the bulk of its
+ *          processing out of the interrupt context, the item function is
+ *          then executed by the first available worker thread at the
+ *          worker priority.<br>
+ *          Properties:
+ *          - Items are executed in FIFO order, multiple workers at
+ *            different priorities can serve the same queue.
+ *          - Idle workers are kept in priority order, a posted item wakes
+ *            up the highest priority idle worker.
+ *          - An item can be pending only once, posting an already queued
+ *            or delayed item has no effect and the post is merged with the
+ *            pending one.
+ *          - Delayed items are queued by a virtual timer when their delay
+ *            expires.
+ *          - When the option @p CH_DBG_STATISTICS is enabled each queue
+ *            keeps count of posted, merged and executed items and measures
+ *            the latency between posting and execution using the realtime
+ *            counter.
+ *          .
+ *          Work item structures must not be modified while the item is
+ *          pending, an item can be re-posted from its own function.
+ * @pre     In order to use the work queues APIs the
+ *          @p CH_CFG_USE_WORKQUEUES option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_WORKQUEUES == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Appends an item to a queue and wakes up an idle worker.
+ *
+ * @param[in] wqp       pointer to the @p work_queue_t structure
+ * @param[in] wip       pointer to the @p work_item_t structure
+ *
+ * @notapi
+ */
+static void wq_enqueue(work_queue_t *wqp, work_item_t *wip) {
+
+  wip->state = WQ_STATE_QUEUED;
+  wip->wqp   = wqp;
+  wip->next  = NULL;
+  if (wqp->head == NULL) {
+    wqp->head = wip;
+  }
+  else {
+    wqp->tail->next = wip;
+  }
+  wqp->tail = wip;
+#if CH_DBG_STATISTICS == TRUE
+  wip->posted = chSysGetRealtimeCounterX();
+  wqp->stats.n_posted++;
+#endif
+
+  chThdDequeueNextI(&wqp->workers, MSG_OK);
+}
+
+/**
+ * @brief   Delayed items timer callback.
+ *
+ * @param[in] p         pointer to the @p delayed_work_t structure
+ *
+ * @notapi
+ */
+static void wq_delayed_cb(void *p) {
+  delayed_work_t *dwp = (delayed_work_t *)p;
+
+  chSysLockFromISR();
+  wq_enqueue(dwp->item.wqp, &dwp->item);
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Worker threads function.
+ * @details Workers serve the queue until termination is requested and
+ *          there are no more queued items.
+ *
+ * @param[in] p         pointer to the @p work_queue_t structure
+ *
+ * @notapi
+ */
+static void wq_worker(void *p) {
+  work_queue_t *wqp = (work_queue_t *)p;
+
+  chSysLock();
+  while (true) {
+    work_item_t *wip = wqp->head;
+    wqfunc_t func;
+    void *arg;
+
+    if (wip == NULL) {
+      if (wqp->terminate) {
+        break;
+      }
+      /* Idle workers are queued by priority, the highest priority one is
+         the first to be awakened.*/
+      queue_prio_insert(currp, &wqp->workers);
+      (void) chSchGoSleepS(CH_STATE_QUEUED);
+      continue;
+    }
+
+    /* Removing the item from the queue, from now on it can be posted
+       again, also from its own function.*/
+    wqp->head  = wip->next;
+    wip->state = WQ_STATE_IDLE;
+    wip->wqp   = NULL;
+    func       = wip->func;
+    arg        = wip->arg;
+#if CH_DBG_STATISTICS == TRUE
+    {
+      rtcnt_t latency = chSysGetRealtimeCounterX() - wip->posted;
+
+      wqp->stats.n_executed++;
+      wqp->stats.cumulative += (rttime_t)latency;
+      if (latency > wqp->stats.worst) {
+        wqp->stats.worst = latency;
+      }
+    }
+#endif
+    chSysUnlock();
+
+    func(arg);
+
+    chSysLock();
+  }
+  chThdExitS(MSG_OK);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p work_queue_t structure.
+ * @note    The queue has no workers after initialization, worker threads
+ *          are added using @p chWQAddWorker().
+ *
+ * @param[out] wqp      pointer to a @p work_queue_t structure
+ * @param[in] name      name assigned to the worker threads
+ *
+ * @init
+ */
+void chWQObjectInit(work_queue_t *wqp, const char *name) {
+
+  chDbgCheck(wqp != NULL);
+
+  wqp->head      = NULL;
+  wqp->tail      = NULL;
+  chThdQueueObjectInit(&wqp->workers);
+  wqp->name      = name;
+  wqp->terminate = false;
+#if CH_DBG_STATISTICS == TRUE
+  wqp->stats.n_posted   = (ucnt_t)0;
+  wqp->stats.n_merged   = (ucnt_t)0;
+  wqp->stats.n_executed = (ucnt_t)0;
+  wqp->stats.worst      = (rtcnt_t)0;
+  wqp->stats.cumulative = (rttime_t)0;
+#endif
+}
+
+/**
+ * @brief   Adds a worker thread to a work queue.
+ * @details The worker thread is created in the specified working area and
+ *          serves the queue at the specified priority, any number of
+ *          workers can be added to the same queue.
+ *
+ * @param[in] wqp       pointer to a @p work_queue_t structure
+ * @param[out] wsp      pointer to a working area dedicated to the worker
+ * @param[in] size      size of the working area
+ * @param[in] prio      the priority level for the worker
+ * @return              The pointer to the @p thread_t structure allocated
+ *                      for the worker.
+ *
+ * @api
+ */
+thread_t *chWQAddWorker(work_queue_t *wqp, void *wsp, size_t size,
+                        tprio_t prio) {
+  thread_descriptor_t td = {
+    wqp->name,
+    (stkalign_t *)wsp,
+    (stkalign_t *)((uint8_t *)wsp + size),
+    prio,
+    wq_worker,
+    (void *)wqp
+  };
+
+  chDbgCheck(wqp != NULL);
+
+  return chThdCreate(&td);
+}
+
+/**
+ * @brief   Requests the termination of the workers of a work queue.
+ * @details The worker threads exit after the queued items have been
+ *          executed, delayed items still running their delay are not
+ *          waited for. Workers can be waited for using @p chThdWait().
+ * @note    Items must not be posted to the queue after this call.
+ *
+ * @param[in] wqp       pointer to a @p work_queue_t structure
+ *
+ * @api
+ */
+void chWQTerminate(work_queue_t *wqp) {
+
+  chDbgCheck(wqp != NULL);
+
+  chSysLock();
+  wqp->terminate = true;
+  chThdDequeueAllI(&wqp->workers, MSG_RESET);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Initializes a @p work_item_t structure.
+ *
+ * @param[out] wip      pointer to a @p work_item_t structure
+ * @param[in] func      the work function
+ * @param[in] arg       the argument passed to the work function
+ *
+ * @init
+ */
+void chWQItemObjectInit(work_item_t *wip, wqfunc_t func, void *arg) {
+
+  chDbgCheck((wip != NULL) && (func != NULL));
+
+  wip->next  = NULL;
+  wip->func  = func;
+  wip->arg   = arg;
+  wip->wqp   = NULL;
+  wip->state = WQ_STATE_IDLE;
+}
+
+/**
+ * @brief   Initializes a @p delayed_work_t structure.
+ *
+ * @param[out] dwp      pointer to a @p delayed_work_t structure
+ * @param[in] func      the work function
+ * @param[in] arg       the argument passed to the work function
+ *
+ * @init
+ */
+void chWQDelayedObjectInit(delayed_work_t *dwp, wqfunc_t func, void *arg) {
+
+  chDbgCheck(dwp != NULL);
+
+  chWQItemObjectInit(&dwp->item, func, arg);
+  chVTObjectInit(&dwp->vt);
+}
+
+/**
+ * @brief   Posts a work item.
+ * @details The item is appended to the queue and an idle worker, if any,
+ *          is readied. If the item is already pending then the post is
+ *          merged with the pending one.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note
+ *          that interrupt handlers always reschedule on exit so an
+ *          explicit reschedule must not be performed in ISRs.
+ *
+ * @param[in] wqp       pointer to a @p work_queue_t structure
+ * @param[in] wip       pointer to a @p work_item_t structure
+ * @return              The operation result.
+ * @retval true         if the item has been queued.
+ * @retval false        if the item was already pending.
+ *
+ * @iclass
+ */
+bool chWQPostI(work_queue_t *wqp, work_item_t *wip) {
+
+  chDbgCheckClassI();
+  chDbgCheck((wqp != NULL) && (wip != NULL));
+  chDbgAssert(!wqp->terminate, "terminated");
+
+  if (wip->state != WQ_STATE_IDLE) {
+#if CH_DBG_STATISTICS == TRUE
+    wqp->stats.n_merged++;
+#endif
+    return false;
+  }
+
+  wq_enqueue(wqp, wip);
+
+  return true;
+}
+
+/**
+ * @brief   Posts a work item.
+ * @details The item is appended to the queue and an idle worker, if any,
+ *          is readied. If the item is already pending then the post is
+ *          merged with the pending one.
+ *
+ * @param[in] wqp       pointer to a @p work_queue_t structure
+ * @param[in] wip       pointer to a @p work_item_t structure
+ * @return              The operation result.
+ * @retval true         if the item has been queued.
+ * @retval false        if the item was already pending.
+ *
+ * @api
+ */
+bool chWQPost(work_queue_t *wqp, work_item_t *wip) {
+  bool b;
+
+  chSysLock();
+  b = chWQPostI(wqp, wip);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Posts a delayed work item.
+ * @details The item is queued after the specified delay. If the item is
+ *          already pending then the post is merged with the pending one
+ *          and the original delay is kept.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note
+ *          that interrupt handlers always reschedule on exit so an
+ *          explicit reschedule must not be performed in ISRs.
+ *
+ * @param[in] wqp       pointer to a @p work_queue_t structure
+ * @param[in] dwp       pointer to a @p delayed_work_t structure
+ * @param[in] delay     the number of ticks before the item is queued,
+ *                      @p TIME_IMMEDIATE queues the item immediately
+ * @return              The operation result.
+ * @retval true         if the item has been scheduled.
+ * @retval false        if the item was already pending.
+ *
+ * @iclass
+ */
+bool chWQPostDelayedI(work_queue_t *wqp, delayed_work_t *dwp,
+                      systime_t delay) {
+
+  chDbgCheckClassI();
+  chDbgCheck((wqp != NULL) && (dwp != NULL) && (delay != TIME_INFINITE));
+
+  if (delay == TIME_IMMEDIATE) {
+    return chWQPostI(wqp, &dwp->item);
+  }
+
+  chDbgAssert(!wqp->terminate, "terminated");
+
+  if (dwp->item.state != WQ_STATE_IDLE) {
+#if CH_DBG_STATISTICS == TRUE
+    wqp->stats.n_merged++;
+#endif
+    return false;
+  }
+
+  dwp->item.state = WQ_STATE_DELAYED;
+  dwp->item.wqp   = wqp;
+  chVTSetI(&dwp->vt, delay, wq_delayed_cb, (void *)dwp);
+
+  return true;
+}
+
+/**
+ * @brief   Posts a delayed work item.
+ * @details The item is queued after the specified delay. If the item is
+ *          already pending then the post is merged with the pending one
+ *          and the original delay is kept.
+ *
+ * @param[in] wqp       pointer to a @p work_queue_t structure
+ * @param[in] dwp       pointer to a @p delayed_work_t structure
+ * @param[in] delay     the number of ticks before the item is queued,
+ *                      @p TIME_IMMEDIATE queues the item immediately
+ * @return              The operation result.
+ * @retval true         if the item has been scheduled.
+ * @retval false        if the item was already pending.
+ *
+ * @api
+ */
+bool chWQPostDelayed(work_queue_t *wqp, delayed_work_t *dwp,
+                     systime_t delay) {
+  bool b;
+
+  chSysLock();
+  b = chWQPostDelayedI(wqp, dwp, delay);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Cancels a queued work item.
+ * @note    An item already taken by a worker cannot be cancelled, its
+ *          function could be executing.
+ *
+ * @param[in] wip       pointer to a @p work_item_t structure
+ * @return              The operation result.
+ * @retval true         if the item has been removed from the queue.
+ * @retval false        if the item was not queued.
+ *
+ * @iclass
+ */
+bool chWQCancelI(work_item_t *wip) {
+  work_queue_t *wqp;
+  work_item_t *prev;
+
+  chDbgCheckClassI();
+  chDbgCheck(wip != NULL);
+  chDbgAssert(wip->state != WQ_STATE_DELAYED, "delayed item");
+
+  if (wip->state != WQ_STATE_QUEUED) {
+    return false;
+  }
+
+  /* Searching the predecessor, queues are expected to be short.*/
+  wqp  = wip->wqp;
+  prev = NULL;
+  if (wqp->head != wip) {
+    prev = wqp->head;
+    while (prev->next != wip) {
+      prev = prev->next;
+    }
+  }
+  if (prev == NULL) {
+    wqp->head = wip->next;
+  }
+  else {
+    prev->next = wip->next;
+  }
+  if (wqp->tail == wip) {
+    wqp->tail = prev;
+  }
+
+  wip->state = WQ_STATE_IDLE;
+  wip->wqp   = NULL;
+
+  return true;
+}
+
+/**
+ * @brief   Cancels a pending delayed work item.
+ * @details The item is removed from the queue or its delay is stopped.
+ *
+ * @param[in] dwp       pointer to a @p delayed_work_t structure
+ * @return              The operation result.
+ * @retval true         if the item has been cancelled.
+ * @retval false        if the item was not pending.
+ *
+ * @iclass
+ */
+bool chWQCancelDelayedI(delayed_work_t *dwp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(dwp != NULL);
+
+  if (dwp->item.state == WQ_STATE_DELAYED) {
+    chVTDoResetI(&dwp->vt);
+    dwp->item.state = WQ_STATE_IDLE;
+    dwp->item.wqp   = NULL;
+
+    return true;
+  }
+
+  return chWQCancelI(&dwp->item);
+}
+
+#endif /* CH_CFG_USE_WORKQUEUES == TRUE */
+
+/** @} */
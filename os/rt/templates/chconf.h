@@ -83,6 +83,27 @@
  */
 #define CH_CFG_TIME_QUANTUM                 0
 
+/**
+ * @brief   Earliest Deadline First scheduling.
+ * @details If enabled then threads can be given a period and a relative
+ *          deadline using @p chThdSetEDF(), ready EDF threads having the
+ *          same priority are scheduled in order of absolute deadline.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_EDF                      FALSE
+
+/**
+ * @brief   CPU budget reservations APIs.
+ * @details If enabled then threads can be given an execution budget to be
+ *          consumed in each period, a thread exhausting its budget is
+ *          demoted to a background priority until the next replenishment.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Not supported in tick-less mode.
+ */
+#define CH_CFG_USE_BUDGETS                  FALSE
+
 /**
  * @brief   Managed RAM size.
  * @details Size of the RAM area to be managed by the OS. If set to zero
@@ -150,6 +171,17 @@
  */
 #define CH_CFG_USE_REGISTRY                 TRUE
 
+/**
+ * @brief   Registry names hash index size.
+ * @details If greater than zero then the registry keeps an hash index of
+ *          the threads names with the specified number of buckets, it
+ *          must be a power of two.
+ *
+ * @note    The default is @p 0.
+ * @note    Requires @p CH_CFG_USE_REGISTRY.
+ */
+#define CH_CFG_REGISTRY_HASH_SIZE           0
+
 /**
  * @brief   Threads synchronization APIs.
  * @details If enabled then the @p chThdWait() function is included in
@@ -196,6 +228,16 @@
  */
 #define CH_CFG_USE_MUTEXES_RECURSIVE        FALSE
 
+/**
+ * @brief   Enables priority ceiling mutexes.
+ * @details Mutexes initialized with a ceiling priority raise the owner to
+ *          the ceiling on lock (immediate priority ceiling protocol).
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#define CH_CFG_USE_MUTEXES_CEILING          FALSE
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -216,6 +258,16 @@
  */
 #define CH_CFG_USE_CONDVARS_TIMEOUT         TRUE
 
+/**
+ * @brief   Reader/Writer locks APIs.
+ * @details If enabled then the reader/writer locks APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#define CH_CFG_USE_RWLOCKS                  FALSE
+
 /**
  * @brief   Events Flags APIs.
  * @details If enabled then the event flags APIs are included in the kernel.
@@ -294,6 +346,16 @@
  */
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 
+/**
+ * @brief   Objects FIFOs APIs.
+ * @details If enabled then the objects FIFOs APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_SEMAPHORES.
+ */
+#define CH_CFG_USE_OBJ_FIFOS                FALSE
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -305,6 +367,40 @@
  */
 #define CH_CFG_USE_DYNAMIC                  TRUE
 
+/**
+ * @brief   Working areas cache.
+ * @details If enabled then the working areas of the threads created from
+ *          the default heap are cached on release and reused by the next
+ *          threads requiring the same working area size.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#define CH_CFG_USE_WA_CACHE                 FALSE
+
+/**
+ * @brief   Number of size classes in the working areas cache.
+ *
+ * @note    The default is 4.
+ */
+#define CH_CFG_WA_CACHE_CLASSES             4
+
+/**
+ * @brief   Maximum number of cached working areas in each size class.
+ *
+ * @note    The default is 4.
+ */
+#define CH_CFG_WA_CACHE_DEPTH               4
+
+/**
+ * @brief   Work queues APIs.
+ * @details If enabled then the work queues APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_WORKQUEUES               FALSE
+
 /** @} */
 
 /*===========================================================================*/
@@ -321,6 +417,16 @@
  */
 #define CH_DBG_STATISTICS                   FALSE
 
+/**
+ * @brief   Debug option, critical zones profiler.
+ * @details If enabled then the call sites of the longest critical zones
+ *          are recorded.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_STATISTICS.
+ */
+#define CH_DBG_CRIT_PROFILER                FALSE
+
 /**
  * @brief   Debug option, system state check.
  * @details If enabled the correct call protocol for system APIs is checked
@@ -386,6 +492,17 @@
  */
 #define CH_DBG_FILL_THREADS                 TRUE
 
+/**
+ * @brief   Debug option, stack sentinel thread.
+ * @details If enabled then a thread at @p LOWPRIO periodically scans the
+ *          stacks of all the registered threads and records their minimum
+ *          headroom.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_FILL_THREADS and @p CH_CFG_USE_REGISTRY.
+ */
+#define CH_DBG_STACK_SENTINEL               FALSE
+
 /**
  * @brief   Debug option, threads profiling.
  * @details If enabled then a field is added to the @p thread_t structure that
@@ -0,0 +1,279 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    binlog.c
+ * @brief   Deferred binary logger code.
+ * @details Log calls store the format string address, a timestamp and the
+ *          raw arguments in a ring buffer, the buffer contents is written
+ *          to a stream by a drain function, formatting is performed on
+ *          the host by @p tools/binlog.py.
+ *          Each record is a sequence of little endian 32 bits words:
+ *          - Header, @p BLOG_MAGIC in bits 24..31, flags in bits 20..23,
+ *            the number of arguments in bits 16..19 and a sequence number
+ *            in bits 0..15.
+ *          - Format string address, zero for a lost records report whose
+ *            argument is the number of lost records.
+ *          - Timestamp.
+ *          - Arguments.
+ *          .
+ *
+ * @addtogroup binary_logger
+ * @{
+ */
+
+#include <stdarg.h>
+
+#include "hal.h"
+#include "binlog.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+#if PORT_SUPPORTS_RT == TRUE
+#define BLOG_TIMESTAMP()    (uint32_t)chSysGetRealtimeCounterX()
+#define BLOG_FLAGS          BLOG_FLAG_RTCNT
+#else
+#define BLOG_TIMESTAMP()    (uint32_t)chVTGetSystemTimeX()
+#define BLOG_FLAGS          0U
+#endif
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t blog_header(binlog_t *blp, unsigned n) {
+
+  return (BLOG_MAGIC << 24) | BLOG_FLAGS | ((uint32_t)n << 16) |
+         (blp->seq++ & 0xFFFFU);
+}
+
+#if defined(_CHIBIOS_RT_)
+static THD_FUNCTION(blog_thread, p) {
+  binlog_t *blp = p;
+
+  chRegSetThreadName("binlog");
+  while (!chThdShouldTerminateX()) {
+    (void) blogDrain(blp, blp->chp);
+    chThdSleepMilliseconds(BLOG_DRAIN_INTERVAL);
+  }
+
+  /* Last records before exiting.*/
+  (void) blogDrain(blp, blp->chp);
+}
+#endif
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p binlog_t structure.
+ *
+ * @param[out] blp      pointer to the @p binlog_t structure
+ * @param[in] buffer    pointer to the ring buffer
+ * @param[in] n         ring buffer size in words, it must be a power of two
+ *
+ * @init
+ */
+void blogObjectInit(binlog_t *blp, uint32_t *buffer, size_t n) {
+
+  chDbgCheck((blp != NULL) && (buffer != NULL) &&
+             (n >= BLOG_HEADER_WORDS + BLOG_MAX_ARGS) &&
+             ((n & (n - 1U)) == 0U));
+
+  blp->buffer  = buffer;
+  blp->mask    = (uint32_t)n - 1U;
+  blp->wridx   = 0U;
+  blp->rdidx   = 0U;
+  blp->seq     = 0U;
+  blp->dropped = 0U;
+  blp->chp     = NULL;
+  blp->thread  = NULL;
+}
+
+/**
+ * @brief   Writes a log record.
+ * @details If the ring buffer has no space for the record then the record
+ *          is lost and counted, the count is reported by the drain
+ *          function.
+ * @note    Use the @p blogPrintf() macro instead of calling this function
+ *          directly.
+ *
+ * @param[in] blp       pointer to the @p binlog_t structure
+ * @param[in] n         number of arguments
+ * @param[in] fmt       format string
+ * @param[in] ...       arguments, integers or pointers not larger than
+ *                      32 bits
+ *
+ * @xclass
+ */
+void blogWriteX(binlog_t *blp, unsigned n, const char *fmt, ...) {
+  va_list ap;
+  syssts_t sts;
+  uint32_t args[BLOG_MAX_ARGS];
+  uint32_t ts, i, mask, *bp;
+  unsigned k;
+
+  chDbgCheck((blp != NULL) && (n <= BLOG_MAX_ARGS));
+
+  /* Collecting the arguments outside the critical zone.*/
+  va_start(ap, fmt);
+  for (k = 0U; k < n; k++) {
+    args[k] = va_arg(ap, uint32_t);
+  }
+  va_end(ap);
+  ts = BLOG_TIMESTAMP();
+
+  sts = chSysGetStatusAndLockX();
+  i    = blp->wridx;
+  mask = blp->mask;
+  if ((mask + 1U) - (i - blp->rdidx) < BLOG_HEADER_WORDS + n) {
+    blp->dropped++;
+    chSysRestoreStatusX(sts);
+    return;
+  }
+  bp = blp->buffer;
+  bp[i++ & mask] = blog_header(blp, n);
+  bp[i++ & mask] = (uint32_t)(uintptr_t)fmt;
+  bp[i++ & mask] = ts;
+  for (k = 0U; k < n; k++) {
+    bp[i++ & mask] = args[k];
+  }
+  blp->wridx = i;
+  chSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Writes the pending records to a stream.
+ * @details The records are written in the order they have been recorded,
+ *          a lost records report follows if records were lost since the
+ *          previous call.
+ * @note    Only one thread at time can drain a logger.
+ *
+ * @param[in] blp       pointer to the @p binlog_t structure
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @return              The number of bytes written.
+ *
+ * @api
+ */
+size_t blogDrain(binlog_t *blp, BaseSequentialStream *chp) {
+  uint32_t wr, rd, off, n, dropped;
+  uint32_t rec[BLOG_HEADER_WORDS + 1U];
+  size_t total = 0U;
+
+  chDbgCheck((blp != NULL) && (chp != NULL));
+
+  chSysLock();
+  wr = blp->wridx;
+  dropped = blp->dropped;
+  blp->dropped = 0U;
+  if (dropped > 0U) {
+    rec[0] = blog_header(blp, 1U);
+  }
+  chSysUnlock();
+
+  /* The area between the read and write indexes is not touched by the
+     writers so it is written outside the critical zone, one contiguous
+     block at time.*/
+  rd = blp->rdidx;
+  while (rd != wr) {
+    off = rd & blp->mask;
+    n = wr - rd;
+    if (off + n > blp->mask + 1U) {
+      n = blp->mask + 1U - off;
+    }
+    (void) streamWrite(chp, (const uint8_t *)&blp->buffer[off],
+                       n * sizeof (uint32_t));
+    total += n * sizeof (uint32_t);
+    rd += n;
+
+    chSysLock();
+    blp->rdidx = rd;
+    chSysUnlock();
+  }
+
+  if (dropped > 0U) {
+    rec[1] = 0U;
+    rec[2] = BLOG_TIMESTAMP();
+    rec[3] = dropped;
+    (void) streamWrite(chp, (const uint8_t *)rec, sizeof (rec));
+    total += sizeof (rec);
+  }
+
+  return total;
+}
+
+#if defined(_CHIBIOS_RT_) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a drain thread.
+ * @details The thread writes the pending records to the stream every
+ *          @p BLOG_DRAIN_INTERVAL milliseconds, it should have a low
+ *          priority.
+ *
+ * @param[in] blp       pointer to the @p binlog_t structure
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[out] wsp      pointer to a working area dedicated to the thread
+ * @param[in] size      size of the working area
+ * @param[in] prio      the priority level for the thread
+ *
+ * @api
+ */
+void blogStart(binlog_t *blp, BaseSequentialStream *chp,
+               void *wsp, size_t size, tprio_t prio) {
+
+  chDbgCheck((blp != NULL) && (chp != NULL));
+  chDbgAssert(blp->thread == NULL, "already started");
+
+  blp->chp = chp;
+  blp->thread = chThdCreateStatic(wsp, size, prio, blog_thread, blp);
+}
+
+#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Stops the drain thread.
+ * @details The pending records are written before the thread exits.
+ *
+ * @param[in] blp       pointer to the @p binlog_t structure
+ *
+ * @api
+ */
+void blogStop(binlog_t *blp) {
+
+  chDbgCheck(blp != NULL);
+  chDbgAssert(blp->thread != NULL, "not started");
+
+  chThdTerminate(blp->thread);
+  (void) chThdWait(blp->thread);
+  blp->thread = NULL;
+}
+#endif
+#endif
+
+/** @} */
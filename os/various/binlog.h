@@ -0,0 +1,190 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    binlog.h
+ * @brief   Deferred binary logger structures and macros.
+ *
+ * @addtogroup binary_logger
+ * @{
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Marker in the most significant byte of each record header.
+ */
+#define BLOG_MAGIC                  0xA5U
+
+/**
+ * @brief   Maximum number of arguments of a log record.
+ */
+#define BLOG_MAX_ARGS               8U
+
+/**
+ * @brief   Number of header words of a log record.
+ * @details The record header is composed of a marker word, the address
+ *          of the format string and a timestamp.
+ */
+#define BLOG_HEADER_WORDS           3U
+
+/**
+ * @brief   Header flag, the timestamp is a realtime counter value.
+ * @details If not set then the timestamp is a system time value.
+ */
+#define BLOG_FLAG_RTCNT             0x100000U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Drain thread polling interval in milliseconds.
+ */
+#if !defined(BLOG_DRAIN_INTERVAL) || defined(__DOXYGEN__)
+#define BLOG_DRAIN_INTERVAL         10
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if BLOG_DRAIN_INTERVAL <= 0
+#error "invalid BLOG_DRAIN_INTERVAL value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a binary logger.
+ */
+typedef struct {
+  /**
+   * @brief   Ring buffer.
+   */
+  uint32_t              *buffer;
+  /**
+   * @brief   Ring buffer size mask, the size in words minus one.
+   */
+  uint32_t              mask;
+  /**
+   * @brief   Write index, free running.
+   */
+  uint32_t              wridx;
+  /**
+   * @brief   Read index, free running.
+   */
+  uint32_t              rdidx;
+  /**
+   * @brief   Records sequence counter.
+   */
+  uint32_t              seq;
+  /**
+   * @brief   Records lost because the ring was full.
+   */
+  uint32_t              dropped;
+  /**
+   * @brief   Output stream of the drain thread.
+   */
+  BaseSequentialStream  *chp;
+  /**
+   * @brief   Drain thread or @p NULL.
+   */
+  thread_t              *thread;
+} binlog_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Counts the arguments of a log call, format included.
+ * @details Calls with more than @p BLOG_MAX_ARGS arguments, up to 24 items,
+ *          expand to the undeclared @p _BLOG_TOO_MANY_ARGS identifier and
+ *          fail to compile.
+ * @notapi
+ */
+#define _BLOG_NARGS(...)                                                    \
+  _BLOG_NARGS_N(__VA_ARGS__,                                                \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS, _BLOG_TOO_MANY_ARGS,                   \
+                _BLOG_TOO_MANY_ARGS,                                        \
+                9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define _BLOG_NARGS_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12,    \
+                      _13, _14, _15, _16, _17, _18, _19, _20, _21, _22,     \
+                      _23, _24, n, ...) n
+
+/**
+ * @brief   Records a log line.
+ * @details The format string is not processed, the record contains the
+ *          address of the string and the raw arguments values. The
+ *          records are rendered by a host tool that reads the format
+ *          strings from the ELF file.
+ * @note    The arguments must be integers or pointers not larger than 32
+ *          bits, up to @p BLOG_MAX_ARGS arguments are allowed, more
+ *          arguments are a compile error.
+ * @note    Strings arguments must reside in the ELF file image, RAM
+ *          contents is not captured.
+ * @note    This macro can be used from any context.
+ *
+ * @param[in] blp       pointer to a @p binlog_t structure
+ * @param[in] ...       format string literal followed by the arguments
+ *
+ * @special
+ */
+#define blogPrintf(blp, ...)                                                \
+  blogWriteX(blp, (unsigned)_BLOG_NARGS(__VA_ARGS__) - 1U, __VA_ARGS__)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void blogObjectInit(binlog_t *blp, uint32_t *buffer, size_t n);
+  void blogWriteX(binlog_t *blp, unsigned n, const char *fmt, ...);
+  size_t blogDrain(binlog_t *blp, BaseSequentialStream *chp);
+#if defined(_CHIBIOS_RT_)
+  void blogStart(binlog_t *blp, BaseSequentialStream *chp,
+                 void *wsp, size_t size, tprio_t prio);
+#if CH_CFG_USE_WAITEXIT == TRUE
+  void blogStop(binlog_t *blp);
+#endif
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* BINLOG_H */
+
+/** @} */
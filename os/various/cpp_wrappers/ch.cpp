@@ -422,6 +422,13 @@ namespace chibios_rt {
     chMtxObjectInit(&mutex);
   }
 
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  Mutex::Mutex(tprio_t ceiling) {
+
+    chMtxObjectInitCeiling(&mutex, ceiling);
+  }
+#endif
+
   bool Mutex::tryLock(void) {
 
     return chMtxTryLock(&mutex);
@@ -498,6 +505,56 @@ namespace chibios_rt {
   }
 #endif /* CH_CFG_USE_CONDVARS_TIMEOUT */
 #endif /* CH_CFG_USE_CONDVARS */
+
+#if CH_CFG_USE_RWLOCKS
+  /*------------------------------------------------------------------------*
+   * chibios_rt::RWLock                                                     *
+   *------------------------------------------------------------------------*/
+  RWLock::RWLock(void) {
+
+    chRWLockObjectInit(&rwlock);
+  }
+
+  void RWLock::readLock(void) {
+
+    chRWLockReadLock(&rwlock);
+  }
+
+  void RWLock::readLockS(void) {
+
+    chRWLockReadLockS(&rwlock);
+  }
+
+  void RWLock::readUnlock(void) {
+
+    chRWLockReadUnlock(&rwlock);
+  }
+
+  void RWLock::readUnlockS(void) {
+
+    chRWLockReadUnlockS(&rwlock);
+  }
+
+  void RWLock::writeLock(void) {
+
+    chRWLockWriteLock(&rwlock);
+  }
+
+  void RWLock::writeLockS(void) {
+
+    chRWLockWriteLockS(&rwlock);
+  }
+
+  void RWLock::writeUnlock(void) {
+
+    chRWLockWriteUnlock(&rwlock);
+  }
+
+  void RWLock::writeUnlockS(void) {
+
+    chRWLockWriteUnlockS(&rwlock);
+  }
+#endif /* CH_CFG_USE_RWLOCKS */
 #endif /* CH_CFG_USE_MUTEXES */
 
 #if CH_CFG_USE_EVENTS
@@ -548,6 +605,16 @@ namespace chibios_rt {
 
     chEvtBroadcastFlagsI(&ev_source, flags);
   }
+
+  cnt_t EvtSource::broadcastFlagsMode(eventflags_t flags, evtbmode_t mode) {
+
+    return chEvtBroadcastFlagsMode(&ev_source, flags, mode);
+  }
+
+  cnt_t EvtSource::broadcastFlagsModeI(eventflags_t flags, evtbmode_t mode) {
+
+    return chEvtBroadcastFlagsModeI(&ev_source, flags, mode);
+  }
 #endif /* CH_CFG_USE_EVENTS */
 
 #if CH_CFG_USE_MEMPOOLS
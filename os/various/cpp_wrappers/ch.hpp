@@ -1278,6 +1278,19 @@ namespace chibios_rt {
      */
     Mutex(void);
 
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Priority ceiling mutex object constructor.
+     * @details The embedded @p ::Mutex structure is initialized with the
+     *          specified ceiling priority.
+     *
+     * @param[in] ceiling   the ceiling priority
+     *
+     * @init
+     */
+    Mutex(tprio_t ceiling);
+#endif
+
     /**
      * @brief   Tries to lock a mutex.
      * @details This function attempts to lock a mutex, if the mutex is already
@@ -1470,6 +1483,92 @@ namespace chibios_rt {
 #endif /* CH_CFG_USE_CONDVARS_TIMEOUT */
   };
 #endif /* CH_CFG_USE_CONDVARS */
+
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::RWLock                                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a reader/writer lock.
+   */
+  class RWLock {
+  public:
+    /**
+     * @brief   Embedded @p ::rwlock_t structure.
+     */
+    ::rwlock_t rwlock;
+
+    /**
+     * @brief   RWLock object constructor.
+     * @details The embedded @p ::rwlock_t structure is initialized.
+     *
+     * @init
+     */
+    RWLock(void);
+
+    /**
+     * @brief   Acquires the lock for reading.
+     *
+     * @api
+     */
+    void readLock(void);
+
+    /**
+     * @brief   Acquires the lock for reading.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel.
+     *
+     * @sclass
+     */
+    void readLockS(void);
+
+    /**
+     * @brief   Releases a read lock.
+     *
+     * @api
+     */
+    void readUnlock(void);
+
+    /**
+     * @brief   Releases a read lock.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel.
+     *
+     * @sclass
+     */
+    void readUnlockS(void);
+
+    /**
+     * @brief   Acquires the lock for writing.
+     *
+     * @api
+     */
+    void writeLock(void);
+
+    /**
+     * @brief   Acquires the lock for writing.
+     *
+     * @sclass
+     */
+    void writeLockS(void);
+
+    /**
+     * @brief   Releases a write lock.
+     *
+     * @api
+     */
+    void writeUnlock(void);
+
+    /**
+     * @brief   Releases a write lock.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel.
+     *
+     * @sclass
+     */
+    void writeUnlockS(void);
+  };
+#endif /* CH_CFG_USE_RWLOCKS */
 #endif /* CH_CFG_USE_MUTEXES */
 
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
@@ -1587,6 +1686,34 @@ namespace chibios_rt {
      * @iclass
      */
     void broadcastFlagsI(eventflags_t flags);
+
+    /**
+     * @brief   Broadcasts on an event source using a broadcast mode.
+     * @details The threads to be awakened are made ready in a single pass,
+     *          see @p chEvtBroadcastFlagsModeI().
+     *
+     * @param[in] flags         the flags set to be added to the listener
+     *                          flags mask
+     * @param[in] mode          the broadcast mode
+     * @return                  The number of threads made ready.
+     *
+     * @api
+     */
+    cnt_t broadcastFlagsMode(eventflags_t flags, evtbmode_t mode);
+
+    /**
+     * @brief   Broadcasts on an event source using a broadcast mode.
+     * @details The threads to be awakened are made ready in a single pass,
+     *          see @p chEvtBroadcastFlagsModeI().
+     *
+     * @param[in] flags         the flags set to be added to the listener
+     *                          flags mask
+     * @param[in] mode          the broadcast mode
+     * @return                  The number of threads made ready.
+     *
+     * @iclass
+     */
+    cnt_t broadcastFlagsModeI(eventflags_t flags, evtbmode_t mode);
   };
 #endif /* CH_CFG_USE_EVENTS */
 
@@ -2027,6 +2154,243 @@ namespace chibios_rt {
   };
 #endif /* CH_CFG_USE_MEMPOOLS */
 
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ObjectsFifo                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating an objects FIFO and its buffers.
+   *
+   * @param T               type of the exchanged objects
+   * @param N               number of objects
+   */
+  template<class T, size_t N>
+  class ObjectsFifo {
+  private:
+    /* The objects buffer is declared as an array of pointers to void for
+       the same reasons explained in ObjectsPool.*/
+    void *objs_buf[(N * sizeof (T)) / sizeof (void *)];
+    msg_t msg_buf[N];
+
+  public:
+    /**
+     * @brief   Embedded @p ::objects_fifo_t structure.
+     */
+    ::objects_fifo_t fifo;
+
+    /**
+     * @brief   ObjectsFifo constructor.
+     *
+     * @init
+     */
+    ObjectsFifo(void) {
+
+      chFifoObjectInit(&fifo, sizeof (T), N, objs_buf, msg_buf);
+    }
+
+    /**
+     * @brief   Takes a free object.
+     * @details This variant is non-blocking.
+     *
+     * @return              The pointer to the taken object.
+     * @retval NULL         if there are no free objects.
+     *
+     * @iclass
+     */
+    T *takeObjectI(void) {
+
+      return (T *)chFifoTakeObjectI(&fifo);
+    }
+
+    /**
+     * @brief   Takes a free object.
+     * @details The invoking thread waits until a free object becomes
+     *          available or the specified time runs out.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The pointer to the taken object.
+     * @retval NULL         if the operation timed out.
+     *
+     * @sclass
+     */
+    T *takeObjectTimeoutS(systime_t timeout) {
+
+      return (T *)chFifoTakeObjectTimeoutS(&fifo, timeout);
+    }
+
+    /**
+     * @brief   Takes a free object.
+     * @details The invoking thread waits until a free object becomes
+     *          available or the specified time runs out.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The pointer to the taken object.
+     * @retval NULL         if the operation timed out.
+     *
+     * @api
+     */
+    T *takeObjectTimeout(systime_t timeout) {
+
+      return (T *)chFifoTakeObjectTimeout(&fifo, timeout);
+    }
+
+    /**
+     * @brief   Returns a free object.
+     *
+     * @param[in] objp      pointer to the object to be returned
+     *
+     * @iclass
+     */
+    void returnObjectI(T *objp) {
+
+      chFifoReturnObjectI(&fifo, (void *)objp);
+    }
+
+    /**
+     * @brief   Returns a free object.
+     *
+     * @param[in] objp      pointer to the object to be returned
+     *
+     * @api
+     */
+    void returnObject(T *objp) {
+
+      chFifoReturnObject(&fifo, (void *)objp);
+    }
+
+    /**
+     * @brief   Sends an object.
+     *
+     * @param[in] objp      pointer to the object to be sent
+     *
+     * @iclass
+     */
+    void sendObjectI(T *objp) {
+
+      chFifoSendObjectI(&fifo, (void *)objp);
+    }
+
+    /**
+     * @brief   Sends an object.
+     *
+     * @param[in] objp      pointer to the object to be sent
+     *
+     * @sclass
+     */
+    void sendObjectS(T *objp) {
+
+      chFifoSendObjectS(&fifo, (void *)objp);
+    }
+
+    /**
+     * @brief   Sends an object.
+     *
+     * @param[in] objp      pointer to the object to be sent
+     *
+     * @api
+     */
+    void sendObject(T *objp) {
+
+      chFifoSendObject(&fifo, (void *)objp);
+    }
+
+    /**
+     * @brief   Receives an object.
+     * @details This variant is non-blocking.
+     *
+     * @param[out] objpp    pointer to the variable receiving the object
+     *                      pointer
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been correctly received.
+     * @retval MSG_TIMEOUT  if the queue is empty.
+     *
+     * @iclass
+     */
+    msg_t receiveObjectI(T **objpp) {
+
+      return chFifoReceiveObjectI(&fifo, (void **)objpp);
+    }
+
+    /**
+     * @brief   Receives an object.
+     * @details The invoking thread waits until an object is sent or the
+     *          specified time runs out.
+     *
+     * @param[out] objpp    pointer to the variable receiving the object
+     *                      pointer
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been correctly received.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @sclass
+     */
+    msg_t receiveObjectTimeoutS(T **objpp, systime_t timeout) {
+
+      return chFifoReceiveObjectTimeoutS(&fifo, (void **)objpp, timeout);
+    }
+
+    /**
+     * @brief   Receives an object.
+     * @details The invoking thread waits until an object is sent or the
+     *          specified time runs out.
+     *
+     * @param[out] objpp    pointer to the variable receiving the object
+     *                      pointer
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been correctly received.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t receiveObjectTimeout(T **objpp, systime_t timeout) {
+
+      return chFifoReceiveObjectTimeout(&fifo, (void **)objpp, timeout);
+    }
+
+    /**
+     * @brief   Returns the number of free objects.
+     *
+     * @return              The number of objects that can be taken.
+     *
+     * @iclass
+     */
+    cnt_t getFreeCountI(void) {
+
+      return chFifoGetFreeCountI(&fifo);
+    }
+
+    /**
+     * @brief   Returns the number of sent objects.
+     *
+     * @return              The number of objects waiting to be received.
+     *
+     * @iclass
+     */
+    cnt_t getUsedCountI(void) {
+
+      return chFifoGetUsedCountI(&fifo);
+    }
+  };
+#endif /* CH_CFG_USE_OBJ_FIFOS */
+
   /*------------------------------------------------------------------------*
    * chibios_rt::BaseSequentialStreamInterface                              *
    *------------------------------------------------------------------------*/
@@ -0,0 +1,545 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chmemory.hpp
+ * @brief   C++ standard allocators and memory resources.
+ * @details This header makes the ChibiOS memory allocators usable by the
+ *          standard containers, both as allocator templates and, when the
+ *          library supports C++17 polymorphic allocators, as
+ *          @p std::pmr::memory_resource implementations.
+ * @note    Allocation failures halt the system, exceptions are not used.
+ *
+ * @addtogroup cpp_library
+ * @{
+ */
+
+#include <stddef.h>
+#include <new>
+
+#include "ch.hpp"
+
+#ifndef _CHMEMORY_HPP_
+#define _CHMEMORY_HPP_
+
+#if __cplusplus < 201103L
+#error "chmemory.hpp requires C++11"
+#endif
+
+/**
+ * @brief   Polymorphic allocators support.
+ * @details Set to @p TRUE if the library provides @p <memory_resource>.
+ */
+#if !defined(CH_CPP_USE_PMR) || defined(__DOXYGEN__)
+#if (__cplusplus >= 201703L) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#define CH_CPP_USE_PMR                      TRUE
+#endif
+#endif
+#endif
+
+#if !defined(CH_CPP_USE_PMR)
+#define CH_CPP_USE_PMR                      FALSE
+#endif
+
+#if CH_CPP_USE_PMR == TRUE
+#include <memory_resource>
+#endif
+
+namespace chibios_rt {
+
+#if CH_CFG_USE_MEMCORE || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::MemoryArena                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Monotonic memory arena.
+   * @details Blocks are allocated by moving a pointer forward, they cannot
+   *          be freed individually, the whole arena is released at once
+   *          using @p reset().
+   */
+  class MemoryArena {
+  private:
+    uint8_t         *base;
+    uint8_t         *next;
+    uint8_t         *top;
+
+  public:
+    /**
+     * @brief   MemoryArena constructor.
+     *
+     * @param[in] p         pointer to the arena buffer
+     * @param[in] size      size of the arena buffer
+     *
+     * @init
+     */
+    MemoryArena(void *p, size_t size) :
+      base((uint8_t *)p), next((uint8_t *)p), top((uint8_t *)p + size) {
+    }
+
+    /**
+     * @brief   MemoryArena constructor.
+     * @details The arena buffer is taken from the core allocator, if the
+     *          core memory is exhausted then the arena is empty.
+     *
+     * @param[in] size      size of the arena
+     *
+     * @init
+     */
+    MemoryArena(size_t size) {
+      uint8_t *p = (uint8_t *)chCoreAlloc(size);
+
+      base = next = p;
+      top = p == NULL ? p : p + size;
+    }
+
+    /**
+     * @brief   Allocates a block from the arena.
+     *
+     * @param[in] size      size of the block
+     * @param[in] align     alignment of the block, must be a power of two
+     * @return              A pointer to the allocated block.
+     * @retval NULL         if the arena is exhausted.
+     *
+     * @iclass
+     */
+    void *allocI(size_t size, size_t align) {
+      uint8_t *p;
+
+      chDbgCheckClassI();
+      chDbgCheck(MEM_IS_VALID_ALIGNMENT(align));
+
+      p = (uint8_t *)MEM_ALIGN_NEXT(next, align);
+      if ((p > top) || (size > (size_t)(top - p))) {
+        return NULL;
+      }
+      next = p + size;
+
+      return p;
+    }
+
+    /**
+     * @brief   Allocates a block from the arena.
+     *
+     * @param[in] size      size of the block
+     * @param[in] align     alignment of the block, must be a power of two
+     * @return              A pointer to the allocated block.
+     * @retval NULL         if the arena is exhausted.
+     *
+     * @api
+     */
+    void *alloc(size_t size, size_t align) {
+      void *p;
+
+      chSysLock();
+      p = allocI(size, align);
+      chSysUnlock();
+
+      return p;
+    }
+
+    /**
+     * @brief   Releases all the blocks allocated from the arena.
+     * @pre     The blocks must no more be in use.
+     *
+     * @api
+     */
+    void reset(void) {
+
+      chSysLock();
+      next = base;
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Returns the free space in the arena.
+     *
+     * @return              The size, in bytes, of the free space.
+     *
+     * @xclass
+     */
+    size_t getFreeX(void) {
+
+      return (size_t)(top - next);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ArenaAllocator                                             *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Standard allocator on a @p MemoryArena.
+   * @details Deallocation has no effect, this allocator is meant for
+   *          containers built once or released together with the arena.
+   *
+   * @param T               type of the allocated objects
+   */
+  template<class T>
+  class ArenaAllocator {
+  public:
+    typedef T value_type;
+
+    /**
+     * @brief   Associated arena.
+     */
+    MemoryArena     *arena;
+
+    ArenaAllocator(MemoryArena &a) noexcept : arena(&a) {
+    }
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept :
+      arena(other.arena) {
+    }
+
+    T *allocate(size_t n) {
+      void *p = arena->alloc(n > 0U ? n * sizeof (T) : 1U, alignof (T));
+
+      if (p == NULL) {
+        chSysHalt("arena exhausted");
+      }
+      return (T *)p;
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+
+      (void)p;
+      (void)n;
+    }
+  };
+
+  template<class T, class U>
+  bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+
+    return a.arena == b.arena;
+  }
+
+  template<class T, class U>
+  bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+
+    return a.arena != b.arena;
+  }
+#endif /* CH_CFG_USE_MEMCORE */
+
+#if CH_CFG_USE_HEAP || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::HeapAllocator                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Standard allocator on a @p memory_heap_t.
+   *
+   * @param T               type of the allocated objects
+   */
+  template<class T>
+  class HeapAllocator {
+  public:
+    typedef T value_type;
+
+    /**
+     * @brief   Associated heap or @p NULL for the default heap.
+     */
+    memory_heap_t   *heap;
+
+    HeapAllocator(memory_heap_t *heapp = NULL) noexcept : heap(heapp) {
+    }
+
+    template<class U>
+    HeapAllocator(const HeapAllocator<U> &other) noexcept :
+      heap(other.heap) {
+    }
+
+    T *allocate(size_t n) {
+      void *p = chHeapAllocAligned(heap, n > 0U ? n * sizeof (T) : 1U,
+                                   (unsigned)alignof (T));
+
+      if (p == NULL) {
+        chSysHalt("heap exhausted");
+      }
+      return (T *)p;
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+
+      (void)n;
+      chHeapFree(p);
+    }
+  };
+
+  template<class T, class U>
+  bool operator==(const HeapAllocator<T> &a, const HeapAllocator<U> &b) {
+
+    return a.heap == b.heap;
+  }
+
+  template<class T, class U>
+  bool operator!=(const HeapAllocator<T> &a, const HeapAllocator<U> &b) {
+
+    return a.heap != b.heap;
+  }
+#endif /* CH_CFG_USE_HEAP */
+
+#if (CH_CFG_USE_MEMPOOLS && CH_CFG_USE_HEAP) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::PoolAllocator                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Standard allocator on a @p memory_pool_t.
+   * @details Requests fitting a pool object are served by the pool in
+   *          constant time, larger requests, for example the storage of a
+   *          @p std::vector, are served by the default heap.
+   * @note    Node based containers allocate one node at time, the pool
+   *          objects must be large enough to contain a node, the value
+   *          type size plus two or three pointers.
+   *
+   * @param T               type of the allocated objects
+   */
+  template<class T>
+  class PoolAllocator {
+  private:
+    bool fits(size_t n) const noexcept {
+
+      return (n * sizeof (T) <= pool->object_size) &&
+             (alignof (T) <= PORT_NATURAL_ALIGN);
+    }
+
+  public:
+    typedef T value_type;
+
+    /**
+     * @brief   Associated pool.
+     */
+    memory_pool_t   *pool;
+
+    PoolAllocator(memory_pool_t *mp) noexcept : pool(mp) {
+    }
+
+    PoolAllocator(MemoryPool &mp) noexcept : pool(&mp.pool) {
+    }
+
+    template<class U>
+    PoolAllocator(const PoolAllocator<U> &other) noexcept :
+      pool(other.pool) {
+    }
+
+    T *allocate(size_t n) {
+      void *p;
+
+      if (fits(n)) {
+        p = chPoolAlloc(pool);
+      }
+      else {
+        p = chHeapAllocAligned(NULL, n * sizeof (T), (unsigned)alignof (T));
+      }
+      if (p == NULL) {
+        chSysHalt("pool exhausted");
+      }
+      return (T *)p;
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+
+      if (fits(n)) {
+        chPoolFree(pool, p);
+      }
+      else {
+        chHeapFree(p);
+      }
+    }
+  };
+
+  template<class T, class U>
+  bool operator==(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+
+    return a.pool == b.pool;
+  }
+
+  template<class T, class U>
+  bool operator!=(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+
+    return a.pool != b.pool;
+  }
+#endif /* CH_CFG_USE_MEMPOOLS && CH_CFG_USE_HEAP */
+
+#if (CH_CPP_USE_PMR == TRUE) || defined(__DOXYGEN__)
+#if CH_CFG_USE_HEAP || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::HeapResource                                               *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Memory resource on a @p memory_heap_t.
+   */
+  class HeapResource : public std::pmr::memory_resource {
+  private:
+    memory_heap_t   *heap;
+
+  protected:
+    void *do_allocate(size_t bytes, size_t align) override {
+      void *p = chHeapAllocAligned(heap, bytes > 0U ? bytes : 1U,
+                                   (unsigned)align);
+
+      if (p == NULL) {
+        chSysHalt("heap exhausted");
+      }
+      return p;
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t align) override {
+
+      (void)bytes;
+      (void)align;
+      chHeapFree(p);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+
+      return this == &other;
+    }
+
+  public:
+    /**
+     * @brief   HeapResource constructor.
+     *
+     * @param[in] heapp     pointer to a heap or @p NULL for the default heap
+     *
+     * @init
+     */
+    HeapResource(memory_heap_t *heapp = NULL) noexcept : heap(heapp) {
+    }
+  };
+#endif /* CH_CFG_USE_HEAP */
+
+#if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::PoolResource                                               *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Memory resource on a @p memory_pool_t.
+   * @details Requests fitting a pool object are served by the pool, other
+   *          requests are forwarded to an upstream resource.
+   */
+  class PoolResource : public std::pmr::memory_resource {
+  private:
+    memory_pool_t               *pool;
+    std::pmr::memory_resource   *upstream;
+
+    bool fits(size_t bytes, size_t align) const noexcept {
+
+      return (bytes <= pool->object_size) && (align <= PORT_NATURAL_ALIGN);
+    }
+
+  protected:
+    void *do_allocate(size_t bytes, size_t align) override {
+      void *p;
+
+      if (fits(bytes, align)) {
+        p = chPoolAlloc(pool);
+        if (p == NULL) {
+          chSysHalt("pool exhausted");
+        }
+        return p;
+      }
+      return upstream->allocate(bytes, align);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t align) override {
+
+      if (fits(bytes, align)) {
+        chPoolFree(pool, p);
+      }
+      else {
+        upstream->deallocate(p, bytes, align);
+      }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+
+      return this == &other;
+    }
+
+  public:
+    /**
+     * @brief   PoolResource constructor.
+     *
+     * @param[in] mp        pointer to the memory pool
+     * @param[in] up        resource serving the requests not fitting the
+     *                      pool objects
+     *
+     * @init
+     */
+    PoolResource(memory_pool_t *mp,
+                 std::pmr::memory_resource *up =
+                   std::pmr::get_default_resource()) noexcept :
+      pool(mp), upstream(up) {
+    }
+  };
+#endif /* CH_CFG_USE_MEMPOOLS */
+
+#if CH_CFG_USE_MEMCORE || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ArenaResource                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Memory resource on a @p MemoryArena.
+   * @details Deallocation has no effect, the memory is recovered using
+   *          @p MemoryArena::reset().
+   */
+  class ArenaResource : public std::pmr::memory_resource {
+  private:
+    MemoryArena     *arena;
+
+  protected:
+    void *do_allocate(size_t bytes, size_t align) override {
+      void *p = arena->alloc(bytes, align);
+
+      if (p == NULL) {
+        chSysHalt("arena exhausted");
+      }
+      return p;
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t align) override {
+
+      (void)p;
+      (void)bytes;
+      (void)align;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+
+      return this == &other;
+    }
+
+  public:
+    /**
+     * @brief   ArenaResource constructor.
+     *
+     * @param[in] a         the arena
+     *
+     * @init
+     */
+    ArenaResource(MemoryArena &a) noexcept : arena(&a) {
+    }
+  };
+#endif /* CH_CFG_USE_MEMCORE */
+#endif /* CH_CPP_USE_PMR == TRUE */
+}
+
+#endif /* _CHMEMORY_HPP_ */
+
+/** @} */
@@ -1,5 +1,7 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
+#include <new>
 
 #include "osal.h"
 
@@ -39,3 +41,58 @@ void __cxa_pure_virtual() {
 #ifdef __cplusplus
 }
 #endif
+
+#if defined(SYSCALLS_USE_CH_MALLOC) && (SYSCALLS_USE_CH_MALLOC == TRUE)
+/*
+ * Operators new and delete go straight to the allocator in syscalls.c,
+ * the library versions would bring in the exceptions support. An
+ * allocation failure halts the system.
+ */
+void *operator new(size_t size) {
+  void *p = malloc(size);
+
+  if (p == NULL) {
+    osalSysHalt("operator new failure");
+  }
+  return p;
+}
+
+void *operator new[](size_t size) {
+
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+
+  return malloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+
+  return malloc(size);
+}
+
+void operator delete(void *p) noexcept {
+
+  free(p);
+}
+
+void operator delete[](void *p) noexcept {
+
+  free(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *p, size_t size) noexcept {
+
+  (void)size;
+  free(p);
+}
+
+void operator delete[](void *p, size_t size) noexcept {
+
+  (void)size;
+  free(p);
+}
+#endif
+#endif /* SYSCALLS_USE_CH_MALLOC == TRUE */
@@ -0,0 +1,197 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    memp_arch.c
+ * @brief   lwIP memory pools on ChibiOS guarded memory pools.
+ * @details This module replaces lwIP's @p core/memp.c, each lwIP pool is
+ *          mapped on a @p guarded_memory_pool_t loaded with static storage
+ *          so that the number of free objects of each pool can be read
+ *          using @p chGuardedPoolGetCounterI().
+ * @note    The module is used in place of @p core/memp.c when
+ *          @p USE_LWIP_CHIBIOS_MEMP is set to @p yes in the makefile.
+ *
+ * @addtogroup LWIP_THREAD
+ * @{
+ */
+
+#include "hal.h"
+
+#include "lwip/opt.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/raw.h"
+#include "lwip/tcp_impl.h"
+#include "lwip/igmp.h"
+#include "lwip/api.h"
+#include "lwip/api_msg.h"
+#include "lwip/tcpip.h"
+#include "lwip/sys.h"
+#include "lwip/timers.h"
+#include "lwip/stats.h"
+#include "netif/etharp.h"
+#include "lwip/ip_frag.h"
+#include "lwip/snmp_structs.h"
+#include "lwip/snmp_msg.h"
+#include "lwip/dns.h"
+#include "netif/ppp_oe.h"
+
+#if (CH_CFG_USE_MEMPOOLS == FALSE) || (CH_CFG_USE_SEMAPHORES == FALSE)
+#error "memp_arch.c requires CH_CFG_USE_MEMPOOLS and CH_CFG_USE_SEMAPHORES"
+#endif
+
+#if MEMP_MEM_MALLOC
+#error "memp_arch.c cannot be used with MEMP_MEM_MALLOC"
+#endif
+
+#if MEMP_OVERFLOW_CHECK
+#error "memp_arch.c does not support MEMP_OVERFLOW_CHECK"
+#endif
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Aligned object size, required by @p lwip/memp_std.h.
+ * @note    Same definition of @p core/memp.c without overflow checks.
+ */
+#define MEMP_ALIGN_SIZE(x)  LWIP_MEM_ALIGN_SIZE(x)
+
+/**
+ * @brief   Size of a pool object in @p stkalign_t units.
+ */
+#define MEMP_ARCH_WORDS(size)                                               \
+  ((LWIP_MEM_ALIGN_SIZE(size) + sizeof (stkalign_t) - 1U) /                 \
+   sizeof (stkalign_t))
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Static description of an lwIP pool.
+ */
+typedef struct {
+  stkalign_t            *base;          /**< @brief Objects storage.        */
+  size_t                size;           /**< @brief Object size in bytes.   */
+  size_t                num;            /**< @brief Number of objects.      */
+} memp_arch_desc_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/* Objects storage, one array for each pool.*/
+#define LWIP_MEMPOOL(name, num, size, desc)                                 \
+  static stkalign_t memp_storage_##name[(num) * MEMP_ARCH_WORDS(size)];
+#include "lwip/memp_std.h"
+
+/* Pools descriptions, in memp_t order.*/
+static const memp_arch_desc_t memp_descs[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc)                                 \
+  {memp_storage_##name, MEMP_ARCH_WORDS(size) * sizeof (stkalign_t), (num)},
+#include "lwip/memp_std.h"
+};
+
+/* The pools.*/
+static guarded_memory_pool_t memp_pools[MEMP_MAX];
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the lwIP pools.
+ * @note    Called by @p lwip_init().
+ */
+void memp_init(void) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)MEMP_MAX; i++) {
+    chGuardedPoolObjectInit(&memp_pools[i], memp_descs[i].size);
+    chGuardedPoolLoadArray(&memp_pools[i], memp_descs[i].base,
+                           memp_descs[i].num);
+    MEMP_STATS_AVAIL(avail, i, memp_descs[i].num);
+  }
+}
+
+/**
+ * @brief   Allocates an object from an lwIP pool.
+ * @note    This function can be called from any context.
+ *
+ * @param[in] type      the pool identifier
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if the pool is empty.
+ */
+void *memp_malloc(memp_t type) {
+  void *memp;
+  syssts_t sts;
+
+  LWIP_ERROR("memp_malloc: type < MEMP_MAX", (type < MEMP_MAX), return NULL;);
+
+  /* The kernel lock is taken regardless of SYS_LIGHTWEIGHT_PROT, the pool
+     functions are I-class.*/
+  sts = chSysGetStatusAndLockX();
+  memp = chGuardedPoolAllocI(&memp_pools[type]);
+  if (memp != NULL) {
+    MEMP_STATS_INC_USED(used, type);
+  }
+  else {
+    MEMP_STATS_INC(err, type);
+  }
+  chSysRestoreStatusX(sts);
+
+  return memp;
+}
+
+/**
+ * @brief   Returns an object to an lwIP pool.
+ * @note    This function can be called from any context.
+ *
+ * @param[in] type      the pool identifier
+ * @param[in] mem       the object to be released
+ */
+void memp_free(memp_t type, void *mem) {
+  syssts_t sts;
+
+  if (mem == NULL) {
+    return;
+  }
+
+  sts = chSysGetStatusAndLockX();
+  MEMP_STATS_DEC(used, type);
+  chGuardedPoolFreeI(&memp_pools[type], mem);
+  chSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Returns the ChibiOS pool backing an lwIP pool.
+ * @details The number of free objects can be read using
+ *          @p chGuardedPoolGetCounterI() on the returned pool.
+ *
+ * @param[in] type      the pool identifier, a @p memp_t value
+ * @return              The pointer to the guarded memory pool.
+ */
+guarded_memory_pool_t *memp_arch_get_pool(unsigned type) {
+
+  chDbgCheck(type < (unsigned)MEMP_MAX);
+
+  return &memp_pools[type];
+}
+
+/** @} */
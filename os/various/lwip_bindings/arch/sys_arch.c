@@ -60,8 +60,36 @@
 #include "arch/cc.h"
 #include "arch/sys_arch.h"
 
+#if SYS_MBOX_POOL_NUM > 0
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "SYS_MBOX_POOL_NUM requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if SYS_MBOX_POOL_SIZE <= 0
+#error "invalid SYS_MBOX_POOL_SIZE value"
+#endif
+
+/* Size of a pooled mailbox, header and buffer, in stkalign_t units.*/
+#define SYS_MBOX_POOL_WORDS                                                 \
+  ((sizeof (mailbox_t) + sizeof (msg_t) * SYS_MBOX_POOL_SIZE +              \
+    sizeof (stkalign_t) - 1U) / sizeof (stkalign_t))
+
+static memory_pool_t mbox_pool;
+static stkalign_t mbox_storage[SYS_MBOX_POOL_NUM][SYS_MBOX_POOL_WORDS];
+
+static bool mbox_is_pooled(mailbox_t *mbp) {
+
+  return ((uint8_t *)mbp >= (uint8_t *)mbox_storage) &&
+         ((uint8_t *)mbp < (uint8_t *)mbox_storage + sizeof (mbox_storage));
+}
+#endif
+
 void sys_init(void) {
 
+#if SYS_MBOX_POOL_NUM > 0
+  chPoolObjectInit(&mbox_pool, sizeof (mbox_storage[0]), NULL);
+  chPoolLoadArray(&mbox_pool, mbox_storage, SYS_MBOX_POOL_NUM);
+#endif
 }
 
 err_t sys_sem_new(sys_sem_t *sem, u8_t count) {
@@ -124,9 +152,17 @@ void sys_sem_set_invalid(sys_sem_t *sem) {
 }
 
 err_t sys_mbox_new(sys_mbox_t *mbox, int size) {
-  
-  *mbox = chHeapAlloc(NULL, sizeof(mailbox_t) + sizeof(msg_t) * size);
-  if (*mbox == 0) {
+
+  *mbox = NULL;
+#if SYS_MBOX_POOL_NUM > 0
+  if (size <= SYS_MBOX_POOL_SIZE) {
+    *mbox = chPoolAlloc(&mbox_pool);
+  }
+#endif
+  if (*mbox == NULL) {
+    *mbox = chHeapAlloc(NULL, sizeof(mailbox_t) + sizeof(msg_t) * size);
+  }
+  if (*mbox == NULL) {
     SYS_STATS_INC(mbox.err);
     return ERR_MEM;
   }
@@ -151,6 +187,11 @@ void sys_mbox_free(sys_mbox_t *mbox) {
     SYS_STATS_INC(mbox.err);
     chMBReset(*mbox);
   }
+#if SYS_MBOX_POOL_NUM > 0
+  if (mbox_is_pooled(*mbox))
+    chPoolFree(&mbox_pool, *mbox);
+  else
+#endif
   chHeapFree(*mbox);
   *mbox = SYS_MBOX_NULL;
   SYS_STATS_DEC(mbox.used);
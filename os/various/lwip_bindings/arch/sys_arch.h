@@ -65,4 +65,33 @@ typedef syssts_t        sys_prot_t;
 /* let sys.h use binary semaphores for mutexes */
 #define LWIP_COMPAT_MUTEX 1
 
+/**
+ * @brief   Number of mailboxes allocated from a dedicated pool.
+ * @details Mailboxes not fitting the pool, or created when the pool is
+ *          exhausted, are allocated from the default heap.
+ * @note    The default is zero, all mailboxes are allocated from the
+ *          default heap.
+ */
+#if !defined(SYS_MBOX_POOL_NUM) || defined(__DOXYGEN__)
+#define SYS_MBOX_POOL_NUM   0
+#endif
+
+/**
+ * @brief   Capacity, in messages, of the pooled mailboxes.
+ * @note    The default is @p TCPIP_MBOX_SIZE.
+ */
+#if !defined(SYS_MBOX_POOL_SIZE) || defined(__DOXYGEN__)
+#define SYS_MBOX_POOL_SIZE  TCPIP_MBOX_SIZE
+#endif
+
+#if (CH_CFG_USE_MEMPOOLS == TRUE) && (CH_CFG_USE_SEMAPHORES == TRUE)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  guarded_memory_pool_t *memp_arch_get_pool(unsigned type);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
 #endif /* __SYS_ARCH_H__ */
@@ -13,7 +13,6 @@ LWCORESRC = \
         $(LWIP)/src/core/dns.c \
         $(LWIP)/src/core/init.c \
         $(LWIP)/src/core/mem.c \
-        $(LWIP)/src/core/memp.c \
         $(LWIP)/src/core/netif.c \
         $(LWIP)/src/core/pbuf.c \
         $(LWIP)/src/core/raw.c \
@@ -24,6 +23,13 @@ LWCORESRC = \
         $(LWIP)/src/core/tcp_out.c \
         $(LWIP)/src/core/udp.c
 
+# lwIP pools on ChibiOS memory pools.
+ifeq ($(USE_LWIP_CHIBIOS_MEMP),yes)
+LWBINDSRC += $(CHIBIOS)/os/various/lwip_bindings/arch/memp_arch.c
+else
+LWCORESRC += $(LWIP)/src/core/memp.c
+endif
+
 LWIPV4SRC = \
         $(LWIP)/src/core/ipv4/autoip.c \
         $(LWIP)/src/core/ipv4/icmp.c \
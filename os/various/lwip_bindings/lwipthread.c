@@ -224,7 +224,7 @@ static THD_FUNCTION(lwip_thread, p) {
   event_listener_t el0, el1;
   struct ip_addr ip, gateway, netmask;
   static struct netif thisif;
-  static const MACConfig mac_config = {thisif.hwaddr};
+  static const MACConfig mac_config = {.mac_address = thisif.hwaddr};
 
   chRegSetThreadName("lwipthread");
 
@@ -293,6 +293,11 @@ static THD_FUNCTION(lwip_thread, p) {
     }
     if (mask & FRAME_RECEIVED_ID) {
       struct pbuf *p;
+#if LWIP_THREAD_DIRECT_INPUT == TRUE
+      /* All the frames ready in the MAC are processed in this thread with
+         a single acquisition of the core lock.*/
+      LOCK_TCPIP_CORE();
+#endif
       while ((p = low_level_input(&thisif)) != NULL) {
         struct eth_hdr *ethhdr = p->payload;
         switch (htons(ethhdr->type)) {
@@ -304,14 +309,23 @@ static THD_FUNCTION(lwip_thread, p) {
         case ETHTYPE_PPPOEDISC:
         case ETHTYPE_PPPOE:
 #endif /* PPPOE_SUPPORT */
+#if LWIP_THREAD_DIRECT_INPUT == TRUE
+          /* full packet processed here under the core lock */
+          if (ethernet_input(p, &thisif) == ERR_OK)
+            break;
+#else
           /* full packet send to tcpip_thread to process */
           if (thisif.input(p, &thisif) == ERR_OK)
             break;
+#endif
           LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
         default:
           pbuf_free(p);
         }
       }
+#if LWIP_THREAD_DIRECT_INPUT == TRUE
+      UNLOCK_TCPIP_CORE();
+#endif
     }
   }
 }
@@ -75,6 +75,19 @@
 #define LWIP_SEND_TIMEOUT                   50
 #endif
 
+/**
+ * @brief   Direct input of received frames.
+ * @details If enabled then the received frames are processed by the lwIP
+ *          thread itself while holding the lwIP core lock instead of being
+ *          posted one by one to the tcpip thread. The lock is taken once
+ *          for all the frames ready in the MAC, this saves a mailbox
+ *          operation and a context switch for each frame.
+ * @note    Requires @p LWIP_TCPIP_CORE_LOCKING in @p lwipopts.h.
+ */
+#if !defined(LWIP_THREAD_DIRECT_INPUT) || defined(__DOXYGEN__)
+#define LWIP_THREAD_DIRECT_INPUT            FALSE
+#endif
+
 /**
  * @brief   Link speed.
  */
@@ -138,6 +151,10 @@
 #define LWIP_IFNAME1                        's'
 #endif
 
+#if (LWIP_THREAD_DIRECT_INPUT == TRUE) && !LWIP_TCPIP_CORE_LOCKING
+#error "LWIP_THREAD_DIRECT_INPUT requires LWIP_TCPIP_CORE_LOCKING"
+#endif
+
 /**
  * @brief   Runtime TCP/IP settings.
  */
@@ -170,6 +170,121 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
 }
 #endif
 
+#if (SHELL_CMD_MUTEXES_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_mutexes(BaseSequentialStream *chp, int argc, char *argv[]) {
+  mutex_t *mp;
+  mutex_stats_t stats;
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "mutexes");
+    return;
+  }
+  chprintf(chp, "    addr      locks  contended  wait(kcyc)         name"SHELL_NEWLINE_STR);
+  chSysLock();
+  mp = chMtxStatsFirstI();
+  while (mp != NULL) {
+    /* The statistics are copied in the critical zone and printed outside
+       of it.*/
+    stats = mp->stats;
+    chSysUnlock();
+
+    chprintf(chp, "%08lx %10lu %10lu %11lu %12s"SHELL_NEWLINE_STR,
+             (uint32_t)mp, (uint32_t)stats.n_lock,
+             (uint32_t)stats.n_contended,
+             (uint32_t)(stats.wait / (rttime_t)1000), stats.name);
+
+    /* The cursor is only followed if the mutex is still registered, if
+       not then its link is no more part of the list.*/
+    chSysLock();
+    if (mp->stats.name == NULL) {
+      break;
+    }
+    mp = chMtxStatsNextI(mp);
+  }
+  chSysUnlock();
+}
+#endif
+
+#if (SHELL_CMD_BUDGETS_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_budgets(BaseSequentialStream *chp, int argc, char *argv[]) {
+  thread_t *tp;
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "budgets");
+    return;
+  }
+  chprintf(chp, "    addr   budget   period   used   consumed  overruns thr         name"SHELL_NEWLINE_STR);
+  tp = chRegFirstThread();
+  do {
+    if (tp->budget.budget > (systime_t)0) {
+      chprintf(chp, "%08lx %8lu %8lu %6lu %10lu %9lu %3s %12s"SHELL_NEWLINE_STR,
+               (uint32_t)tp, (uint32_t)tp->budget.budget,
+               (uint32_t)tp->budget.period, (uint32_t)chBudgetGetUsedX(tp),
+               (uint32_t)chBudgetGetConsumedX(tp),
+               (uint32_t)chBudgetGetOverrunsX(tp),
+               chBudgetIsThrottledX(tp) ? "yes" : "no",
+               tp->name == NULL ? "" : tp->name);
+    }
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+}
+#endif
+
+#if (SHELL_CMD_WACACHE_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_wacache(BaseSequentialStream *chp, int argc, char *argv[]) {
+  wa_cache_stats_t stats;
+  unsigned i;
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "wacache");
+    return;
+  }
+  chprintf(chp, "    size cached     reused  allocated    dropped reuse%%"SHELL_NEWLINE_STR);
+  for (i = 0U; i < (unsigned)CH_CFG_WA_CACHE_CLASSES; i++) {
+    uint32_t total;
+
+    if (!chThdCacheGetStats(i, &stats)) {
+      continue;
+    }
+    total = (uint32_t)stats.n_reused + (uint32_t)stats.n_allocated;
+    chprintf(chp, "%8lu %6lu %10lu %10lu %10lu %6lu"SHELL_NEWLINE_STR,
+             (uint32_t)stats.size, (uint32_t)stats.n_cached,
+             (uint32_t)stats.n_reused, (uint32_t)stats.n_allocated,
+             (uint32_t)stats.n_dropped,
+             total > 0U ? ((uint32_t)stats.n_reused * 100U) / total : 0U);
+  }
+}
+#endif
+
+#if (SHELL_CMD_CRIT_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_crit(BaseSequentialStream *chp, int argc, char *argv[]) {
+  crit_site_t sites[CH_DBG_CRIT_PROFILER_SIZE];
+  unsigned i, n;
+
+  if ((argc > 1) || ((argc == 1) && (strcmp(argv[0], "reset") != 0))) {
+    shellUsage(chp, "crit [reset]");
+    return;
+  }
+  if (argc == 1) {
+    chStatsResetCritSites();
+    return;
+  }
+  chprintf(chp, "worst thd %lu isr %lu cycles"SHELL_NEWLINE_STR,
+           (uint32_t)ch.kernel_stats.m_crit_thd.worst,
+           (uint32_t)ch.kernel_stats.m_crit_isr.worst);
+  chprintf(chp, "    site       hits  worst(cyc) ctx"SHELL_NEWLINE_STR);
+  n = chStatsGetCritSites(sites, CH_DBG_CRIT_PROFILER_SIZE);
+  for (i = 0U; i < n; i++) {
+    chprintf(chp, "%08lx %10lu %11lu %s"SHELL_NEWLINE_STR,
+             (uint32_t)sites[i].site, (uint32_t)sites[i].n,
+             (uint32_t)sites[i].worst, sites[i].isr ? "isr" : "thd");
+  }
+}
+#endif
+
 #if (SHELL_CMD_TEST_ENABLED == TRUE) || defined(__DOXYGEN__)
 static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
   thread_t *tp;
@@ -216,6 +331,18 @@ ShellCommand shell_local_commands[] = {
 #if SHELL_CMD_THREADS_ENABLED == TRUE
   {"threads", cmd_threads},
 #endif
+#if SHELL_CMD_MUTEXES_ENABLED == TRUE
+  {"mutexes", cmd_mutexes},
+#endif
+#if SHELL_CMD_BUDGETS_ENABLED == TRUE
+  {"budgets", cmd_budgets},
+#endif
+#if SHELL_CMD_WACACHE_ENABLED == TRUE
+  {"wacache", cmd_wacache},
+#endif
+#if SHELL_CMD_CRIT_ENABLED == TRUE
+  {"crit", cmd_crit},
+#endif
 #if SHELL_CMD_TEST_ENABLED == TRUE
   {"test", cmd_test},
 #endif
@@ -57,6 +57,22 @@
 #define SHELL_CMD_THREADS_ENABLED           TRUE
 #endif
 
+#if !defined(SHELL_CMD_MUTEXES_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_MUTEXES_ENABLED           FALSE
+#endif
+
+#if !defined(SHELL_CMD_BUDGETS_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_BUDGETS_ENABLED           FALSE
+#endif
+
+#if !defined(SHELL_CMD_WACACHE_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_WACACHE_ENABLED           FALSE
+#endif
+
+#if !defined(SHELL_CMD_CRIT_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_CRIT_ENABLED              FALSE
+#endif
+
 #if !defined(SHELL_CMD_TEST_ENABLED) || defined(__DOXYGEN__)
 #define SHELL_CMD_TEST_ENABLED              TRUE
 #endif
@@ -81,6 +97,25 @@
 #error "SHELL_CMD_THREADS_ENABLED requires CH_CFG_USE_REGISTRY"
 #endif
 
+#if (SHELL_CMD_MUTEXES_ENABLED == TRUE) &&                                  \
+    ((CH_CFG_USE_MUTEXES == FALSE) || (CH_DBG_STATISTICS == FALSE))
+#error "SHELL_CMD_MUTEXES_ENABLED requires CH_CFG_USE_MUTEXES and CH_DBG_STATISTICS"
+#endif
+
+#if (SHELL_CMD_BUDGETS_ENABLED == TRUE) &&                                  \
+    ((CH_CFG_USE_REGISTRY == FALSE) || (CH_CFG_USE_BUDGETS == FALSE))
+#error "SHELL_CMD_BUDGETS_ENABLED requires CH_CFG_USE_REGISTRY and CH_CFG_USE_BUDGETS"
+#endif
+
+#if (SHELL_CMD_WACACHE_ENABLED == TRUE) &&                                  \
+    ((CH_CFG_USE_DYNAMIC == FALSE) || (CH_CFG_USE_WA_CACHE == FALSE))
+#error "SHELL_CMD_WACACHE_ENABLED requires CH_CFG_USE_DYNAMIC and CH_CFG_USE_WA_CACHE"
+#endif
+
+#if (SHELL_CMD_CRIT_ENABLED == TRUE) && (CH_DBG_CRIT_PROFILER == FALSE)
+#error "SHELL_CMD_CRIT_ENABLED requires CH_DBG_CRIT_PROFILER"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
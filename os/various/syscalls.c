@@ -65,6 +65,54 @@
 #include "hal.h"
 #endif
 
+/*
+ * If SYSCALLS_USE_CH_MALLOC is TRUE then malloc(), free(), realloc() and
+ * calloc(), and so the C++ operators new and delete, are served by this
+ * module instead of the newlib allocator. Small blocks are taken from
+ * fixed size pools, one for each size class, larger blocks are taken from
+ * the ChibiOS default heap.
+ * Allocations attempted before chSysInit(), for example from C++ static
+ * constructors, fail with ENOMEM because neither the core allocator nor
+ * the default heap are initialized yet.
+ * If FALSE then the newlib allocator is used on top of _sbrk_r() and its
+ * lock is mapped on a kernel mutex.
+ */
+#if !defined(SYSCALLS_USE_CH_MALLOC)
+#define SYSCALLS_USE_CH_MALLOC      FALSE
+#endif
+
+/*
+ * Number of size classes served by memory pools.
+ */
+#if !defined(SYSCALLS_MALLOC_POOLS)
+#define SYSCALLS_MALLOC_POOLS       4
+#endif
+
+/*
+ * Size of the smallest size class, each class is twice the size of the
+ * previous one.
+ */
+#if !defined(SYSCALLS_MALLOC_POOL_MIN)
+#define SYSCALLS_MALLOC_POOL_MIN    8
+#endif
+
+#if SYSCALLS_USE_CH_MALLOC == TRUE
+#if (CH_CFG_USE_HEAP == FALSE) || (CH_CFG_USE_MEMPOOLS == FALSE) ||         \
+    (CH_CFG_USE_MEMCORE == FALSE)
+#error "SYSCALLS_USE_CH_MALLOC requires CH_CFG_USE_HEAP, "                   \
+       "CH_CFG_USE_MEMPOOLS and CH_CFG_USE_MEMCORE"
+#endif
+
+#if (SYSCALLS_MALLOC_POOLS < 1) || (SYSCALLS_MALLOC_POOLS > 16)
+#error "invalid SYSCALLS_MALLOC_POOLS value"
+#endif
+
+#if (SYSCALLS_MALLOC_POOL_MIN <= 0) ||                                       \
+    ((SYSCALLS_MALLOC_POOL_MIN & (SYSCALLS_MALLOC_POOL_MIN - 1)) != 0)
+#error "SYSCALLS_MALLOC_POOL_MIN must be a power of two"
+#endif
+#endif
+
 /***************************************************************************/
 
 int _read_r(struct _reent *r, int file, char * ptr, int len)
@@ -149,6 +197,322 @@ caddr_t _sbrk_r(struct _reent *r, int incr)
 
 /***************************************************************************/
 
+#if SYSCALLS_USE_CH_MALLOC == TRUE
+#include <malloc.h>
+
+/*
+ * Header preceding each block, its size is the blocks alignment.
+ */
+typedef union {
+  size_t        size;
+  long long     ll;
+  double        d;
+  void          *p;
+} malloc_header_t;
+
+#define MALLOC_ALIGN            sizeof (malloc_header_t)
+#define MALLOC_CLASS_SIZE(i)    ((size_t)SYSCALLS_MALLOC_POOL_MIN << (i))
+#define MALLOC_OBJECT_SIZE(i)                                               \
+  (sizeof (malloc_header_t) + MEM_ALIGN_NEXT(MALLOC_CLASS_SIZE(i), MALLOC_ALIGN))
+
+static memory_pool_t malloc_pools[SYSCALLS_MALLOC_POOLS];
+static bool malloc_pools_ready;
+
+/*
+ * Allocator statistics, protected by the kernel lock.
+ */
+static struct {
+  size_t        used;           /* Bytes currently allocated.               */
+  size_t        peak;           /* Highest value of the above.              */
+  size_t        heap;           /* Heap space held by the allocated blocks. */
+  size_t        core;           /* Core memory taken by the pools.          */
+  size_t        free[SYSCALLS_MALLOC_POOLS]; /* Free objects in each pool.  */
+} malloc_counters;
+
+/*
+ * Returns the size class of a block, SYSCALLS_MALLOC_POOLS if the block
+ * belongs to the heap.
+ */
+static unsigned malloc_class(size_t size) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)SYSCALLS_MALLOC_POOLS; i++) {
+    if (size <= MALLOC_CLASS_SIZE(i)) {
+      break;
+    }
+  }
+  return i;
+}
+
+/*
+ * Pools provider, objects are aligned to the header size.
+ */
+static void *malloc_provider(size_t size, unsigned align) {
+
+  (void)align;
+
+  return chCoreAllocAlignedI(size, (unsigned)MALLOC_ALIGN);
+}
+
+static void malloc_account_alloc(size_t size) {
+
+  malloc_counters.used += size;
+  if (malloc_counters.used > malloc_counters.peak) {
+    malloc_counters.peak = malloc_counters.used;
+  }
+}
+
+void *_malloc_r(struct _reent *r, size_t size) {
+  malloc_header_t *hp;
+  unsigned i;
+
+  /* The kernel is not yet initialized, the default heap mutex must not
+     be touched.*/
+  if (chThdGetSelfX() == NULL) {
+    __errno_r(r) = ENOMEM;
+    return NULL;
+  }
+
+  if (size > (size_t)-1 - sizeof (malloc_header_t)) {
+    __errno_r(r) = ENOMEM;
+    return NULL;
+  }
+
+  i = malloc_class(size);
+  if (i < (unsigned)SYSCALLS_MALLOC_POOLS) {
+    chSysLock();
+    if (!malloc_pools_ready) {
+      unsigned j;
+
+      for (j = 0U; j < (unsigned)SYSCALLS_MALLOC_POOLS; j++) {
+        chPoolObjectInit(&malloc_pools[j], MALLOC_OBJECT_SIZE(j),
+                         malloc_provider);
+      }
+      malloc_pools_ready = true;
+    }
+    hp = (malloc_header_t *)chPoolAllocI(&malloc_pools[i]);
+    if (hp != NULL) {
+      /* If the pool was empty then the object came from the core
+         allocator.*/
+      if (malloc_counters.free[i] > 0U) {
+        malloc_counters.free[i]--;
+      }
+      else {
+        malloc_counters.core += MALLOC_OBJECT_SIZE(i);
+      }
+      malloc_account_alloc(size);
+    }
+    chSysUnlock();
+  }
+  else {
+    hp = (malloc_header_t *)chHeapAllocAligned(NULL,
+                                               sizeof (malloc_header_t) + size,
+                                               (unsigned)MALLOC_ALIGN);
+    if (hp != NULL) {
+      chSysLock();
+      malloc_counters.heap += chHeapGetSize(hp);
+      malloc_account_alloc(size);
+      chSysUnlock();
+    }
+  }
+
+  if (hp == NULL) {
+    __errno_r(r) = ENOMEM;
+    return NULL;
+  }
+  hp->size = size;
+  return (void *)(hp + 1);
+}
+
+void _free_r(struct _reent *r, void *p) {
+  malloc_header_t *hp;
+  size_t size;
+  unsigned i;
+
+  (void)r;
+
+  if (p == NULL) {
+    return;
+  }
+
+  hp = (malloc_header_t *)p - 1;
+  size = hp->size;
+  i = malloc_class(size);
+  if (i < (unsigned)SYSCALLS_MALLOC_POOLS) {
+    chSysLock();
+    chPoolFreeI(&malloc_pools[i], hp);
+    malloc_counters.free[i]++;
+    malloc_counters.used -= size;
+    chSysUnlock();
+  }
+  else {
+    size_t hsize = chHeapGetSize(hp);
+
+    chHeapFree(hp);
+    chSysLock();
+    malloc_counters.heap -= hsize;
+    malloc_counters.used -= size;
+    chSysUnlock();
+  }
+}
+
+void *_realloc_r(struct _reent *r, void *p, size_t size) {
+  malloc_header_t *hp;
+  unsigned i;
+  void *np;
+
+  if (p == NULL) {
+    return _malloc_r(r, size);
+  }
+
+  if (size == 0U) {
+    _free_r(r, p);
+    return NULL;
+  }
+
+  /* If the new size belongs to the same pool or it is a heap block being
+     shrunk then the block is kept.*/
+  hp = (malloc_header_t *)p - 1;
+  i = malloc_class(hp->size);
+  if ((i == malloc_class(size)) &&
+      ((i < (unsigned)SYSCALLS_MALLOC_POOLS) || (size <= hp->size))) {
+    chSysLock();
+    malloc_counters.used -= hp->size;
+    malloc_account_alloc(size);
+    chSysUnlock();
+    hp->size = size;
+    return p;
+  }
+
+  np = _malloc_r(r, size);
+  if (np != NULL) {
+    memcpy(np, p, size < hp->size ? size : hp->size);
+    _free_r(r, p);
+  }
+  return np;
+}
+
+void *_calloc_r(struct _reent *r, size_t n, size_t size) {
+  void *p;
+
+  if ((size != 0U) && (n > (size_t)-1 / size)) {
+    __errno_r(r) = ENOMEM;
+    return NULL;
+  }
+
+  p = _malloc_r(r, n * size);
+  if (p != NULL) {
+    memset(p, 0, n * size);
+  }
+  return p;
+}
+
+/*
+ * Allocator statistics, the fields meaning is:
+ * arena    - total memory held by the allocator, heap free space included.
+ * ordblks  - number of free heap fragments.
+ * smblks   - number of free pool objects.
+ * usmblks  - highest number of allocated bytes.
+ * fsmblks  - bytes in free pool objects.
+ * uordblks - allocated bytes.
+ * fordblks - free bytes, heap and pools.
+ * keepcost - size of the largest free heap fragment.
+ * Note that the heap is the ChibiOS default heap, its free space is shared
+ * with the other users of the default heap.
+ */
+struct mallinfo _mallinfo_r(struct _reent *r) {
+  struct mallinfo mi;
+  size_t frags, heapfree, largest, poolfree, poolobjs;
+  unsigned i;
+
+  (void)r;
+
+  frags = chHeapStatus(NULL, &heapfree, &largest);
+
+  memset(&mi, 0, sizeof (mi));
+  poolfree = 0U;
+  poolobjs = 0U;
+  chSysLock();
+  for (i = 0U; i < (unsigned)SYSCALLS_MALLOC_POOLS; i++) {
+    poolobjs += malloc_counters.free[i];
+    poolfree += malloc_counters.free[i] * MALLOC_OBJECT_SIZE(i);
+  }
+  mi.arena    = malloc_counters.core + malloc_counters.heap + heapfree;
+  mi.usmblks  = malloc_counters.peak;
+  mi.uordblks = malloc_counters.used;
+  chSysUnlock();
+  mi.ordblks  = frags;
+  mi.smblks   = poolobjs;
+  mi.fsmblks  = poolfree;
+  mi.fordblks = heapfree + poolfree;
+  mi.keepcost = largest;
+
+  return mi;
+}
+
+void *malloc(size_t size) {
+
+  return _malloc_r(_REENT, size);
+}
+
+void free(void *p) {
+
+  _free_r(_REENT, p);
+}
+
+void *realloc(void *p, size_t size) {
+
+  return _realloc_r(_REENT, p, size);
+}
+
+void *calloc(size_t n, size_t size) {
+
+  return _calloc_r(_REENT, n, size);
+}
+
+struct mallinfo mallinfo(void) {
+
+  return _mallinfo_r(_REENT);
+}
+
+#elif defined(_CHIBIOS_RT_) && (CH_CFG_USE_MUTEXES == TRUE)
+/*
+ * The newlib allocator lock is recursive, the recursion is handled here
+ * so that CH_CFG_USE_MUTEXES_RECURSIVE is not required. The lock is not
+ * taken before the kernel is initialized.
+ */
+static MUTEX_DECL(malloc_mtx);
+static unsigned malloc_cnt;
+
+void __malloc_lock(struct _reent *r) {
+  thread_t *tp = chThdGetSelfX();
+
+  (void)r;
+
+  if (tp == NULL) {
+    return;
+  }
+  if (malloc_mtx.owner != tp) {
+    chMtxLock(&malloc_mtx);
+  }
+  malloc_cnt++;
+}
+
+void __malloc_unlock(struct _reent *r) {
+
+  (void)r;
+
+  if (chThdGetSelfX() == NULL) {
+    return;
+  }
+  if (--malloc_cnt == 0U) {
+    chMtxUnlock(&malloc_mtx);
+  }
+}
+#endif /* SYSCALLS_USE_CH_MALLOC == TRUE */
+
+/***************************************************************************/
+
 int _fstat_r(struct _reent *r, int file, struct stat * st)
 {
   (void)r;
@@ -33,6 +33,7 @@
  * <h2>Test Cases</h2>
  * - @subpage test_001_001
  * - @subpage test_001_002
+ * - @subpage test_001_003
  * .
  */
 
@@ -169,6 +170,63 @@ static const testcase_t test_001_002 = {
   test_001_002_execute
 };
 
+#if ((CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page test_001_003 [1.3] Time handler duration
+ *
+ * <h2>Description</h2>
+ * The duration of the system tick interrupt is measured using the
+ * realtime counter as the worst interruption of a busy loop, interrupt
+ * entry and exit included. The result depends on the number of threads
+ * unless the ordered timeouts list is enabled.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [1.3.1] A busy loop reads the realtime counter for 16 system ticks
+ *   and the worst interval between two readings is measured, the number
+ *   of threads is printed along with the result.
+ * .
+ */
+
+static void test_001_003_execute(void) {
+  systime_t time;
+  rtcnt_t last, now, worst = 0U;
+
+  /* [1.3.1] A busy loop reads the realtime counter for 16 system ticks
+     and the worst interval between two readings is measured, the number
+     of threads is printed along with the result.*/
+  test_set_step(1);
+  {
+    time = chVTGetSystemTimeX();
+    last = chSysGetRealtimeCounterX();
+    while ((systime_t)(chVTGetSystemTimeX() - time) < (systime_t)16) {
+      now = chSysGetRealtimeCounterX();
+      if (now - last > worst) {
+        worst = now - last;
+      }
+      last = now;
+    }
+    test_print("--- Threads: ");
+    test_printn(CH_CFG_NUM_THREADS);
+    test_print(", worst: ");
+    test_printn(worst);
+    test_println(" cycles");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "Time handler duration",
+  NULL,
+  NULL,
+  test_001_003_execute
+};
+#endif /* (CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -179,5 +237,8 @@ static const testcase_t test_001_002 = {
 const testcase_t * const test_sequence_001[] = {
   &test_001_001,
   &test_001_002,
+#if ((CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE)) || defined(__DOXYGEN__)
+  &test_001_003,
+#endif
   NULL
 };
@@ -77,6 +77,16 @@
  */
 #define CH_CFG_ST_TIMEDELTA                 0
 
+/**
+ * @brief   Ordered timeouts list.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a list ordered by deadline, the time handler only processes
+ *          the threads whose timeout expired.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_TIMEOUT_LIST             TRUE
+
 /** @} */
 
 /*===========================================================================*/
@@ -38,6 +38,8 @@
  * - @subpage test_001_002
  * - @subpage test_001_003
  * - @subpage test_001_004
+ * - @subpage test_001_005
+ * - @subpage test_001_006
  * .
  */
 
@@ -266,6 +268,137 @@ static const testcase_t test_001_004 = {
   test_001_004_execute
 };
 
+#if (CH_DBG_STATISTICS && CH_DBG_CRIT_PROFILER) || defined(__DOXYGEN__)
+/**
+ * @page test_001_005 [1.5] Critical zones profiler
+ *
+ * <h2>Description</h2>
+ * The critical zones profiler is tested, the call site of the longest
+ * zone must be recorded.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_STATISTICS && CH_DBG_CRIT_PROFILER
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [1.5.1] Resetting the profiler then entering two critical zones of
+ *   increasing duration from the same call site.
+ * - [1.5.2] The thread call site must be found among the recorded entries,
+ *   hit twice with the duration of the second zone.
+ * .
+ */
+
+static void test_001_005_execute(void) {
+  crit_site_t sites[CH_DBG_CRIT_PROFILER_SIZE];
+  unsigned i, n;
+
+  /* [1.5.1] Resetting the profiler then entering two critical zones of
+     increasing duration from the same call site.*/
+  test_set_step(1);
+  {
+    chStatsResetCritSites();
+    for (i = 0U; i < 2U; i++) {
+      chSysLock();
+      chSysPolledDelayX((rtcnt_t)(10000U * (i + 1U)));
+      chSysUnlock();
+    }
+  }
+
+  /* [1.5.2] The thread call site must be found among the recorded entries,
+     hit twice with the duration of the second zone.*/
+  test_set_step(2);
+  {
+    n = chStatsGetCritSites(sites, CH_DBG_CRIT_PROFILER_SIZE);
+    test_assert(n > 0U, "no entries");
+    for (i = 0U; i < n; i++) {
+      if (!sites[i].isr && (sites[i].n == (ucnt_t)2) &&
+          (sites[i].worst >= (rtcnt_t)20000)) {
+        break;
+      }
+    }
+    test_assert(i < n, "call site not found");
+#if defined(__GNUC__)
+    test_assert(sites[i].site != NULL, "no call site");
+#endif
+  }
+}
+
+static const testcase_t test_001_005 = {
+  "Critical zones profiler",
+  NULL,
+  NULL,
+  test_001_005_execute
+};
+#endif /* CH_DBG_STATISTICS && CH_DBG_CRIT_PROFILER */
+
+#if (defined(PORT_SIM_VIRTUAL_TIME) && (PORT_SIM_VIRTUAL_TIME == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page test_001_006 [1.6] Simulator virtual time
+ *
+ * <h2>Description</h2>
+ * The virtual time mode of the simulator is tested, the system time must
+ * jump to the timers deadlines and the modelled time must be
+ * deterministic.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - defined(PORT_SIM_VIRTUAL_TIME) && (PORT_SIM_VIRTUAL_TIME == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [1.6.1] Sleeping for increasing intervals, the system time must
+ *   advance exactly by the sleep interval each time.
+ * - [1.6.2] Repeating the same sleep twice, the realtime counter must
+ *   advance by the same amount of modelled cycles both times.
+ * .
+ */
+
+static void test_001_006_execute(void) {
+  systime_t time;
+  rtcnt_t start, cycles[2];
+  unsigned i;
+
+  /* [1.6.1] Sleeping for increasing intervals, the system time must
+     advance exactly by the sleep interval each time.*/
+  test_set_step(1);
+  {
+    for (i = 1U; i <= 4U; i++) {
+      chSysLock();
+      time = chVTGetSystemTimeX();
+      chThdSleepS((systime_t)(i * 100U));
+      test_assert_lock(chVTGetSystemTimeX() == time + (systime_t)(i * 100U),
+                       "wrong wakeup time");
+      chSysUnlock();
+    }
+  }
+
+  /* [1.6.2] Repeating the same sleep twice, the realtime counter must
+     advance by the same amount of modelled cycles both times.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < 2U; i++) {
+      chThdSleep((systime_t)1);
+      start = chSysGetRealtimeCounterX();
+      chThdSleep((systime_t)10);
+      cycles[i] = chSysGetRealtimeCounterX() - start;
+    }
+    test_assert(cycles[0] == cycles[1], "not deterministic");
+    test_assert(cycles[0] >= (rtcnt_t)(9U * (PORT_SIM_CLOCK / CH_CFG_ST_FREQUENCY)),
+                "time not advanced");
+  }
+}
+
+static const testcase_t test_001_006 = {
+  "Simulator virtual time",
+  NULL,
+  NULL,
+  test_001_006_execute
+};
+#endif /* defined(PORT_SIM_VIRTUAL_TIME) && (PORT_SIM_VIRTUAL_TIME == TRUE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -278,5 +411,11 @@ const testcase_t * const test_sequence_001[] = {
   &test_001_002,
   &test_001_003,
   &test_001_004,
+#if (CH_DBG_STATISTICS && CH_DBG_CRIT_PROFILER) || defined(__DOXYGEN__)
+  &test_001_005,
+#endif
+#if (defined(PORT_SIM_VIRTUAL_TIME) && (PORT_SIM_VIRTUAL_TIME == TRUE)) || defined(__DOXYGEN__)
+  &test_001_006,
+#endif
   NULL
 };
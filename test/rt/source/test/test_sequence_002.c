@@ -35,6 +35,11 @@
  * - @subpage test_002_002
  * - @subpage test_002_003
  * - @subpage test_002_004
+ * - @subpage test_002_005
+ * - @subpage test_002_006
+ * - @subpage test_002_007
+ * - @subpage test_002_008
+ * - @subpage test_002_009
  * .
  */
 
@@ -47,6 +52,100 @@ static THD_FUNCTION(thread, p) {
   test_emit_token(*(char *)p);
 }
 
+#if CH_CFG_USE_EDF || defined(__DOXYGEN__)
+static systime_t edf_target;
+
+static const systime_t edf_params[3][2] = {
+  {MS2ST(20), MS2ST(4)},
+  {MS2ST(30), MS2ST(6)},
+  {MS2ST(50), MS2ST(10)}
+};
+
+static THD_FUNCTION(edf_thread1, p) {
+
+  /* The relative deadline depends on the token, 'A' is the earliest.*/
+  chThdSetEDF(MS2ST(1000), MS2ST(100) * (systime_t)(*(char *)p - 'A' + 1));
+  chThdSleepUntil(edf_target);
+  test_emit_token(*(char *)p);
+}
+
+static THD_FUNCTION(edf_thread2, p) {
+
+  (void)p;
+  chThdSetEDF(MS2ST(20), MS2ST(10));
+
+  /* First job completed after its deadline, the second one in time.*/
+  chThdSleepMilliseconds(15);
+  (void) chThdSleepUntilNextPeriod();
+  (void) chThdSleepUntilNextPeriod();
+  chThdExit((msg_t)chThdGetDeadlineMissesX(chThdGetSelfX()));
+}
+
+#if CH_DBG_THREADS_PROFILING || defined(__DOXYGEN__)
+static THD_FUNCTION(edf_thread3, p) {
+  const systime_t *params = (const systime_t *)p;
+
+  /* Implicit deadline, each job consumes params[1] ticks of CPU time.*/
+  chThdSetEDF(params[0], params[0]);
+  while (!chThdShouldTerminateX()) {
+    systime_t start, now;
+
+    start = chThdGetTicksX(chThdGetSelfX());
+    do {
+      now = chThdGetTicksX(chThdGetSelfX());
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while ((systime_t)(now - start) < params[1]);
+    (void) chThdSleepUntilNextPeriod();
+  }
+  chThdExit((msg_t)chThdGetDeadlineMissesX(chThdGetSelfX()));
+}
+#endif /* CH_DBG_THREADS_PROFILING */
+#endif /* CH_CFG_USE_EDF */
+
+#if CH_CFG_USE_BUDGETS || defined(__DOXYGEN__)
+static THD_FUNCTION(budget_thread, p) {
+
+  (void)p;
+  while (!chThdShouldTerminateX()) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+#endif /* CH_CFG_USE_BUDGETS */
+
+#if CH_CFG_USE_WORKQUEUES || defined(__DOXYGEN__)
+static work_queue_t wq1;
+static work_item_t wq_items[3];
+static delayed_work_t wq_delayed[2];
+
+static void work_func(void *p) {
+
+  test_emit_token(*(char *)p);
+}
+#endif /* CH_CFG_USE_WORKQUEUES */
+
+#if CH_DBG_FILL_THREADS || defined(__DOXYGEN__)
+static THD_FUNCTION(stack_min_thread, p) {
+
+  chThdSleepMilliseconds(1);
+  test_emit_token(*(char *)p);
+}
+
+static THD_FUNCTION(stack_thread, p) {
+  volatile uint8_t buf[32];
+  unsigned i;
+
+  for (i = 0U; i < sizeof buf; i++) {
+    buf[i] = (uint8_t)i;
+  }
+  chThdSleepMilliseconds(1);
+  test_emit_token(*(char *)p);
+}
+#endif /* CH_DBG_FILL_THREADS */
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -326,6 +425,359 @@ static const testcase_t test_002_004 = {
 };
 #endif /* CH_CFG_USE_MUTEXES */
 
+#if (CH_CFG_USE_EDF) || defined(__DOXYGEN__)
+/**
+ * @page test_002_005 [2.5] EDF scheduling within a priority level
+ *
+ * <h2>Description</h2>
+ * EDF threads having the same priority are verified to be scheduled in
+ * deadline order, the deadline misses counter is verified.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.5.1] Creating 5 EDF threads with pseudo-random relative
+ *   deadlines, all threads are released at the same instant, execution
+ *   sequence is tested.
+ * - [2.5.2] Creating an EDF thread completing its first job after the
+ *   deadline and the second one in time, the misses counter is
+ *   tested.
+ * .
+ */
+
+static void test_002_005_execute(void) {
+  msg_t msg;
+
+  /* [2.5.1] Creating 5 EDF threads with pseudo-random relative
+     deadlines, all threads are released at the same instant, execution
+     sequence is tested.*/
+  test_set_step(1);
+  {
+    edf_target = chVTGetSystemTimeX() + MS2ST(50);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, edf_thread1, "D");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()+1, edf_thread1, "E");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX()+1, edf_thread1, "A");
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, chThdGetPriorityX()+1, edf_thread1, "C");
+    threads[4] = chThdCreateStatic(wa[4], WA_SIZE, chThdGetPriorityX()+1, edf_thread1, "B");
+    test_wait_threads();
+    test_assert_sequence("ABCDE", "invalid sequence");
+  }
+
+  /* [2.5.2] Creating an EDF thread completing its first job after the
+     deadline and the second one in time, the misses counter is
+     tested.*/
+  test_set_step(2);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, edf_thread2, NULL);
+    msg = chThdWait(threads[0]);
+    threads[0] = NULL;
+    test_assert(msg == 1, "unexpected deadline misses");
+  }
+}
+
+static const testcase_t test_002_005 = {
+  "EDF scheduling within a priority level",
+  NULL,
+  NULL,
+  test_002_005_execute
+};
+#endif /* CH_CFG_USE_EDF */
+
+#if (CH_CFG_USE_EDF && CH_DBG_THREADS_PROFILING) || defined(__DOXYGEN__)
+/**
+ * @page test_002_006 [2.6] EDF schedulability
+ *
+ * <h2>Description</h2>
+ * A set of periodic EDF threads with total utilization below 100% is
+ * run for one second, no deadline misses are expected.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF && CH_DBG_THREADS_PROFILING
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.6.1] Creating 3 EDF threads with utilization 20% each and
+ *   different periods, the threads run for one second.
+ * - [2.6.2] Terminating the threads, the misses counters are tested.
+ * .
+ */
+
+static void test_002_006_execute(void) {
+  unsigned i;
+  msg_t msg;
+
+  /* [2.6.1] Creating 3 EDF threads with utilization 20% each and
+     different periods, the threads run for one second.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, edf_thread3, (void *)edf_params[0]);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()-1, edf_thread3, (void *)edf_params[1]);
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX()-1, edf_thread3, (void *)edf_params[2]);
+    chThdSleepMilliseconds(1000);
+  }
+
+  /* [2.6.2] Terminating the threads, the misses counters are tested.*/
+  test_set_step(2);
+  {
+    test_terminate_threads();
+    for (i = 0; i < 3; i++) {
+      msg = chThdWait(threads[i]);
+      threads[i] = NULL;
+      test_assert(msg == 0, "deadline missed");
+    }
+  }
+}
+
+static const testcase_t test_002_006 = {
+  "EDF schedulability",
+  NULL,
+  NULL,
+  test_002_006_execute
+};
+#endif /* CH_CFG_USE_EDF && CH_DBG_THREADS_PROFILING */
+
+#if (CH_CFG_USE_BUDGETS) || defined(__DOXYGEN__)
+/**
+ * @page test_002_007 [2.7] CPU budget reservation
+ *
+ * <h2>Description</h2>
+ * A busy thread with priority higher than the test thread is given a
+ * budget reservation, the test thread is expected to run when the
+ * budget is exhausted.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_BUDGETS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.7.1] Creating a busy thread at higher priority with a budget of
+ *   10mS every 50mS, the test thread regains control when the thread
+ *   is throttled.
+ * - [2.7.2] Sleeping for 200mS, the thread is expected to exhaust its
+ *   budget in each period.
+ * - [2.7.3] Terminating the thread.
+ * .
+ */
+
+static void test_002_007_execute(void) {
+  thread_descriptor_t td;
+
+  /* [2.7.1] Creating a busy thread at higher priority with a budget of
+     10mS every 50mS, the test thread regains control when the thread
+     is throttled.*/
+  test_set_step(1);
+  {
+    td.name  = "budget";
+    td.wbase = (stkalign_t *)wa[0];
+    td.wend  = (stkalign_t *)((uint8_t *)wa[0] + WA_SIZE);
+    td.prio  = chThdGetPriorityX() + 1;
+    td.funcp = budget_thread;
+    td.arg   = NULL;
+    threads[0] = chThdCreateSuspended(&td);
+    chBudgetSet(threads[0], MS2ST(10), MS2ST(50), chThdGetPriorityX() - 1);
+    chSysLock();
+    (void) chThdStartI(threads[0]);
+    chSchRescheduleS();
+    chSysUnlock();
+    test_assert(chBudgetIsThrottledX(threads[0]), "not throttled");
+    test_assert(chBudgetGetOverrunsX(threads[0]) == 1, "unexpected overruns");
+  }
+
+  /* [2.7.2] Sleeping for 200mS, the thread is expected to exhaust its
+     budget in each period.*/
+  test_set_step(2);
+  {
+    chThdSleepMilliseconds(200);
+    test_assert(chBudgetGetOverrunsX(threads[0]) >= 4, "budget not enforced");
+    test_assert(chBudgetGetConsumedX(threads[0]) >= MS2ST(40), "unexpected consumption");
+  }
+
+  /* [2.7.3] Terminating the thread.*/
+  test_set_step(3);
+  {
+    test_terminate_threads();
+    test_wait_threads();
+  }
+}
+
+static const testcase_t test_002_007 = {
+  "CPU budget reservation",
+  NULL,
+  NULL,
+  test_002_007_execute
+};
+#endif /* CH_CFG_USE_BUDGETS */
+
+#if (CH_CFG_USE_WORKQUEUES) || defined(__DOXYGEN__)
+/**
+ * @page test_002_008 [2.8] Work queues
+ *
+ * <h2>Description</h2>
+ * Work items are posted to a queue served by two worker threads, merging
+ * of pending items, delayed items and cancellation are tested.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_WORKQUEUES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.8.1] Initializing the queue and adding two workers with priority
+ *   lower than the test thread.
+ * - [2.8.2] Posting three items from a critical zone then posting the
+ *   first one again, the second post is expected to be merged, the items
+ *   are executed in FIFO order.
+ * - [2.8.3] Posting a delayed item twice and another delayed item that is
+ *   cancelled before expiration, only the first item is expected to be
+ *   executed.
+ * - [2.8.4] Terminating the queue, the workers are expected to exit.
+ * .
+ */
+
+static void test_002_008_execute(void) {
+  bool b1, b2;
+
+  /* [2.8.1] Initializing the queue and adding two workers with priority
+     lower than the test thread.*/
+  test_set_step(1);
+  {
+    chWQObjectInit(&wq1, "worker");
+    threads[0] = chWQAddWorker(&wq1, wa[0], WA_SIZE, chThdGetPriorityX() - 1);
+    threads[1] = chWQAddWorker(&wq1, wa[1], WA_SIZE, chThdGetPriorityX() - 1);
+    chWQItemObjectInit(&wq_items[0], work_func, "A");
+    chWQItemObjectInit(&wq_items[1], work_func, "B");
+    chWQItemObjectInit(&wq_items[2], work_func, "C");
+  }
+
+  /* [2.8.2] Posting three items from a critical zone then posting the first
+     one again, the second post is expected to be merged, the items are
+     executed in FIFO order.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    b1 = chWQPostI(&wq1, &wq_items[0]) &&
+         chWQPostI(&wq1, &wq_items[1]) &&
+         chWQPostI(&wq1, &wq_items[2]);
+    b2 = chWQPostI(&wq1, &wq_items[0]);
+    chSysUnlock();
+    test_assert(b1, "not posted");
+    test_assert(!b2, "not merged");
+    chThdSleepMilliseconds(10);
+    test_assert_sequence("ABC", "invalid sequence");
+  }
+
+  /* [2.8.3] Posting a delayed item twice and another delayed item that is
+     cancelled before expiration, only the first item is expected to be
+     executed.*/
+  test_set_step(3);
+  {
+    chWQDelayedObjectInit(&wq_delayed[0], work_func, "D");
+    chWQDelayedObjectInit(&wq_delayed[1], work_func, "E");
+    b1 = chWQPostDelayed(&wq1, &wq_delayed[0], MS2ST(10));
+    b2 = chWQPostDelayed(&wq1, &wq_delayed[0], MS2ST(10));
+    test_assert(b1, "not posted");
+    test_assert(!b2, "not merged");
+    (void) chWQPostDelayed(&wq1, &wq_delayed[1], MS2ST(10));
+    chSysLock();
+    b1 = chWQCancelDelayedI(&wq_delayed[1]);
+    chSysUnlock();
+    test_assert(b1, "not cancelled");
+    chThdSleepMilliseconds(50);
+    test_assert_sequence("D", "invalid sequence");
+  }
+
+  /* [2.8.4] Terminating the queue, the workers are expected to exit.*/
+  test_set_step(4);
+  {
+    chWQTerminate(&wq1);
+    test_wait_threads();
+#if CH_DBG_STATISTICS
+    test_assert(wq1.stats.n_executed == 4, "wrong executed count");
+    test_assert(wq1.stats.n_merged == 2, "wrong merged count");
+#endif
+  }
+}
+
+static const testcase_t test_002_008 = {
+  "Work queues",
+  NULL,
+  NULL,
+  test_002_008_execute
+};
+#endif /* CH_CFG_USE_WORKQUEUES */
+
+#if (CH_DBG_FILL_THREADS && (CH_DBG_ENABLE_STACK_CHECK || CH_CFG_USE_DYNAMIC)) || defined(__DOXYGEN__)
+/**
+ * @page test_002_009 [2.9] Stack usage measurement
+ *
+ * <h2>Description</h2>
+ * The never used stack space of terminated threads is measured, a thread
+ * using more stack is expected to leave less unused space. The threads
+ * sleep once so that the measured depth is not dominated by the thread
+ * exit path.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_FILL_THREADS && (CH_DBG_ENABLE_STACK_CHECK || CH_CFG_USE_DYNAMIC)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.9.1] Running a thread with minimal stack usage sleeping once then
+ *   measuring the never used part of its stack.
+ * - [2.9.2] Running a thread using a 32 bytes local buffer and sleeping
+ *   once in the same working area, the unused stack is expected to be at
+ *   least 32 bytes smaller.
+ * .
+ */
+
+static void test_002_009_execute(void) {
+  thread_t *tp;
+  size_t n1, n2;
+
+  /* [2.9.1] Running a thread with minimal stack usage sleeping once then
+     measuring the never used part of its stack.*/
+  test_set_step(1);
+  {
+    tp = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                           stack_min_thread, "A");
+    (void) chThdWait(tp);
+    test_assert_sequence("A", "invalid sequence");
+    n1 = chThdGetStackUnusedX(tp);
+    test_assert((n1 > 0U) && (n1 < WA_SIZE), "invalid unused stack");
+  }
+
+  /* [2.9.2] Running a thread using a 32 bytes local buffer and sleeping
+     once in the same working area, the unused stack is expected to be at
+     least 32 bytes smaller.*/
+  test_set_step(2);
+  {
+    tp = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                           stack_thread, "B");
+    (void) chThdWait(tp);
+    test_assert_sequence("B", "invalid sequence");
+    n2 = chThdGetStackUnusedX(tp);
+    test_assert(n2 + 32U <= n1, "stack usage not detected");
+  }
+}
+
+static const testcase_t test_002_009 = {
+  "Stack usage measurement",
+  NULL,
+  NULL,
+  test_002_009_execute
+};
+#endif /* CH_DBG_FILL_THREADS && (CH_DBG_ENABLE_STACK_CHECK || CH_CFG_USE_DYNAMIC) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -339,6 +791,21 @@ const testcase_t * const test_sequence_002[] = {
   &test_002_003,
 #if (CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
   &test_002_004,
+#endif
+#if (CH_CFG_USE_EDF) || defined(__DOXYGEN__)
+  &test_002_005,
+#endif
+#if (CH_CFG_USE_EDF && CH_DBG_THREADS_PROFILING) || defined(__DOXYGEN__)
+  &test_002_006,
+#endif
+#if (CH_CFG_USE_BUDGETS) || defined(__DOXYGEN__)
+  &test_002_007,
+#endif
+#if (CH_CFG_USE_WORKQUEUES) || defined(__DOXYGEN__)
+  &test_002_008,
+#endif
+#if (CH_DBG_FILL_THREADS && (CH_DBG_ENABLE_STACK_CHECK || CH_CFG_USE_DYNAMIC)) || defined(__DOXYGEN__)
+  &test_002_009,
 #endif
   NULL
 };
@@ -46,6 +46,9 @@
  * - @subpage test_005_007
  * - @subpage test_005_008
  * - @subpage test_005_009
+ * - @subpage test_005_010
+ * - @subpage test_005_011
+ * - @subpage test_005_012
  * .
  */
 
@@ -227,6 +230,14 @@ static THD_FUNCTION(thread9, p) {
   test_emit_token(*(char *)p);
   chMtxUnlock(&m2);
 }
+
+#if CH_CFG_USE_CONDVARS_TIMEOUT && CH_CFG_USE_MUTEXES_RECURSIVE
+static THD_FUNCTION(thread10, p) {
+
+  test_emit_token(*(char *)p);
+  chCondSignal(&c1);
+}
+#endif
 #endif /* CH_CFG_USE_CONDVARS */
 
 /****************************************************************************
@@ -1032,6 +1043,244 @@ static const testcase_t test_005_009 = {
 };
 #endif /* CH_CFG_USE_CONDVARS */
 
+#if (CH_CFG_USE_MUTEXES_CEILING) || defined(__DOXYGEN__)
+/**
+ * @page test_005_010 [5.10] Priority ceiling test
+ *
+ * <h2>Description</h2>
+ * Mutexes with a priority ceiling are locked and unlocked, the owner
+ * priority is verified to be raised to the ceiling on lock and
+ * restored on unlock.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MUTEXES_CEILING
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.10.1] Reading current base priority and initializing two
+ *   mutexes with ceilings P(+2) and P(+3).
+ * - [5.10.2] Locking MC1, the priority is raised to P(+2), a thread
+ *   created at P(+1) cannot preempt until MC1 is unlocked.
+ * - [5.10.3] Locking MC1 and MC2, the priority follows the highest
+ *   ceiling among the owned mutexes while unlocking.
+ * .
+ */
+
+static void test_005_010_execute(void) {
+  tprio_t prio;
+  mutex_t mc1, mc2;
+
+  /* [5.10.1] Reading current base priority and initializing two
+     mutexes with ceilings P(+2) and P(+3).*/
+  test_set_step(1);
+  {
+    prio = chThdGetPriorityX();
+    chMtxObjectInitCeiling(&mc1, prio + 2);
+    chMtxObjectInitCeiling(&mc2, prio + 3);
+  }
+
+  /* [5.10.2] Locking MC1, the priority is raised to P(+2), a thread
+     created at P(+1) cannot preempt until MC1 is unlocked.*/
+  test_set_step(2);
+  {
+    chMtxLock(&mc1);
+    test_assert(chThdGetPriorityX() == prio + 2, "not raised to ceiling");
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread1, "B");
+    test_emit_token('A');
+    chMtxUnlock(&mc1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+
+  /* [5.10.3] Locking MC1 and MC2, the priority follows the highest
+     ceiling among the owned mutexes while unlocking.*/
+  test_set_step(3);
+  {
+    chMtxLock(&mc1);
+    chMtxLock(&mc2);
+    test_assert(chThdGetPriorityX() == prio + 3, "not raised to ceiling");
+    chMtxUnlock(&mc2);
+    test_assert(chThdGetPriorityX() == prio + 2, "wrong priority level");
+    chMtxUnlock(&mc1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+  }
+}
+
+static const testcase_t test_005_010 = {
+  "Priority ceiling test",
+  NULL,
+  NULL,
+  test_005_010_execute
+};
+#endif /* CH_CFG_USE_MUTEXES_CEILING */
+
+#if (CH_CFG_USE_CONDVARS && CH_DBG_STATISTICS) || defined(__DOXYGEN__)
+/**
+ * @page test_005_011 [5.11] Condition Variable wait morphing test
+ *
+ * <h2>Description</h2>
+ * Five threads at the same priority wait on a condition variable, the
+ * tester thread broadcasts the condition variable while owning the
+ * mutex. The threads are expected to be moved on the mutex queue
+ * without running, only the thread getting the mutex is awakened each
+ * time. The context switches are counted: one per thread plus the
+ * final switch back to the tester thread, making the threads ready on
+ * broadcast would require twice that number.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_CONDVARS && CH_DBG_STATISTICS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.11.1] Starting the five threads at priority P(+1), the threads
+ *   will queue on the condition variable.
+ * - [5.11.2] Locking M1 and broadcasting C1, no context switch is
+ *   expected because the threads are moved on the M1 queue, the tester
+ *   priority is raised to P(+1).
+ * - [5.11.3] Unlocking M1, the threads get the mutex in FIFO order, the
+ *   number of context switches and the order are tested.
+ * .
+ */
+
+static void test_005_011_setup(void) {
+  chCondObjectInit(&c1);
+  chMtxObjectInit(&m1);
+}
+
+static void test_005_011_execute(void) {
+  tprio_t prio;
+  ucnt_t n;
+
+  /* [5.11.1] Starting the five threads at priority P(+1), the threads
+     will queue on the condition variable.*/
+  test_set_step(1);
+  {
+    prio = chThdGetPriorityX();
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread6, "A");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+1, thread6, "B");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+1, thread6, "C");
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+1, thread6, "D");
+    threads[4] = chThdCreateStatic(wa[4], WA_SIZE, prio+1, thread6, "E");
+  }
+
+  /* [5.11.2] Locking M1 and broadcasting C1, no context switch is
+     expected because the threads are moved on the M1 queue, the tester
+     priority is raised to P(+1).*/
+  test_set_step(2);
+  {
+    n = ch.kernel_stats.n_ctxswc;
+    chMtxLock(&m1);
+    chCondBroadcast(&c1);
+    test_assert(ch.kernel_stats.n_ctxswc == n, "unexpected context switch");
+    test_assert(chThdGetPriorityX() == prio+1, "not boosted");
+  }
+
+  /* [5.11.3] Unlocking M1, the threads get the mutex in FIFO order, the
+     number of context switches and the order are tested.*/
+  test_set_step(3);
+  {
+    chMtxUnlock(&m1);
+    test_assert((ch.kernel_stats.n_ctxswc - n) == (ucnt_t)6,
+                "too many context switches");
+    test_wait_threads();
+    test_assert_sequence("ABCDE", "invalid sequence");
+  }
+}
+
+static const testcase_t test_005_011 = {
+  "Condition Variable wait morphing test",
+  test_005_011_setup,
+  NULL,
+  test_005_011_execute
+};
+#endif /* CH_CFG_USE_CONDVARS && CH_DBG_STATISTICS */
+
+#if (CH_CFG_USE_CONDVARS && CH_CFG_USE_CONDVARS_TIMEOUT && CH_CFG_USE_MUTEXES_RECURSIVE) || defined(__DOXYGEN__)
+/**
+ * @page test_005_012 [5.12] Condition Variable timeout with recursive mutex test
+ *
+ * <h2>Description</h2>
+ * The tester thread locks a recursive mutex twice then waits on a
+ * condition variable, the mutex is still owned during the wait. The
+ * wait is first left by timeout, then by a signal from a lower
+ * priority thread, the returned message and the recursion counter are
+ * tested in both cases.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_CONDVARS && CH_CFG_USE_CONDVARS_TIMEOUT &&
+ *   CH_CFG_USE_MUTEXES_RECURSIVE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.12.1] Locking M1 twice and waiting on C1 with a timeout,
+ *   MSG_TIMEOUT is expected and M1 must be still owned with the counter
+ *   decremented.
+ * - [5.12.2] Locking M1 twice, starting a thread at priority P(-1)
+ *   signaling C1 then waiting on C1, MSG_OK is expected and the
+ *   recursion counter must be restored.
+ * .
+ */
+
+static void test_005_012_setup(void) {
+  chCondObjectInit(&c1);
+  chMtxObjectInit(&m1);
+}
+
+static void test_005_012_execute(void) {
+  msg_t msg;
+
+  /* [5.12.1] Locking M1 twice and waiting on C1 with a timeout,
+     MSG_TIMEOUT is expected and M1 must be still owned with the counter
+     decremented.*/
+  test_set_step(1);
+  {
+    chMtxLock(&m1);
+    chMtxLock(&m1);
+    msg = chCondWaitTimeout(&c1, MS2ST(10));
+    test_assert(msg == MSG_TIMEOUT, "wrong wake-up message");
+    test_assert(m1.owner == chThdGetSelfX(), "not owned");
+    test_assert(m1.cnt == 1, "invalid recursion counter");
+    test_assert(queue_isempty(&c1.queue), "queue not empty");
+    chMtxUnlock(&m1);
+    test_assert(m1.owner == NULL, "still owned");
+  }
+
+  /* [5.12.2] Locking M1 twice, starting a thread at priority P(-1)
+     signaling C1 then waiting on C1, MSG_OK is expected and the
+     recursion counter must be restored.*/
+  test_set_step(2);
+  {
+    chMtxLock(&m1);
+    chMtxLock(&m1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1,
+                                   thread10, "A");
+    msg = chCondWaitTimeout(&c1, TIME_INFINITE);
+    test_assert(msg == MSG_OK, "wrong wake-up message");
+    test_assert(m1.owner == chThdGetSelfX(), "not owned");
+    test_assert(m1.cnt == 2, "invalid recursion counter");
+    chMtxUnlock(&m1);
+    chMtxUnlock(&m1);
+    test_assert(m1.owner == NULL, "still owned");
+    test_wait_threads();
+    test_assert_sequence("A", "invalid sequence");
+  }
+}
+
+static const testcase_t test_005_012 = {
+  "Condition Variable timeout with recursive mutex test",
+  test_005_012_setup,
+  NULL,
+  test_005_012_execute
+};
+#endif /* CH_CFG_USE_CONDVARS && CH_CFG_USE_CONDVARS_TIMEOUT && CH_CFG_USE_MUTEXES_RECURSIVE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -1062,6 +1311,15 @@ const testcase_t * const test_sequence_005[] = {
 #endif
 #if (CH_CFG_USE_CONDVARS) || defined(__DOXYGEN__)
   &test_005_009,
+#endif
+#if (CH_CFG_USE_MUTEXES_CEILING) || defined(__DOXYGEN__)
+  &test_005_010,
+#endif
+#if (CH_CFG_USE_CONDVARS && CH_DBG_STATISTICS) || defined(__DOXYGEN__)
+  &test_005_011,
+#endif
+#if (CH_CFG_USE_CONDVARS && CH_CFG_USE_CONDVARS_TIMEOUT && CH_CFG_USE_MUTEXES_RECURSIVE) || defined(__DOXYGEN__)
+  &test_005_012,
 #endif
   NULL
 };
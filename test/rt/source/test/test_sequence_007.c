@@ -43,6 +43,7 @@
  * - @subpage test_007_005
  * - @subpage test_007_006
  * - @subpage test_007_007
+ * - @subpage test_007_008
  * .
  */
 
@@ -74,6 +75,15 @@ static THD_FUNCTION(evt_thread7, p) {
   chEvtBroadcast(&es2);
 }
 
+static THD_FUNCTION(evt_thread8, p) {
+  event_listener_t el;
+
+  chEvtRegisterMask(&es1, &el, 1);
+  chEvtWaitAny(1);
+  chEvtUnregister(&es1, &el);
+  test_emit_token(*(char *)p);
+}
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -546,6 +556,98 @@ static const testcase_t test_007_007 = {
   test_007_007_execute
 };
 
+/**
+ * @page test_007_008 [7.8] Broadcasting using chEvtBroadcastFlagsMode()
+ *
+ * <h2>Description</h2>
+ * Functionality of chEvtBroadcastFlagsMode() is tested, the three
+ * broadcast modes are used in sequence on threads waiting at different
+ * priorities.
+ *
+ * <h2>Test Steps</h2>
+ * - [7.8.1] Three threads are created at higher priority and in mixed
+ *   order, the threads register on the Event Source and wait.
+ * - [7.8.2] Broadcasting in @p EVT_BCAST_ALL mode, the threads must be
+ *   awakened in priority order and three threads must be reported.
+ * - [7.8.3] The three threads are created again.
+ * - [7.8.4] Broadcasting in @p EVT_BCAST_HIGHEST mode, only the highest
+ *   priority thread must be awakened.
+ * - [7.8.5] Broadcasting in @p EVT_BCAST_COALESCE mode, the remaining
+ *   threads must be awakened and the Event Source must not have
+ *   listeners.
+ * .
+ */
+
+static void test_007_008_setup(void) {
+  chEvtGetAndClearEvents(ALL_EVENTS);
+  chEvtObjectInit(&es1);
+}
+
+static void test_007_008_execute(void) {
+  cnt_t n;
+
+  /* [7.8.1] Three threads are created at higher priority and in mixed
+     order, the threads register on the Event Source and wait.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                   evt_thread8, "C");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX() + 3,
+                                   evt_thread8, "A");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX() + 2,
+                                   evt_thread8, "B");
+  }
+
+  /* [7.8.2] Broadcasting in @p EVT_BCAST_ALL mode, the threads must be
+     awakened in priority order and three threads must be reported.*/
+  test_set_step(2);
+  {
+    n = chEvtBroadcastFlagsMode(&es1, 0, EVT_BCAST_ALL);
+    test_assert_sequence("ABC", "invalid sequence");
+    test_assert(n == 3, "wrong number of threads");
+    test_wait_threads();
+  }
+
+  /* [7.8.3] The three threads are created again.*/
+  test_set_step(3);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                   evt_thread8, "C");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX() + 3,
+                                   evt_thread8, "A");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX() + 2,
+                                   evt_thread8, "B");
+  }
+
+  /* [7.8.4] Broadcasting in @p EVT_BCAST_HIGHEST mode, only the highest
+     priority thread must be awakened.*/
+  test_set_step(4);
+  {
+    n = chEvtBroadcastFlagsMode(&es1, 0, EVT_BCAST_HIGHEST);
+    test_assert_sequence("A", "invalid sequence");
+    test_assert(n == 1, "wrong number of threads");
+  }
+
+  /* [7.8.5] Broadcasting in @p EVT_BCAST_COALESCE mode, the remaining
+     threads must be awakened and the Event Source must not have
+     listeners.*/
+  test_set_step(5);
+  {
+    n = chEvtBroadcastFlagsMode(&es1, 0, EVT_BCAST_COALESCE);
+    test_assert_sequence("BC", "invalid sequence");
+    test_assert(n == 2, "wrong number of threads");
+    test_wait_threads();
+    test_assert(!chEvtIsListeningI(&es1), "stuck listener");
+  }
+}
+
+static const testcase_t test_007_008 = {
+  "Broadcasting using chEvtBroadcastFlagsMode()",
+  test_007_008_setup,
+  NULL,
+  test_007_008_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -563,6 +665,7 @@ const testcase_t * const test_sequence_007[] = {
   &test_007_006,
 #endif
   &test_007_007,
+  &test_007_008,
   NULL
 };
 
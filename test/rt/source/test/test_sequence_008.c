@@ -40,6 +40,7 @@
  * - @subpage test_008_001
  * - @subpage test_008_002
  * - @subpage test_008_003
+ * - @subpage test_008_004
  * .
  */
 
@@ -54,6 +55,12 @@
 static msg_t mb_buffer[MB_SIZE];
 static MAILBOX_DECL(mb1, mb_buffer, MB_SIZE);
 
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+static msg_t of_objects[MB_SIZE];
+static msg_t of_buffer[MB_SIZE];
+static objects_fifo_t of1;
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -373,6 +380,108 @@ static const testcase_t test_008_003 = {
   test_008_003_execute
 };
 
+#if (CH_CFG_USE_OBJ_FIFOS) || defined(__DOXYGEN__)
+/**
+ * @page test_008_004 [8.4] Objects FIFO, zero-copy exchange
+ *
+ * <h2>Description</h2>
+ * The objects FIFO API is tested, objects are taken, filled in place,
+ * sent, received and returned.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_OBJ_FIFOS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [8.4.1] Initializing the objects FIFO, all the objects are free.
+ * - [8.4.2] Taking all the objects, filling them and sending them, no
+ *   more objects can be taken.
+ * - [8.4.3] Receiving and returning all the objects, the order is
+ *   tested, no more objects can be received.
+ * - [8.4.4] Testing the I-Class API, an object is taken, sent, received
+ *   and returned.
+ * .
+ */
+
+static void test_008_004_execute(void) {
+  void *objp, *objp2;
+  msg_t msg;
+  unsigned i;
+
+  /* [8.4.1] Initializing the objects FIFO, all the objects are free.*/
+  test_set_step(1);
+  {
+    chFifoObjectInit(&of1, sizeof (msg_t), MB_SIZE, of_objects, of_buffer);
+    test_assert_lock(chFifoGetFreeCountI(&of1) == MB_SIZE, "wrong free count");
+    test_assert_lock(chFifoGetUsedCountI(&of1) == 0, "wrong used count");
+  }
+
+  /* [8.4.2] Taking all the objects, filling them and sending them, no more
+     objects can be taken.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < MB_SIZE; i++) {
+      objp = chFifoTakeObjectTimeout(&of1, TIME_IMMEDIATE);
+      test_assert(objp != NULL, "no free object");
+      *(msg_t *)objp = 'A' + i;
+      chFifoSendObject(&of1, objp);
+    }
+    objp = chFifoTakeObjectTimeout(&of1, TIME_IMMEDIATE);
+    test_assert(objp == NULL, "unexpected object");
+    test_assert_lock(chFifoGetUsedCountI(&of1) == MB_SIZE, "wrong used count");
+  }
+
+  /* [8.4.3] Receiving and returning all the objects, the order is tested,
+     no more objects can be received.*/
+  test_set_step(3);
+  {
+    for (i = 0; i < MB_SIZE; i++) {
+      msg = chFifoReceiveObjectTimeout(&of1, &objp, TIME_IMMEDIATE);
+      test_assert(msg == MSG_OK, "wrong wake-up message");
+      test_emit_token((char)*(msg_t *)objp);
+      chFifoReturnObject(&of1, objp);
+    }
+    test_assert_sequence("ABCD", "wrong objects sequence");
+    msg = chFifoReceiveObjectTimeout(&of1, &objp, 1);
+    test_assert(msg == MSG_TIMEOUT, "wrong wake-up message");
+    test_assert_lock(chFifoGetFreeCountI(&of1) == MB_SIZE, "wrong free count");
+  }
+
+  /* [8.4.4] Testing the I-Class API, an object is taken, sent, received
+     and returned.*/
+  test_set_step(4);
+  {
+    chSysLock();
+    objp = chFifoTakeObjectI(&of1);
+    chSysUnlock();
+    test_assert(objp != NULL, "no free object");
+    *(msg_t *)objp = 'X';
+    chSysLock();
+    chFifoSendObjectI(&of1, objp);
+    msg = chFifoReceiveObjectI(&of1, &objp2);
+    chSysUnlock();
+    test_assert(msg == MSG_OK, "wrong wake-up message");
+    test_assert(objp2 == objp, "wrong object");
+    test_assert(*(msg_t *)objp2 == 'X', "wrong object content");
+    chSysLock();
+    chFifoReturnObjectI(&of1, objp2);
+    msg = chFifoReceiveObjectI(&of1, &objp2);
+    chSysUnlock();
+    test_assert(msg == MSG_TIMEOUT, "wrong wake-up message");
+    test_assert_lock(chFifoGetFreeCountI(&of1) == MB_SIZE, "wrong free count");
+  }
+}
+
+static const testcase_t test_008_004 = {
+  "Objects FIFO, zero-copy exchange",
+  NULL,
+  NULL,
+  test_008_004_execute
+};
+#endif /* CH_CFG_USE_OBJ_FIFOS */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -384,6 +493,9 @@ const testcase_t * const test_sequence_008[] = {
   &test_008_001,
   &test_008_002,
   &test_008_003,
+#if (CH_CFG_USE_OBJ_FIFOS) || defined(__DOXYGEN__)
+  &test_008_004,
+#endif
   NULL
 };
 
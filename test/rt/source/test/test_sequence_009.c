@@ -40,6 +40,7 @@
  * - @subpage test_009_001
  * - @subpage test_009_002
  * - @subpage test_009_003
+ * - @subpage test_009_004
  * .
  */
 
@@ -275,6 +276,100 @@ static const testcase_t test_009_003 = {
 };
 #endif /* CH_CFG_USE_SEMAPHORES */
 
+#if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
+/**
+ * @page test_009_004 [9.4] Guarded Memory Pools non-blocking allocation
+ *
+ * <h2>Description</h2>
+ * The non-blocking allocation from a guarded memory pool is tested, the
+ * free objects counter is checked after each operation.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_SEMAPHORES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [9.4.1] Adding the objects to the pool using chGuardedPoolLoadArray(),
+ *   the counter must match the number of objects.
+ * - [9.4.2] Emptying the pool using chGuardedPoolAllocI(), the counter
+ *   must decrease on each allocation.
+ * - [9.4.3] Now must be empty, the allocation must fail without altering
+ *   the counter.
+ * - [9.4.4] Returning the objects using chGuardedPoolFreeI(), the counter
+ *   must be restored.
+ * .
+ */
+
+static void test_009_004_setup(void) {
+  chGuardedPoolObjectInit(&gmp1, sizeof (uint32_t));
+}
+
+static void test_009_004_execute(void) {
+  unsigned i;
+  cnt_t n;
+  void *objp;
+
+  /* [9.4.1] Adding the objects to the pool using chGuardedPoolLoadArray(),
+     the counter must match the number of objects.*/
+  test_set_step(1);
+  {
+    chGuardedPoolLoadArray(&gmp1, objects, MEMORY_POOL_SIZE);
+    chSysLock();
+    n = chGuardedPoolGetCounterI(&gmp1);
+    chSysUnlock();
+    test_assert(n == (cnt_t)MEMORY_POOL_SIZE, "wrong counter");
+  }
+
+  /* [9.4.2] Emptying the pool using chGuardedPoolAllocI(), the counter must
+     decrease on each allocation.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < MEMORY_POOL_SIZE; i++) {
+      chSysLock();
+      objp = chGuardedPoolAllocI(&gmp1);
+      n = chGuardedPoolGetCounterI(&gmp1);
+      chSysUnlock();
+      test_assert(objp != NULL, "list empty");
+      test_assert(n == (cnt_t)(MEMORY_POOL_SIZE - i - 1), "wrong counter");
+    }
+  }
+
+  /* [9.4.3] Now must be empty, the allocation must fail without altering the
+     counter.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    objp = chGuardedPoolAllocI(&gmp1);
+    n = chGuardedPoolGetCounterI(&gmp1);
+    chSysUnlock();
+    test_assert(objp == NULL, "list not empty");
+    test_assert(n == (cnt_t)0, "wrong counter");
+  }
+
+  /* [9.4.4] Returning the objects using chGuardedPoolFreeI(), the counter
+     must be restored.*/
+  test_set_step(4);
+  {
+    chSysLock();
+    for (i = 0; i < MEMORY_POOL_SIZE; i++) {
+      chGuardedPoolFreeI(&gmp1, &objects[i]);
+    }
+    n = chGuardedPoolGetCounterI(&gmp1);
+    chSysUnlock();
+    test_assert(n == (cnt_t)MEMORY_POOL_SIZE, "wrong counter");
+  }
+}
+
+static const testcase_t test_009_004 = {
+  "Guarded Memory Pools non-blocking allocation",
+  test_009_004_setup,
+  NULL,
+  test_009_004_execute
+};
+#endif /* CH_CFG_USE_SEMAPHORES */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -289,6 +384,9 @@ const testcase_t * const test_sequence_009[] = {
 #endif
 #if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
   &test_009_003,
+#endif
+#if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
+  &test_009_004,
 #endif
   NULL
 };
@@ -39,6 +39,7 @@
  * <h2>Test Cases</h2>
  * - @subpage test_011_001
  * - @subpage test_011_002
+ * - @subpage test_011_003
  * .
  */
 
@@ -60,6 +61,20 @@ static THD_FUNCTION(dyn_thread1, p) {
   test_emit_token(*(char *)p);
 }
 
+#if CH_CFG_USE_WA_CACHE
+static bool wa_cache_find(size_t size, wa_cache_stats_t *wcsp) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_WA_CACHE_CLASSES; i++) {
+    if (chThdCacheGetStats(i, wcsp) && (wcsp->size == size)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -264,6 +279,96 @@ static const testcase_t test_011_002 = {
 };
 #endif /* CH_CFG_USE_MEMPOOLS */
 
+#if (CH_CFG_USE_WA_CACHE) || defined(__DOXYGEN__)
+/**
+ * @page test_011_003 [11.3] Threads creation from the working areas cache
+ *
+ * <h2>Description</h2>
+ * A thread is created from the default heap and released, a second
+ * thread with the same working area size is expected to reuse the cached
+ * working area.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_WA_CACHE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [11.3.1] Flushing the cache then creating a thread from the default
+ *   heap, the size class is expected to be assigned with no cached working
+ *   areas.
+ * - [11.3.2] Waiting for the thread, the working area is expected to be
+ *   cached on release.
+ * - [11.3.3] Creating a thread with the same working area size, the cached
+ *   working area is expected to be reused.
+ * - [11.3.4] Flushing the cache, the working area is expected to be
+ *   returned to the heap.
+ * .
+ */
+
+static void test_011_003_execute(void) {
+  size_t size;
+  stkalign_t *wap;
+  wa_cache_stats_t s1, s2;
+
+  /* [11.3.1] Flushing the cache then creating a thread from the default
+     heap, the size class is expected to be assigned with no cached working
+     areas.*/
+  test_set_step(1);
+  {
+    size = THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE);
+    chThdCacheFlush();
+    threads[0] = chThdCreateFromHeap(NULL, size, "dyn1",
+                                     chThdGetPriorityX() - 1, dyn_thread1, "A");
+    test_assert(threads[0] != NULL, "thread creation failed");
+    wap = chThdGetWorkingAreaX(threads[0]);
+    test_assert(wa_cache_find(size, &s1), "class not assigned");
+    test_assert(s1.n_cached == 0, "cache not empty");
+  }
+
+  /* [11.3.2] Waiting for the thread, the working area is expected to be
+     cached on release.*/
+  test_set_step(2);
+  {
+    test_wait_threads();
+    test_assert_sequence("A", "invalid sequence");
+    (void) wa_cache_find(size, &s1);
+    test_assert(s1.n_cached == 1, "not cached");
+  }
+
+  /* [11.3.3] Creating a thread with the same working area size, the cached
+     working area is expected to be reused.*/
+  test_set_step(3);
+  {
+    threads[0] = chThdCreateFromHeap(NULL, size, "dyn2",
+                                     chThdGetPriorityX() - 1, dyn_thread1, "B");
+    test_assert(threads[0] != NULL, "thread creation failed");
+    test_assert(chThdGetWorkingAreaX(threads[0]) == wap, "not reused");
+    (void) wa_cache_find(size, &s2);
+    test_assert(s2.n_reused == s1.n_reused + 1, "reuse not counted");
+    test_wait_threads();
+    test_assert_sequence("B", "invalid sequence");
+  }
+
+  /* [11.3.4] Flushing the cache, the working area is expected to be returned
+     to the heap.*/
+  test_set_step(4);
+  {
+    chThdCacheFlush();
+    (void) wa_cache_find(size, &s2);
+    test_assert(s2.n_cached == 0, "cache not flushed");
+  }
+}
+
+static const testcase_t test_011_003 = {
+  "Threads creation from the working areas cache",
+  NULL,
+  NULL,
+  test_011_003_execute
+};
+#endif /* CH_CFG_USE_WA_CACHE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -277,6 +382,9 @@ const testcase_t * const test_sequence_011[] = {
 #endif
 #if (CH_CFG_USE_MEMPOOLS) || defined(__DOXYGEN__)
   &test_011_002,
+#endif
+#if (CH_CFG_USE_WA_CACHE) || defined(__DOXYGEN__)
+  &test_011_003,
 #endif
   NULL
 };
@@ -47,6 +47,8 @@
  * - @subpage test_012_010
  * - @subpage test_012_011
  * - @subpage test_012_012
+ * - @subpage test_012_013
+ * - @subpage test_012_014
  * .
  */
 
@@ -60,6 +62,9 @@ static semaphore_t sem1;
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
 static mutex_t mtx1;
 #endif
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+static rwlock_t rwl1;
+#endif
 
 static void tmo(void *param) {(void)param;}
 
@@ -135,6 +140,34 @@ static THD_FUNCTION(bmk_thread8, p) {
   } while(!chThdShouldTerminateX());
 }
 
+#if CH_CFG_USE_RWLOCKS
+static THD_FUNCTION(bmk_thread9, p) {
+
+  do {
+    chRWLockReadLock(&rwl1);
+    chThdYield();
+    chRWLockReadUnlock(&rwl1);
+    (*(uint32_t *)p) += 1;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while(!chThdShouldTerminateX());
+}
+
+static THD_FUNCTION(bmk_thread10, p) {
+
+  do {
+    chRWLockWriteLock(&rwl1);
+    chThdYield();
+    chRWLockWriteUnlock(&rwl1);
+    (*(uint32_t *)p) += 1;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while(!chThdShouldTerminateX());
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -882,28 +915,199 @@ static const testcase_t test_012_011 = {
 };
 #endif /* CH_CFG_USE_MUTEXES */
 
+#if (CH_CFG_USE_RWLOCKS) || defined(__DOXYGEN__)
 /**
- * @page test_012_012 [12.12] RAM Footprint
+ * @page test_012_012 [12.12] RW Locks read lock/unlock performance
  *
  * <h2>Description</h2>
- * The memory size of the various kernel objects is printed.
+ * A reader/writer lock is read-locked and read-unlocked. The
+ * performance is calculated by measuring the number of iterations
+ * after a second of continuous operations.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_RWLOCKS
+ * .
  *
  * <h2>Test Steps</h2>
- * - [12.12.1] The size of the system area is printed.
- * - [12.12.2] The size of a thread structure is printed.
- * - [12.12.3] The size of a virtual timer structure is printed.
- * - [12.12.4] The size of a semaphore structure is printed.
- * - [12.12.5] The size of a mutex is printed.
- * - [12.12.6] The size of a condition variable is printed.
- * - [12.12.7] The size of an event source is printed.
- * - [12.12.8] The size of an event listener is printed.
- * - [12.12.9] The size of a mailbox is printed.
+ * - [12.12.1] A reader/writer lock is read-locked and read-unlocked.
+ *   The operation is repeated continuously in a one-second time
+ *   window.
+ * - [12.12.2] The score is printed.
  * .
  */
 
+static void test_012_012_setup(void) {
+  chRWLockObjectInit(&rwl1);
+}
+
 static void test_012_012_execute(void) {
+  uint32_t n;
+
+  /* [12.12.1] A reader/writer lock is read-locked and read-unlocked.
+     The operation is repeated continuously in a one-second time
+     window.*/
+  test_set_step(1);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = start + MS2ST(1000);
+    do {
+      chRWLockReadLock(&rwl1);
+      chRWLockReadUnlock(&rwl1);
+      chRWLockReadLock(&rwl1);
+      chRWLockReadUnlock(&rwl1);
+      chRWLockReadLock(&rwl1);
+      chRWLockReadUnlock(&rwl1);
+      chRWLockReadLock(&rwl1);
+      chRWLockReadUnlock(&rwl1);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+
+  /* [12.12.2] The score is printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Score : ");
+    test_printn(n * 4);
+    test_println(" lock+unlock/S");
+  }
+}
+
+static const testcase_t test_012_012 = {
+  "RW Locks read lock/unlock performance",
+  test_012_012_setup,
+  NULL,
+  test_012_012_execute
+};
+#endif /* CH_CFG_USE_RWLOCKS */
+
+#if (CH_CFG_USE_RWLOCKS) || defined(__DOXYGEN__)
+/**
+ * @page test_012_013 [12.13] RW Locks readers scalability
+ *
+ * <h2>Description</h2>
+ * Five threads are created at equal priority, each thread locks a
+ * reader/writer lock, yields inside the critical section, releases
+ * the lock and increases a counter. The test is performed first using
+ * read locks then using write locks, readers proceed in parallel so
+ * every yield is a direct switch to another thread, writers have to
+ * serialize on the lock.<br> The performance is calculated by
+ * measuring the number of iterations after a second of continuous
+ * operations.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_RWLOCKS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [12.13.1] The five reader threads are created at lower priority.
+ * - [12.13.2] Waiting one second then terminating the 5 threads.
+ * - [12.13.3] The five writer threads are created at lower priority.
+ * - [12.13.4] Waiting one second then terminating the 5 threads.
+ * - [12.13.5] The scores are printed.
+ * .
+ */
+
+static void test_012_013_setup(void) {
+  chRWLockObjectInit(&rwl1);
+}
 
-  /* [12.12.1] The size of the system area is printed.*/
+static void test_012_013_execute(void) {
+  uint32_t nr, nw;
+
+  /* [12.13.1] The five reader threads are created at lower
+     priority.*/
+  test_set_step(1);
+  {
+    nr = 0;
+    test_wait_tick();
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, bmk_thread9, (void *)&nr);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()-1, bmk_thread9, (void *)&nr);
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX()-1, bmk_thread9, (void *)&nr);
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, chThdGetPriorityX()-1, bmk_thread9, (void *)&nr);
+    threads[4] = chThdCreateStatic(wa[4], WA_SIZE, chThdGetPriorityX()-1, bmk_thread9, (void *)&nr);
+  }
+
+  /* [12.13.2] Waiting one second then terminating the 5 threads.*/
+  test_set_step(2);
+  {
+    chThdSleepSeconds(1);
+    test_terminate_threads();
+    test_wait_threads();
+  }
+
+  /* [12.13.3] The five writer threads are created at lower
+     priority.*/
+  test_set_step(3);
+  {
+    nw = 0;
+    test_wait_tick();
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, bmk_thread10, (void *)&nw);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()-1, bmk_thread10, (void *)&nw);
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX()-1, bmk_thread10, (void *)&nw);
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, chThdGetPriorityX()-1, bmk_thread10, (void *)&nw);
+    threads[4] = chThdCreateStatic(wa[4], WA_SIZE, chThdGetPriorityX()-1, bmk_thread10, (void *)&nw);
+  }
+
+  /* [12.13.4] Waiting one second then terminating the 5 threads.*/
+  test_set_step(4);
+  {
+    chThdSleepSeconds(1);
+    test_terminate_threads();
+    test_wait_threads();
+  }
+
+  /* [12.13.5] The scores are printed.*/
+  test_set_step(5);
+  {
+    test_print("--- Score : ");
+    test_printn(nr);
+    test_print(" reads/S, ");
+    test_printn(nw);
+    test_println(" writes/S");
+  }
+}
+
+static const testcase_t test_012_013 = {
+  "RW Locks readers scalability",
+  test_012_013_setup,
+  NULL,
+  test_012_013_execute
+};
+#endif /* CH_CFG_USE_RWLOCKS */
+
+/**
+ * @page test_012_014 [12.14] RAM Footprint
+ *
+ * <h2>Description</h2>
+ * The memory size of the various kernel objects is printed.
+ *
+ * <h2>Test Steps</h2>
+ * - [12.14.1] The size of the system area is printed.
+ * - [12.14.2] The size of a thread structure is printed.
+ * - [12.14.3] The size of a virtual timer structure is printed.
+ * - [12.14.4] The size of a semaphore structure is printed.
+ * - [12.14.5] The size of a mutex is printed.
+ * - [12.14.6] The size of a condition variable is printed.
+ * - [12.14.7] The size of an event source is printed.
+ * - [12.14.8] The size of an event listener is printed.
+ * - [12.14.9] The size of a mailbox is printed.
+ * - [12.14.10] The size of a reader/writer lock is printed.
+ * .
+ */
+
+static void test_012_014_execute(void) {
+
+  /* [12.14.1] The size of the system area is printed.*/
   test_set_step(1);
   {
     test_print("--- System: ");
@@ -911,7 +1115,7 @@ static void test_012_012_execute(void) {
     test_println(" bytes");
   }
 
-  /* [12.12.2] The size of a thread structure is printed.*/
+  /* [12.14.2] The size of a thread structure is printed.*/
   test_set_step(2);
   {
     test_print("--- Thread: ");
@@ -919,7 +1123,7 @@ static void test_012_012_execute(void) {
     test_println(" bytes");
   }
 
-  /* [12.12.3] The size of a virtual timer structure is printed.*/
+  /* [12.14.3] The size of a virtual timer structure is printed.*/
   test_set_step(3);
   {
     test_print("--- Timer : ");
@@ -927,7 +1131,7 @@ static void test_012_012_execute(void) {
     test_println(" bytes");
   }
 
-  /* [12.12.4] The size of a semaphore structure is printed.*/
+  /* [12.14.4] The size of a semaphore structure is printed.*/
   test_set_step(4);
   {
 #if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
@@ -937,7 +1141,7 @@ static void test_012_012_execute(void) {
 #endif
   }
 
-  /* [12.12.5] The size of a mutex is printed.*/
+  /* [12.14.5] The size of a mutex is printed.*/
   test_set_step(5);
   {
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
@@ -947,7 +1151,7 @@ static void test_012_012_execute(void) {
 #endif
   }
 
-  /* [12.12.6] The size of a condition variable is printed.*/
+  /* [12.14.6] The size of a condition variable is printed.*/
   test_set_step(6);
   {
 #if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
@@ -957,7 +1161,7 @@ static void test_012_012_execute(void) {
 #endif
   }
 
-  /* [12.12.7] The size of an event source is printed.*/
+  /* [12.14.7] The size of an event source is printed.*/
   test_set_step(7);
   {
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
@@ -967,7 +1171,7 @@ static void test_012_012_execute(void) {
 #endif
   }
 
-  /* [12.12.8] The size of an event listener is printed.*/
+  /* [12.14.8] The size of an event listener is printed.*/
   test_set_step(8);
   {
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
@@ -977,22 +1181,32 @@ static void test_012_012_execute(void) {
 #endif
   }
 
-  /* [12.12.9] The size of a mailbox is printed.*/
+  /* [12.14.9] The size of a mailbox is printed.*/
   test_set_step(9);
   {
 #if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
     test_print("--- MailB.: ");
     test_printn(sizeof(mailbox_t));
     test_println(" bytes");
+#endif
+  }
+
+  /* [12.14.10] The size of a reader/writer lock is printed.*/
+  test_set_step(10);
+  {
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+    test_print("--- RWLock: ");
+    test_printn(sizeof(rwlock_t));
+    test_println(" bytes");
 #endif
   }
 }
 
-static const testcase_t test_012_012 = {
+static const testcase_t test_012_014 = {
   "RAM Footprint",
   NULL,
   NULL,
-  test_012_012_execute
+  test_012_014_execute
 };
 
 /****************************************************************************
@@ -1026,6 +1240,12 @@ const testcase_t * const test_sequence_012[] = {
 #if (CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
   &test_012_011,
 #endif
+#if (CH_CFG_USE_RWLOCKS) || defined(__DOXYGEN__)
   &test_012_012,
+#endif
+#if (CH_CFG_USE_RWLOCKS) || defined(__DOXYGEN__)
+  &test_012_013,
+#endif
+  &test_012_014,
   NULL
 };
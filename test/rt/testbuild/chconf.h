@@ -91,6 +91,31 @@
 #define CH_CFG_TIME_QUANTUM                 20
 #endif
 
+/**
+ * @brief   Earliest Deadline First scheduling.
+ * @details If enabled then threads can be given a period and a relative
+ *          deadline using @p chThdSetEDF(), ready EDF threads having the
+ *          same priority are scheduled in order of absolute deadline.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_EDF) || defined(__DOXIGEN__)
+#define CH_CFG_USE_EDF                      TRUE
+#endif
+
+/**
+ * @brief   CPU budget reservations APIs.
+ * @details If enabled then threads can be given an execution budget to be
+ *          consumed in each period, a thread exhausting its budget is
+ *          demoted to a background priority until the next replenishment.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Not supported in tick-less mode.
+ */
+#if !defined(CH_CFG_USE_BUDGETS) || defined(__DOXIGEN__)
+#define CH_CFG_USE_BUDGETS                  TRUE
+#endif
+
 /**
  * @brief   Managed RAM size.
  * @details Size of the RAM area to be managed by the OS. If set to zero
@@ -168,6 +193,19 @@
 #define CH_CFG_USE_REGISTRY                 TRUE
 #endif
 
+/**
+ * @brief   Registry names hash index size.
+ * @details If greater than zero then the registry keeps an hash index of
+ *          the threads names with the specified number of buckets, it
+ *          must be a power of two.
+ *
+ * @note    The default is @p 0.
+ * @note    Requires @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE) || defined(__DOXIGEN__)
+#define CH_CFG_REGISTRY_HASH_SIZE           8
+#endif
+
 /**
  * @brief   Threads synchronization APIs.
  * @details If enabled then the @p chThdWait() function is included in
@@ -224,6 +262,18 @@
 #define CH_CFG_USE_MUTEXES_RECURSIVE        FALSE
 #endif
 
+/**
+ * @brief   Enables priority ceiling mutexes.
+ * @details Mutexes initialized with a ceiling priority raise the owner to
+ *          the ceiling on lock (immediate priority ceiling protocol).
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#if !defined(CH_CFG_USE_MUTEXES_CEILING) || defined(__DOXIGEN__)
+#define CH_CFG_USE_MUTEXES_CEILING          TRUE
+#endif
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -248,6 +298,18 @@
 #define CH_CFG_USE_CONDVARS_TIMEOUT         TRUE
 #endif
 
+/**
+ * @brief   Reader/Writer locks APIs.
+ * @details If enabled then the reader/writer locks APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#if !defined(CH_CFG_USE_RWLOCKS) || defined(__DOXIGEN__)
+#define CH_CFG_USE_RWLOCKS                  TRUE
+#endif
+
 /**
  * @brief   Events Flags APIs.
  * @details If enabled then the event flags APIs are included in the kernel.
@@ -342,6 +404,18 @@
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 #endif
 
+/**
+ * @brief   Objects FIFOs APIs.
+ * @details If enabled then the objects FIFOs APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_SEMAPHORES.
+ */
+#if !defined(CH_CFG_USE_OBJ_FIFOS) || defined(__DOXIGEN__)
+#define CH_CFG_USE_OBJ_FIFOS                TRUE
+#endif
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -355,6 +429,48 @@
 #define CH_CFG_USE_DYNAMIC                  TRUE
 #endif
 
+/**
+ * @brief   Working areas cache.
+ * @details If enabled then the working areas of the threads created from
+ *          the default heap are cached on release and reused by the next
+ *          threads requiring the same working area size.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#if !defined(CH_CFG_USE_WA_CACHE) || defined(__DOXIGEN__)
+#define CH_CFG_USE_WA_CACHE                 TRUE
+#endif
+
+/**
+ * @brief   Number of size classes in the working areas cache.
+ *
+ * @note    The default is 4.
+ */
+#if !defined(CH_CFG_WA_CACHE_CLASSES) || defined(__DOXIGEN__)
+#define CH_CFG_WA_CACHE_CLASSES             4
+#endif
+
+/**
+ * @brief   Maximum number of cached working areas in each size class.
+ *
+ * @note    The default is 4.
+ */
+#if !defined(CH_CFG_WA_CACHE_DEPTH) || defined(__DOXIGEN__)
+#define CH_CFG_WA_CACHE_DEPTH               4
+#endif
+
+/**
+ * @brief   Work queues APIs.
+ * @details If enabled then the work queues APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_WORKQUEUES) || defined(__DOXIGEN__)
+#define CH_CFG_USE_WORKQUEUES               TRUE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -373,6 +489,18 @@
 #define CH_DBG_STATISTICS                   FALSE
 #endif
 
+/**
+ * @brief   Debug option, critical zones profiler.
+ * @details If enabled then the call sites of the longest critical zones
+ *          are recorded.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_STATISTICS.
+ */
+#if !defined(CH_DBG_CRIT_PROFILER) || defined(__DOXIGEN__)
+#define CH_DBG_CRIT_PROFILER                FALSE
+#endif
+
 /**
  * @brief   Debug option, system state check.
  * @details If enabled the correct call protocol for system APIs is checked
@@ -452,6 +580,19 @@
 #define CH_DBG_FILL_THREADS                 FALSE
 #endif
 
+/**
+ * @brief   Debug option, stack sentinel thread.
+ * @details If enabled then a thread at @p LOWPRIO periodically scans the
+ *          stacks of all the registered threads and records their minimum
+ *          headroom.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_FILL_THREADS and @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_DBG_STACK_SENTINEL) || defined(__DOXIGEN__)
+#define CH_DBG_STACK_SENTINEL               FALSE
+#endif
+
 /**
  * @brief   Debug option, threads profiling.
  * @details If enabled then a field is added to the @p thread_t structure that
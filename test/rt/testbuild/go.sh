@@ -92,9 +92,9 @@ test cfg2 "-DCH_CFG_OPTIMIZE_SPEED=FALSE"
 test cfg3 "-DCH_CFG_TIME_QUANTUM=0"
 test cfg4 "-DCH_CFG_USE_REGISTRY=FALSE -DCH_CFG_USE_DYNAMIC=FALSE"
 test cfg5 "-DCH_CFG_USE_TM=FALSE"
-test cfg6 "-DCH_CFG_USE_SEMAPHORES=FALSE -DCH_CFG_USE_MAILBOXES=FALSE"
+test cfg6 "-DCH_CFG_USE_SEMAPHORES=FALSE -DCH_CFG_USE_MAILBOXES=FALSE -DCH_CFG_USE_OBJ_FIFOS=FALSE"
 test cfg7 "-DCH_CFG_USE_SEMAPHORES_PRIORITY=TRUE"
-test cfg8 "-DCH_CFG_USE_MUTEXES=FALSE -DCH_CFG_USE_CONDVARS=FALSE"
+test cfg8 "-DCH_CFG_USE_MUTEXES=FALSE -DCH_CFG_USE_CONDVARS=FALSE -DCH_CFG_USE_RWLOCKS=FALSE"
 test cfg9 "-DCH_CFG_USE_MUTEXES_RECURSIVE=TRUE"
 test cfg10 "-DCH_CFG_USE_CONDVARS=FALSE"
 test cfg11 "-DCH_CFG_USE_CONDVARS_TIMEOUT=FALSE"
@@ -103,10 +103,10 @@ test cfg13 "-DCH_CFG_USE_EVENTS_TIMEOUT=FALSE"
 test cfg14 "-DCH_CFG_USE_MESSAGES=FALSE"
 test cfg15 "-DCH_CFG_USE_MESSAGES_PRIORITY=TRUE"
 test cfg16 "-DCH_CFG_USE_MAILBOXES=FALSE"
-test cfg17 "-DCH_CFG_USE_MEMCORE=FALSE -DCH_CFG_USE_MEMPOOLS=FALSE -DCH_CFG_USE_HEAP=FALSE -DCH_CFG_USE_DYNAMIC=FALSE"
-test cfg18 "-DCH_CFG_USE_MEMPOOLS=FALSE -DCH_CFG_USE_HEAP=FALSE -DCH_CFG_USE_DYNAMIC=FALSE"
-test cfg19 "-DCH_CFG_USE_MEMPOOLS=FALSE"
-test cfg20 "-DCH_CFG_USE_HEAP=FALSE"
+test cfg17 "-DCH_CFG_USE_MEMCORE=FALSE -DCH_CFG_USE_MEMPOOLS=FALSE -DCH_CFG_USE_HEAP=FALSE -DCH_CFG_USE_DYNAMIC=FALSE -DCH_CFG_USE_OBJ_FIFOS=FALSE"
+test cfg18 "-DCH_CFG_USE_MEMPOOLS=FALSE -DCH_CFG_USE_HEAP=FALSE -DCH_CFG_USE_DYNAMIC=FALSE -DCH_CFG_USE_OBJ_FIFOS=FALSE"
+test cfg19 "-DCH_CFG_USE_MEMPOOLS=FALSE -DCH_CFG_USE_OBJ_FIFOS=FALSE"
+test cfg20 "-DCH_CFG_USE_HEAP=FALSE -DCH_CFG_USE_WA_CACHE=FALSE"
 test cfg21 "-DCH_CFG_USE_DYNAMIC=FALSE"
 test cfg22 "-DCH_DBG_STATISTICS=TRUE"
 test cfg23 "-DCH_DBG_SYSTEM_STATE_CHECK=TRUE"
@@ -117,6 +117,16 @@ test cfg26 "-DCH_DBG_TRACE_MASK=CH_DBG_TRACE_MASK_ALL"
 test cfg28 "-DCH_DBG_FILL_THREADS=TRUE"
 test cfg29 "-DCH_DBG_THREADS_PROFILING=FALSE"
 test cfg30 "-DCH_DBG_SYSTEM_STATE_CHECK=TRUE -DCH_DBG_ENABLE_CHECKS=TRUE -DCH_DBG_ENABLE_ASSERTS=TRUE -DCH_DBG_TRACE_MASK=CH_DBG_TRACE_MASK_ALL -DCH_DBG_FILL_THREADS=TRUE"
+test cfg31 "-DCH_CFG_REGISTRY_HASH_SIZE=0"
+test cfg32 "-DCH_CFG_USE_EDF=FALSE"
+test cfg33 "-DCH_CFG_USE_BUDGETS=FALSE"
+test cfg34 "-DCH_CFG_USE_MUTEXES_CEILING=FALSE"
+test cfg35 "-DCH_CFG_USE_OBJ_FIFOS=FALSE"
+test cfg36 "-DCH_CFG_USE_WORKQUEUES=FALSE"
+test cfg37 "-DCH_CFG_USE_WA_CACHE=FALSE"
+test cfg38 "-DCH_DBG_FILL_THREADS=TRUE -DCH_DBG_STACK_SENTINEL=TRUE"
+test cfg39 "-DCH_DBG_STATISTICS=TRUE -DCH_DBG_CRIT_PROFILER=TRUE"
+test cfg40 "-DPORT_SIM_VIRTUAL_TIME=TRUE"
 
 rm *log.txt 2> /dev/null
 echo
@@ -0,0 +1,163 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+#include "memstreams.h"
+
+/*===========================================================================*/
+/* Test support.                                                             */
+/*===========================================================================*/
+
+static char buf[128];
+static uint8_t msbuf[128];
+static unsigned failures;
+
+static void check(bool condition, const char *fmt, const char *msg) {
+
+  if (!condition) {
+    printf("  FAILURE: \"%s\" %s\n", fmt, msg);
+    failures++;
+  }
+}
+
+/*
+ * Formats using both chsnprintf() and chprintf() over a memory stream,
+ * the second one goes through the staging buffer and the stream writes.
+ */
+static void check_format(const char *expected, const char *fmt, ...) {
+  va_list ap;
+  MemoryStream ms;
+  int n;
+
+  va_start(ap, fmt);
+  n = chvsnprintf(buf, sizeof buf, fmt, ap);
+  va_end(ap);
+  check(strcmp(buf, expected) == 0, fmt, "wrong chsnprintf() output");
+  check(n == (int)strlen(expected), fmt, "wrong chsnprintf() count");
+
+  msObjectInit(&ms, msbuf, sizeof msbuf - 1U, 0U);
+  va_start(ap, fmt);
+  n = chvprintf((BaseSequentialStream *)&ms, fmt, ap);
+  va_end(ap);
+  msbuf[ms.eos] = 0U;
+  check(strcmp((const char *)msbuf, expected) == 0, fmt,
+        "wrong chprintf() output");
+  check(n == (int)strlen(expected), fmt, "wrong chprintf() count");
+}
+
+/*===========================================================================*/
+/* Test cases.                                                               */
+/*===========================================================================*/
+
+static void test_integers(void) {
+
+  printf("Integers\n");
+
+  check_format("0 -1 42", "%d %i %u", 0, -1, 42U);
+  check_format("-2147483648", "%d", (int)0x80000000U);
+  check_format("DEADBEEF 777", "%x %o", 0xDEADBEEFU, 0777U);
+  check_format("literal % and text", "literal %% and text");
+  check_format("a b", "%c %s", 'a', "b");
+}
+
+static void test_width_precision(void) {
+
+  printf("Width and precision\n");
+
+  check_format("   42|42   |", "%5d|%-5d|", 42, 42);
+  check_format("-0042", "%05d", -42);
+  check_format("00FF", "%04x", 0xFFU);
+  check_format("   42", "%*d", 5, 42);
+  check_format("ab|  abc|abc  |", "%.2s|%5s|%-5s|", "abc", "abc", "abc");
+  check_format("(null)", "%s", (char *)NULL);
+}
+
+static void test_long(void) {
+
+  printf("Long modifiers\n");
+
+  check_format("-2147483648 4294967295", "%ld %lu",
+               (long)(-2147483647L - 1L), 4294967295UL);
+  check_format("80000000 37777777777", "%lx %lo",
+               0x80000000UL, 0xFFFFFFFFUL);
+  check_format("-5 7 FF", "%D %U %X", -5L, 7UL, 0xFFUL);
+  check_format("-9223372036854775808", "%lld",
+               (long long)(-9223372036854775807LL - 1LL));
+  check_format("18446744073709551615 123456789ABCDEF0", "%llu %llx",
+               18446744073709551615ULL, 0x123456789ABCDEF0ULL);
+  check_format("12", "%lld", 12LL);
+}
+
+static void test_float(void) {
+
+  printf("Floating point\n");
+
+  check_format("3.141", "%.3f", 3.14159);
+  check_format("-2.50", "%.2f", -2.5);
+  check_format("0.3333333", "%f", 1.0 / 3.0);
+  check_format("0.1234567", "%.9f", 0.1234567);
+  check_format("    1.25|-001.500", "%8.2f|%08.3f", 1.25, -1.5);
+  check_format("100.5", "%.1f", 100.5);
+}
+
+static void test_truncation(void) {
+  int n;
+
+  printf("Truncation\n");
+
+  n = chsnprintf(buf, 5, "%s%d", "abcdef", 12);
+  check(strcmp(buf, "abcd") == 0, "%s%d", "wrong truncated output");
+  check(n == 8, "%s%d", "wrong truncated count");
+  n = chsnprintf(buf, 0, "%d", 12345);
+  check(n == 5, "%d", "wrong count with no buffer");
+}
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Tests execution, the exit status is the number of failures.
+   */
+  test_integers();
+  test_width_precision();
+  test_long();
+  test_float();
+  test_truncation();
+
+  printf("%s, %u failures\n", failures == 0U ? "PASSED" : "FAILED", failures);
+  fflush(stdout);
+
+  return (int)failures;
+}
@@ -0,0 +1,381 @@
+/*
+    ChibiOS - Copyright (C) 2006..2016 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+/*===========================================================================*/
+/* Fake block device.                                                        */
+/*===========================================================================*/
+
+#define BLK_SIZE            16U
+#define BLK_NUM             64U
+#define MAX_OPS             16U
+
+/*
+ * Transfer performed on the device.
+ */
+typedef struct {
+  bool                  write;
+  uint32_t              startblk;
+  uint32_t              n;
+} fake_op_t;
+
+/*
+ * Memory block device recording the performed transfers.
+ */
+typedef struct {
+  const struct BaseBlockDeviceVMT *vmt;
+  _base_block_device_data
+  uint8_t               storage[BLK_NUM * BLK_SIZE];
+  fake_op_t             ops[MAX_OPS];
+  unsigned              nops;
+} FakeBlockDevice;
+
+static bool fake_is_inserted(void *instance) {
+
+  (void)instance;
+  return true;
+}
+
+static bool fake_is_protected(void *instance) {
+
+  (void)instance;
+  return false;
+}
+
+static bool fake_connect(void *instance) {
+
+  (void)instance;
+  return HAL_SUCCESS;
+}
+
+static bool fake_disconnect(void *instance) {
+
+  (void)instance;
+  return HAL_SUCCESS;
+}
+
+static bool fake_transfer(FakeBlockDevice *fbdp, bool write,
+                          uint32_t startblk, uint32_t n) {
+
+  if ((fbdp->nops >= MAX_OPS) || (startblk + n > BLK_NUM)) {
+    return HAL_FAILED;
+  }
+  fbdp->ops[fbdp->nops].write    = write;
+  fbdp->ops[fbdp->nops].startblk = startblk;
+  fbdp->ops[fbdp->nops].n        = n;
+  fbdp->nops++;
+  return HAL_SUCCESS;
+}
+
+static bool fake_read(void *instance, uint32_t startblk,
+                      uint8_t *buffer, uint32_t n) {
+  FakeBlockDevice *fbdp = (FakeBlockDevice *)instance;
+
+  if (fake_transfer(fbdp, false, startblk, n) != HAL_SUCCESS) {
+    return HAL_FAILED;
+  }
+  memcpy(buffer, &fbdp->storage[startblk * BLK_SIZE], n * BLK_SIZE);
+  return HAL_SUCCESS;
+}
+
+static bool fake_write(void *instance, uint32_t startblk,
+                       const uint8_t *buffer, uint32_t n) {
+  FakeBlockDevice *fbdp = (FakeBlockDevice *)instance;
+
+  if (fake_transfer(fbdp, true, startblk, n) != HAL_SUCCESS) {
+    return HAL_FAILED;
+  }
+  memcpy(&fbdp->storage[startblk * BLK_SIZE], buffer, n * BLK_SIZE);
+  return HAL_SUCCESS;
+}
+
+static bool fake_sync(void *instance) {
+
+  (void)instance;
+  return HAL_SUCCESS;
+}
+
+static bool fake_get_info(void *instance, BlockDeviceInfo *bdip) {
+
+  (void)instance;
+  bdip->blk_size = BLK_SIZE;
+  bdip->blk_num  = BLK_NUM;
+  return HAL_SUCCESS;
+}
+
+static bool fake_start_read(void *instance, blk_request_t *brp) {
+
+  return blkqStartRequest((BaseBlockDevice *)instance, brp, false);
+}
+
+static bool fake_start_write(void *instance, blk_request_t *brp) {
+
+  return blkqStartRequest((BaseBlockDevice *)instance, brp, true);
+}
+
+static const struct BaseBlockDeviceVMT fake_vmt = {
+  fake_is_inserted,
+  fake_is_protected,
+  fake_connect,
+  fake_disconnect,
+  fake_read,
+  fake_write,
+  fake_sync,
+  fake_get_info,
+  fake_start_read,
+  fake_start_write
+};
+
+/*===========================================================================*/
+/* Test support.                                                             */
+/*===========================================================================*/
+
+static FakeBlockDevice fbd;
+static blk_queue_t queue;
+static uint8_t buf1[BLK_NUM * BLK_SIZE];
+static uint8_t buf2[BLK_NUM * BLK_SIZE];
+static blk_request_t req[4];
+static unsigned failures;
+
+/*
+ * Requests served at a lower priority than the test thread, the requests
+ * posted by the test thread accumulate in the queue until it waits.
+ */
+static THD_WORKING_AREA(waServer, 1024);
+static THD_FUNCTION(server, arg) {
+
+  (void)arg;
+  chRegSetThreadName("server");
+  blkqServe(&queue);
+}
+
+static void check(bool condition, const char *msg) {
+
+  if (!condition) {
+    printf("  FAILURE: %s\n", msg);
+    failures++;
+  }
+}
+
+/*
+ * Checks the transfers performed since the previous check.
+ */
+static void check_ops(const fake_op_t *ops, unsigned n) {
+  unsigned i;
+
+  check(fbd.nops == n, "wrong number of transfers");
+  for (i = 0U; (i < n) && (i < fbd.nops); i++) {
+    check((fbd.ops[i].write == ops[i].write) &&
+          (fbd.ops[i].startblk == ops[i].startblk) &&
+          (fbd.ops[i].n == ops[i].n), "wrong transfer");
+  }
+  fbd.nops = 0U;
+}
+
+static void fill(uint8_t *p, uint8_t value, uint32_t n) {
+
+  memset(p, value, n * BLK_SIZE);
+}
+
+/*===========================================================================*/
+/* Test cases.                                                               */
+/*===========================================================================*/
+
+/*
+ * Requests are served in circular scan order starting after the last
+ * transfer, adjacent requests with contiguous buffers are merged.
+ */
+static void test_reorder_merge(void) {
+  static const fake_op_t ops1[] = {{false, 15, 1}};
+  static const fake_op_t ops2[] = {{false, 20, 2}, {false, 10, 5}};
+
+  printf("Reorder and merge\n");
+
+  /* Moving the position to block 16.*/
+  blkRequestObjectInit(&req[0], 15, buf1, 1, NULL, NULL);
+  check(blkStartRead(&fbd, &req[0]) == HAL_SUCCESS, "request rejected");
+  check(blkqWaitRequest(&req[0]) == HAL_SUCCESS, "request failed");
+  check_ops(ops1, 1);
+
+  /* Blocks 10..14 in two requests with contiguous buffers.*/
+  blkRequestObjectInit(&req[0], 20, &buf1[32 * BLK_SIZE], 2, NULL, NULL);
+  blkRequestObjectInit(&req[1], 12, &buf1[2 * BLK_SIZE], 3, NULL, NULL);
+  blkRequestObjectInit(&req[2], 10, &buf1[0], 2, NULL, NULL);
+  check(blkStartRead(&fbd, &req[0]) == HAL_SUCCESS, "request rejected");
+  check(blkStartRead(&fbd, &req[1]) == HAL_SUCCESS, "request rejected");
+  check(blkStartRead(&fbd, &req[2]) == HAL_SUCCESS, "request rejected");
+  check(blkqWaitRequest(&req[0]) == HAL_SUCCESS, "request failed");
+  check(blkqWaitRequest(&req[1]) == HAL_SUCCESS, "request failed");
+  check(blkqWaitRequest(&req[2]) == HAL_SUCCESS, "request failed");
+  check_ops(ops2, 2);
+  check(memcmp(buf1, &fbd.storage[10 * BLK_SIZE], 5 * BLK_SIZE) == 0,
+        "wrong data");
+}
+
+/*
+ * Requests touching the blocks of a pending request, where at least one
+ * is a write, are deferred and keep the arrival order together with all
+ * the following requests.
+ */
+static void test_conflicts(void) {
+  static const fake_op_t ops[] = {{false, 30, 2}, {true, 31, 1},
+                                  {false, 40, 1}, {false, 31, 1}};
+
+  printf("Read/write conflicts\n");
+
+  fill(&fbd.storage[30 * BLK_SIZE], 0x55, 2);
+  fill(buf1, 0x00, 2);
+  fill(buf2, 0xAA, 1);
+  fill(&buf2[BLK_SIZE], 0x00, 1);
+
+  /* The write must not overtake the read, the second read must see the
+     written data, the last read is deferred because it follows a deferred
+     request.*/
+  blkRequestObjectInit(&req[0], 30, buf1, 2, NULL, NULL);
+  blkRequestObjectInit(&req[1], 31, buf2, 1, NULL, NULL);
+  blkRequestObjectInit(&req[2], 31, &buf2[BLK_SIZE], 1, NULL, NULL);
+  blkRequestObjectInit(&req[3], 40, &buf1[8 * BLK_SIZE], 1, NULL, NULL);
+  check(blkStartRead(&fbd, &req[0]) == HAL_SUCCESS, "request rejected");
+  check(blkStartWrite(&fbd, &req[1]) == HAL_SUCCESS, "request rejected");
+  check(blkStartRead(&fbd, &req[2]) == HAL_SUCCESS, "request rejected");
+  check(blkStartRead(&fbd, &req[3]) == HAL_SUCCESS, "request rejected");
+  check(queue.deferred == &req[1], "write not deferred");
+  check(blkqWaitRequest(&req[0]) == HAL_SUCCESS, "request failed");
+  check(blkqWaitRequest(&req[1]) == HAL_SUCCESS, "request failed");
+  check(blkqWaitRequest(&req[2]) == HAL_SUCCESS, "request failed");
+  check(blkqWaitRequest(&req[3]) == HAL_SUCCESS, "request failed");
+  check_ops(ops, 4);
+
+  check(buf1[BLK_SIZE] == 0x55, "write overtook the read");
+  check(buf2[BLK_SIZE] == 0xAA, "read overtook the write");
+  check(fbd.storage[31 * BLK_SIZE] == 0xAA, "block not written");
+}
+
+static unsigned callbacks;
+static bool callback_returned;
+
+static void repost_cb(blk_request_t *brp) {
+
+  callbacks++;
+  if (callbacks == 1U) {
+    brp->startblk++;
+    (void) blkqStartRequestI((BaseBlockDevice *)&fbd, brp, false);
+  }
+  callback_returned = true;
+}
+
+/*
+ * A request can be posted again by its completion callback, the waiting
+ * thread is only resumed on the final completion.
+ */
+static void test_repost(void) {
+  static const fake_op_t ops[] = {{false, 50, 1}, {false, 51, 1}};
+
+  printf("Repost from callback\n");
+
+  callbacks = 0U;
+  blkRequestObjectInit(&req[0], 50, buf1, 1, repost_cb, NULL);
+  check(blkStartRead(&fbd, &req[0]) == HAL_SUCCESS, "request rejected");
+
+  /* The test thread has higher priority than the serving thread, an early
+     wakeup would be noticed before the second transfer.*/
+  check(blkqWaitRequest(&req[0]) == HAL_SUCCESS, "request failed");
+  check_ops(ops, 2);
+  check(callbacks == 2U, "wrong number of callbacks");
+}
+
+/*
+ * The waiting thread is resumed after the completion callback returned.
+ */
+static void test_callback_order(void) {
+  static const fake_op_t ops[] = {{false, 40, 1}};
+
+  printf("Callback before wakeup\n");
+
+  callbacks = 1U;
+  callback_returned = false;
+  blkRequestObjectInit(&req[0], 40, buf1, 1, repost_cb, NULL);
+  check(blkStartRead(&fbd, &req[0]) == HAL_SUCCESS, "request rejected");
+  check(blkqWaitRequest(&req[0]) == HAL_SUCCESS, "request failed");
+  check(callback_returned, "thread resumed before the callback");
+  check_ops(ops, 1);
+}
+
+/*
+ * Stopping the queue completes the pending requests with a failure, new
+ * requests are rejected and the serving function returns.
+ */
+static void test_stop(thread_t *tp) {
+
+  printf("Stop\n");
+
+  blkRequestObjectInit(&req[0], 60, buf1, 1, NULL, NULL);
+  blkRequestObjectInit(&req[1], 31, buf2, 1, NULL, NULL);
+  check(blkStartRead(&fbd, &req[0]) == HAL_SUCCESS, "request rejected");
+  check(blkStartWrite(&fbd, &req[1]) == HAL_SUCCESS, "request rejected");
+  blkqStop(&queue);
+  check(blkStartRead(&fbd, &req[2]) == HAL_FAILED, "request accepted");
+  check(blkqWaitRequest(&req[0]) == HAL_FAILED, "request not failed");
+  check(blkqWaitRequest(&req[1]) == HAL_FAILED, "request not failed");
+  (void) chThdWait(tp);
+  check(fbd.nops == 0U, "transfer after stop");
+}
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+  thread_t *tp;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Fake device and its requests queue.
+   */
+  fbd.vmt   = &fake_vmt;
+  fbd.state = BLK_READY;
+  fbd.nops  = 0U;
+  blkqObjectInit(&queue, (BaseBlockDevice *)&fbd);
+  tp = chThdCreateStatic(waServer, sizeof(waServer), NORMALPRIO - 1,
+                         server, NULL);
+
+  /*
+   * Tests execution, the exit status is the number of failures.
+   */
+  test_reorder_merge();
+  test_conflicts();
+  test_repost();
+  test_callback_order();
+  test_stop(tp);
+
+  printf("%s, %u failures\n", failures == 0U ? "PASSED" : "FAILED", failures);
+  fflush(stdout);
+
+  return (int)failures;
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+#
+# Renders the records produced by the ChibiOS binary logger (binlog.c).
+# The format strings are read from the ELF file of the firmware, the log
+# is read from a file or from the standard input.
+#
+
+import re
+import struct
+import sys
+
+BLOG_MAGIC = 0xA5
+BLOG_FLAG_RTCNT = 0x100000
+BLOG_MAX_ARGS = 8
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+FMT_RE = re.compile(r'%(-?)(0?)(\d+|\*)?(?:\.(\d+|\*))?(ll|l|L)?(.)')
+
+
+class Elf:
+    """Minimal 32 bits little endian ELF reader."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError('not a 32 bits little endian ELF file')
+        shoff, = struct.unpack_from('<I', self.data, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset,
+             size) = struct.unpack_from('<IIIIII', self.data, shoff + i * shentsize)
+            if (flags & SHF_ALLOC) and sh_type != SHT_NOBITS and size > 0:
+                self.sections.append((addr, offset, size))
+
+    def string(self, addr):
+        for base, offset, size in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.find(b'\0', start, offset + size)
+                if end < 0:
+                    end = offset + size
+                return self.data[start:end].decode('latin-1')
+        return None
+
+
+def render(elf, fmt, args):
+    """Renders a chprintf() format string with raw 32 bits arguments."""
+    args = list(args)
+
+    def next_arg():
+        return args.pop(0) if args else 0
+
+    def conv(m):
+        left, zero, width, prec, _, c = m.groups()
+        if c == '%':
+            return '%'
+        if width == '*':
+            width = str(next_arg())
+        if prec == '*':
+            prec = str(next_arg())
+        spec = '%' + left + zero + (width or '')
+        if c in 'dDiI':
+            v = next_arg()
+            return (spec + 'd') % (v - (1 << 32) if v & 0x80000000 else v)
+        if c in 'uU':
+            return (spec + 'd') % next_arg()
+        if c in 'xX':
+            return (spec + 'X') % next_arg()
+        if c in 'oO':
+            return (spec + 'o') % next_arg()
+        if c == 'c':
+            return (spec + 'c') % chr(next_arg() & 0xFF)
+        if c == 's':
+            v = next_arg()
+            s = elf.string(v)
+            if s is None:
+                s = '<0x%08X>' % v
+            if prec:
+                s = s[:int(prec)]
+            # The zero flag does not apply to strings, the width is kept.
+            return ('%' + left + (width or '') + 's') % s
+        return '<%%%c 0x%08X>' % (c, next_arg())
+
+    return FMT_RE.sub(conv, fmt)
+
+
+def records(data):
+    """Iterates over the records, skipping garbage between records."""
+    i = 0
+    while i + 12 <= len(data):
+        hdr, fmt, ts = struct.unpack_from('<III', data, i)
+        n = (hdr >> 16) & 0xF
+        if (hdr >> 24) != BLOG_MAGIC or n > BLOG_MAX_ARGS:
+            i += 1
+            continue
+        if i + 12 + 4 * n > len(data):
+            break
+        args = struct.unpack_from('<%dI' % n, data, i + 12)
+        yield hdr, fmt, ts, args
+        i += 12 + 4 * n
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.stderr.write('Usage: binlog.py firmware.elf [logfile]\n')
+        sys.exit(1)
+    elf = Elf(sys.argv[1])
+    if len(sys.argv) == 3:
+        with open(sys.argv[2], 'rb') as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    expected = None
+    for hdr, fmt, ts, args in records(data):
+        seq = hdr & 0xFFFF
+        if expected is not None and seq != expected:
+            print('*** sequence gap, %d records missing' % ((seq - expected) & 0xFFFF))
+        expected = (seq + 1) & 0xFFFF
+        unit = 'c' if hdr & BLOG_FLAG_RTCNT else 't'
+        if fmt == 0:
+            text = '*** %d records lost' % (args[0] if args else 0)
+        else:
+            s = elf.string(fmt)
+            text = render(elf, s, args) if s is not None else \
+                '<unknown format 0x%08X> %s' % (fmt, ' '.join('0x%08X' % a for a in args))
+        print('%10u%s %s' % (ts, unit, text))
+
+
+if __name__ == '__main__':
+    main()